@@ -0,0 +1,53 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "BenchDevice.h"
+#include "src/core/Logger.h"
+
+namespace photon {
+
+wgpu::Device CreateNullDevice(std::span<const char *const> enabledToggles) {
+  // Devices keep their instance alive, but adapters are requested from it.
+  static wgpu::Instance instance = wgpu::CreateInstance();
+
+  struct Request {
+    std::span<const char *const> Toggles;
+    wgpu::Device Device;
+  } request{enabledToggles, nullptr};
+
+  // Dawn native answers both requests before returning.
+  wgpu::RequestAdapterOptions options{.backendType = wgpu::BackendType::Null};
+  instance.RequestAdapter(
+      &options,
+      [](WGPURequestAdapterStatus status, WGPUAdapter cAdapter,
+         const char *message, void *userdata) {
+        if (status != WGPURequestAdapterStatus_Success) {
+          LogError("No Null backend adapter: %s", message ? message : "");
+          return;
+        }
+        Request &request = *static_cast<Request *>(userdata);
+        wgpu::Adapter adapter = wgpu::Adapter::Acquire(cAdapter);
+
+        wgpu::DawnTogglesDescriptor toggles;
+        toggles.enabledToggleCount = request.Toggles.size();
+        toggles.enabledToggles = request.Toggles.data();
+        wgpu::DeviceDescriptor deviceDescriptor{.nextInChain = &toggles};
+        adapter.RequestDevice(
+            &deviceDescriptor,
+            [](WGPURequestDeviceStatus status, WGPUDevice cDevice,
+               const char *message, void *userdata) {
+              if (status != WGPURequestDeviceStatus_Success) {
+                LogError("No Null backend device: %s", message ? message : "");
+                return;
+              }
+              static_cast<Request *>(userdata)->Device =
+                  wgpu::Device::Acquire(cDevice);
+            },
+            userdata);
+      },
+      &request);
+  return request.Device;
+}
+
+} // namespace photon
@@ -0,0 +1,19 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_BENCHDEVICE_H
+#define PHOTON_BENCHDEVICE_H
+
+#include <span>
+#include <webgpu/webgpu_cpp.h>
+
+namespace photon {
+
+// A device on Dawn's Null backend, which validates and records commands but
+// never executes them. Returns a null device when the backend is missing.
+wgpu::Device CreateNullDevice(std::span<const char *const> enabledToggles = {});
+
+} // namespace photon
+
+#endif // PHOTON_BENCHDEVICE_H
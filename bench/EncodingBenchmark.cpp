@@ -0,0 +1,378 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "EncodingBenchmark.h"
+#include "BenchDevice.h"
+#include "src/core/Logger.h"
+#include "src/core/Renderer.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <json.hpp>
+#include <utility>
+
+namespace photon {
+
+namespace {
+
+using json = nlohmann::json;
+
+// Enough variety that the state filter both skips and issues switches, in
+// roughly the proportions of a material-sorted scene.
+constexpr u32 kMeshCount = 8;
+constexpr u32 kMaterialCount = 4;
+constexpr u32 kPipelineCount = 2;
+constexpr u32 kVertexCount = 24;
+constexpr u32 kIndexCount = 36;
+constexpr u32 kVertexBufferCount = 6;
+constexpr u32 kWarmupRuns = 3;
+
+constexpr const char *kShaderSource = R"(
+struct Frame { viewProjection : mat4x4f }
+struct Material { color : vec4f }
+struct Object { model : mat4x4f }
+
+@group(0) @binding(0) var<uniform> frame : Frame;
+@group(1) @binding(0) var<uniform> material : Material;
+@group(2) @binding(0) var<uniform> object : Object;
+
+@vertex fn vs_main(@location(0) position : vec3f) -> @builtin(position) vec4f {
+  return frame.viewProjection * object.model * vec4f(position, 1.0);
+}
+
+@fragment fn fs_main() -> @location(0) vec4f {
+  return material.color;
+}
+)";
+
+struct BenchDraw {
+  u32 Pipeline;
+  u32 Material;
+  u32 Mesh;
+};
+
+// Records nothing; counts calls so the engine loop cannot be optimised out.
+struct NullEncoder {
+  u64 Calls = 0;
+
+  void SetPipeline(const wgpu::RenderPipeline &) { ++Calls; }
+  void SetBindGroup(u32, const wgpu::BindGroup &, size_t = 0,
+                    const u32 * = nullptr) {
+    ++Calls;
+  }
+  void SetVertexBuffer(u32, const wgpu::Buffer &, u64, u64) { ++Calls; }
+  void SetIndexBuffer(const wgpu::Buffer &, wgpu::IndexFormat, u64, u64) {
+    ++Calls;
+  }
+  void DrawIndexed(u32, u32, u32, i32, u32) { ++Calls; }
+};
+
+// The resources of a main pass: Renderer's bind group layout and vertex
+// layout with a trivial shader, created on one device.
+class EncodingScene {
+public:
+  bool Init(wgpu::Device device, u32 maxDraws) {
+    Device = std::move(device);
+    if (!Device)
+      return false;
+
+    // Same slots and strides as Renderer's mesh vertex layout. Only the
+    // sizes of the CPU-side data are read while encoding.
+    const std::array<u32, kVertexBufferCount> strides{3, 3, 3, 3, 4, 2};
+    for (CMesh &mesh : Meshes) {
+      const std::array<std::pair<std::vector<f32> *, wgpu::Buffer *>,
+                       kVertexBufferCount>
+          streams{{{&mesh.pointData, &mesh.positionBuffer},
+                   {&mesh.normalData, &mesh.normalBuffer},
+                   {&mesh.tangentData, &mesh.tangentBuffer},
+                   {&mesh.bitangentData, &mesh.bitangentBuffer},
+                   {&mesh.colorData, &mesh.colorBuffer},
+                   {&mesh.uvData, &mesh.uvBuffer}}};
+      for (u32 slot = 0; slot < kVertexBufferCount; ++slot) {
+        auto [data, buffer] = streams[slot];
+        data->resize(kVertexCount * strides[slot]);
+        *buffer = CreateBuffer(data->size() * sizeof(f32),
+                               wgpu::BufferUsage::Vertex);
+      }
+      mesh.indexData.resize(kIndexCount);
+      mesh.indexCount = kIndexCount;
+      mesh.indexBuffer =
+          CreateBuffer(kIndexCount * sizeof(u16), wgpu::BufferUsage::Index);
+    }
+
+    std::array<wgpu::BindGroupLayout, kBindGroupCount> layouts;
+    for (u32 group = 0; group < kBindGroupCount; ++group) {
+      wgpu::BindGroupLayoutEntry entry{};
+      entry.binding = 0;
+      entry.visibility =
+          wgpu::ShaderStage::Vertex | wgpu::ShaderStage::Fragment;
+      entry.buffer.type = wgpu::BufferBindingType::Uniform;
+      entry.buffer.hasDynamicOffset = group == kObjectBindGroup;
+      wgpu::BindGroupLayoutDescriptor layoutDescriptor{.entryCount = 1,
+                                                       .entries = &entry};
+      layouts[group] = Device.CreateBindGroupLayout(&layoutDescriptor);
+    }
+
+    FrameGroup = CreateBindGroup(
+        layouts[kFrameBindGroup],
+        CreateBuffer(sizeof(m4), wgpu::BufferUsage::Uniform), sizeof(m4));
+    for (wgpu::BindGroup &group : MaterialGroups)
+      group = CreateBindGroup(
+          layouts[kMaterialBindGroup],
+          CreateBuffer(sizeof(v4f), wgpu::BufferUsage::Uniform), sizeof(v4f));
+    ObjectGroup = CreateBindGroup(
+        layouts[kObjectBindGroup],
+        CreateBuffer(static_cast<u64>(maxDraws) * kObjectUniformStride,
+                     wgpu::BufferUsage::Uniform),
+        sizeof(ObjectUniforms));
+
+    wgpu::PipelineLayoutDescriptor pipelineLayoutDescriptor{
+        .bindGroupLayoutCount = kBindGroupCount,
+        .bindGroupLayouts = layouts.data()};
+    wgpu::PipelineLayout pipelineLayout =
+        Device.CreatePipelineLayout(&pipelineLayoutDescriptor);
+
+    wgpu::ShaderModuleWGSLDescriptor wgslDesc{};
+    wgslDesc.code = kShaderSource;
+    wgpu::ShaderModuleDescriptor shaderModuleDescriptor{.nextInChain =
+                                                            &wgslDesc};
+    wgpu::ShaderModule shaderModule =
+        Device.CreateShaderModule(&shaderModuleDescriptor);
+
+    std::array<wgpu::VertexAttribute, kVertexBufferCount> attributes{};
+    std::array<wgpu::VertexBufferLayout, kVertexBufferCount> vertexLayouts{};
+    const std::array<wgpu::VertexFormat, kVertexBufferCount> formats{
+        wgpu::VertexFormat::Float32x3, wgpu::VertexFormat::Float32x3,
+        wgpu::VertexFormat::Float32x3, wgpu::VertexFormat::Float32x3,
+        wgpu::VertexFormat::Float32x4, wgpu::VertexFormat::Float32x2};
+    for (u32 slot = 0; slot < kVertexBufferCount; ++slot) {
+      attributes[slot].shaderLocation = slot;
+      attributes[slot].format = formats[slot];
+      attributes[slot].offset = 0;
+      vertexLayouts[slot].arrayStride = strides[slot] * sizeof(f32);
+      vertexLayouts[slot].attributeCount = 1;
+      vertexLayouts[slot].attributes = &attributes[slot];
+      vertexLayouts[slot].stepMode = wgpu::VertexStepMode::Vertex;
+    }
+
+    wgpu::ColorTargetState colorTarget{.format =
+                                           wgpu::TextureFormat::BGRA8Unorm};
+    wgpu::FragmentState fragmentState{.module = shaderModule,
+                                      .entryPoint = "fs_main",
+                                      .targetCount = 1,
+                                      .targets = &colorTarget};
+    wgpu::DepthStencilState depthStencilState{
+        .format = wgpu::TextureFormat::Depth24Plus,
+        .depthWriteEnabled = true,
+        .depthCompare = wgpu::CompareFunction::Less};
+
+    // Pipelines differ in culling only, so switching between them is a real
+    // state change with identical bindings.
+    const std::array<wgpu::CullMode, kPipelineCount> cullModes{
+        wgpu::CullMode::Back, wgpu::CullMode::None};
+    for (u32 i = 0; i < kPipelineCount; ++i) {
+      wgpu::RenderPipelineDescriptor pipelineDescriptor{};
+      pipelineDescriptor.layout = pipelineLayout;
+      pipelineDescriptor.vertex.module = shaderModule;
+      pipelineDescriptor.vertex.entryPoint = "vs_main";
+      pipelineDescriptor.vertex.bufferCount = kVertexBufferCount;
+      pipelineDescriptor.vertex.buffers = vertexLayouts.data();
+      pipelineDescriptor.primitive.cullMode = cullModes[i];
+      pipelineDescriptor.depthStencil = &depthStencilState;
+      pipelineDescriptor.fragment = &fragmentState;
+      Pipelines[i] = Device.CreateRenderPipeline(&pipelineDescriptor);
+    }
+
+    ColorView = CreateTarget(wgpu::TextureFormat::BGRA8Unorm);
+    DepthView = CreateTarget(wgpu::TextureFormat::Depth24Plus);
+    return true;
+  }
+
+  // The draws through EncodeMeshDraw, the code Renderer::DrawMesh records
+  // with, so the engine's state filtering and counting are what is timed.
+  template <typename Encoder>
+  void EncodeDraws(Encoder &encoder, const std::vector<BenchDraw> &draws) {
+    RenderPassState state;
+    for (u32 i = 0; i < draws.size(); ++i) {
+      const BenchDraw &draw = draws[i];
+      EncodeMeshDraw(encoder, state, Stats, Pipelines[draw.Pipeline],
+                     FrameGroup, MaterialGroups[draw.Material], ObjectGroup,
+                     i, Meshes[draw.Mesh]);
+    }
+    Stats.EndFrame();
+  }
+
+  // Whole pass into a command buffer, as Render records it.
+  wgpu::CommandBuffer EncodePass(const std::vector<BenchDraw> &draws) {
+    wgpu::RenderPassColorAttachment colorAttachment{};
+    colorAttachment.view = ColorView;
+    colorAttachment.loadOp = wgpu::LoadOp::Clear;
+    colorAttachment.storeOp = wgpu::StoreOp::Store;
+    wgpu::RenderPassDepthStencilAttachment depthAttachment{
+        .view = DepthView,
+        .depthLoadOp = wgpu::LoadOp::Clear,
+        .depthStoreOp = wgpu::StoreOp::Store,
+        .depthClearValue = 1.f};
+    wgpu::RenderPassDescriptor renderPassDescriptor{
+        .colorAttachmentCount = 1,
+        .colorAttachments = &colorAttachment,
+        .depthStencilAttachment = &depthAttachment};
+
+    wgpu::CommandEncoder encoder = Device.CreateCommandEncoder();
+    wgpu::RenderPassEncoder renderPass =
+        encoder.BeginRenderPass(&renderPassDescriptor);
+    EncodeDraws(renderPass, draws);
+    renderPass.End();
+    return encoder.Finish();
+  }
+
+  wgpu::Device Device;
+
+private:
+  wgpu::Buffer CreateBuffer(u64 size, wgpu::BufferUsage usage) {
+    wgpu::BufferDescriptor bufferDescriptor{
+        .usage = usage | wgpu::BufferUsage::CopyDst, .size = size};
+    return Device.CreateBuffer(&bufferDescriptor);
+  }
+
+  wgpu::BindGroup CreateBindGroup(const wgpu::BindGroupLayout &layout,
+                                  const wgpu::Buffer &buffer, u64 size) {
+    wgpu::BindGroupEntry entry{.binding = 0, .buffer = buffer, .size = size};
+    wgpu::BindGroupDescriptor bindGroupDescriptor{
+        .layout = layout, .entryCount = 1, .entries = &entry};
+    return Device.CreateBindGroup(&bindGroupDescriptor);
+  }
+
+  wgpu::TextureView CreateTarget(wgpu::TextureFormat format) {
+    wgpu::TextureDescriptor textureDescriptor{
+        .usage = wgpu::TextureUsage::RenderAttachment,
+        .size = {64, 64, 1},
+        .format = format};
+    return Device.CreateTexture(&textureDescriptor).CreateView();
+  }
+
+  std::array<CMesh, kMeshCount> Meshes;
+  std::array<wgpu::RenderPipeline, kPipelineCount> Pipelines;
+  wgpu::BindGroup FrameGroup;
+  std::array<wgpu::BindGroup, kMaterialCount> MaterialGroups;
+  wgpu::BindGroup ObjectGroup;
+  wgpu::TextureView ColorView;
+  wgpu::TextureView DepthView;
+  RenderStats &Stats = RenderStats::Instance();
+};
+
+// Objects in scene order: runs of a few draws share a material and so a
+// pipeline, meshes change every draw.
+std::vector<BenchDraw> MakeDraws(u32 count) {
+  std::vector<BenchDraw> draws(count);
+  for (u32 i = 0; i < count; ++i) {
+    const u32 material = (i / 4) % kMaterialCount;
+    draws[i] = {.Pipeline = material % kPipelineCount,
+                .Material = material,
+                .Mesh = i % kMeshCount};
+  }
+  return draws;
+}
+
+// Median nanoseconds per draw over repetitions timed runs of encode, after a
+// warm-up. retire gets each result outside the timed region.
+template <typename Encode, typename Retire>
+f64 MeasureNsPerDraw(u32 drawCount, u32 repetitions, Encode &&encode,
+                     Retire &&retire) {
+  for (u32 i = 0; i < kWarmupRuns; ++i)
+    retire(encode());
+
+  std::vector<f64> samples(std::max(repetitions, 1u));
+  for (f64 &sample : samples) {
+    const auto start = std::chrono::steady_clock::now();
+    auto result = encode();
+    sample = std::chrono::duration<f64, std::nano>(
+                 std::chrono::steady_clock::now() - start)
+                 .count() /
+             drawCount;
+    retire(std::move(result));
+  }
+  std::nth_element(samples.begin(), samples.begin() + samples.size() / 2,
+                   samples.end());
+  return samples[samples.size() / 2];
+}
+
+} // namespace
+
+int RunEncodingBenchmark(const EncodingBenchmarkOptions &options) {
+  if (options.DrawCounts.empty()) {
+    LogError("No draw counts to measure");
+    return EXIT_FAILURE;
+  }
+  const u32 maxDraws =
+      *std::max_element(options.DrawCounts.begin(), options.DrawCounts.end());
+
+  constexpr std::array<const char *, 1> kSkipValidation{"skip_validation"};
+  EncodingScene validated;
+  EncodingScene unvalidated;
+  if (!validated.Init(CreateNullDevice(), maxDraws) ||
+      !unvalidated.Init(CreateNullDevice(kSkipValidation), maxDraws))
+    return EXIT_FAILURE;
+
+  json results = json::array();
+  LogInfo("%10s %12s %12s %12s %12s", "draws", "engine ns", "dawn ns",
+          "validate ns", "total ns");
+  for (const u32 drawCount : options.DrawCounts) {
+    if (drawCount == 0)
+      continue;
+    const std::vector<BenchDraw> draws = MakeDraws(drawCount);
+    u64 apiCalls = 0;
+
+    // Submitting lets Dawn free each command buffer; it is not timed.
+    auto submit = [](EncodingScene &scene) {
+      return [&scene](wgpu::CommandBuffer commands) {
+        scene.Device.GetQueue().Submit(1, &commands);
+        scene.Device.Tick();
+      };
+    };
+    const f64 engine = MeasureNsPerDraw(
+        drawCount, options.Repetitions,
+        [&] {
+          NullEncoder encoder;
+          validated.EncodeDraws(encoder, draws);
+          return encoder.Calls;
+        },
+        [&](u64 calls) { apiCalls = calls; });
+    const f64 encoding = MeasureNsPerDraw(
+        drawCount, options.Repetitions,
+        [&] { return unvalidated.EncodePass(draws); }, submit(unvalidated));
+    const f64 total = MeasureNsPerDraw(
+        drawCount, options.Repetitions,
+        [&] { return validated.EncodePass(draws); }, submit(validated));
+
+    // Differences of medians can dip below zero on noisy machines.
+    const f64 dawn = std::max(encoding - engine, 0.0);
+    const f64 validation = std::max(total - encoding, 0.0);
+    LogInfo("%10u %12.1f %12.1f %12.1f %12.1f", drawCount, engine, dawn,
+            validation, total);
+    results.push_back({{"draws", drawCount},
+                       {"api_calls_per_draw",
+                        static_cast<f64>(apiCalls) / drawCount},
+                       {"engine_ns_per_draw", engine},
+                       {"dawn_encoding_ns_per_draw", dawn},
+                       {"dawn_validation_ns_per_draw", validation},
+                       {"total_ns_per_draw", total}});
+  }
+
+  const json report = {{"backend", "null"},
+                       {"repetitions", options.Repetitions},
+                       {"results", results}};
+  std::ofstream file(options.OutputPath);
+  if (!file) {
+    LogError("Could not write %s", options.OutputPath.c_str());
+    return EXIT_FAILURE;
+  }
+  file << report.dump(2) << '\n';
+  LogInfo("Wrote %s", options.OutputPath.c_str());
+  return EXIT_SUCCESS;
+}
+
+} // namespace photon
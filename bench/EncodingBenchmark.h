@@ -0,0 +1,32 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_ENCODINGBENCHMARK_H
+#define PHOTON_ENCODINGBENCHMARK_H
+
+#include "src/core/PhotonCore.h"
+#include <string>
+#include <vector>
+
+namespace photon {
+
+struct EncodingBenchmarkOptions {
+  std::vector<u32> DrawCounts{1000, 10000, 100000};
+  // Timed runs per draw count and variant; the median is reported.
+  u32 Repetitions = 20;
+  std::string OutputPath = "bench_encoding.json";
+};
+
+// Measures the CPU cost per draw of encoding a main pass the way Renderer
+// does, on the Null backend. Each draw count is encoded three ways:
+//   engine      state tracking and argument setup into a no-op encoder
+//   encoding    the same into Dawn with skip_validation
+//   validation  the same into Dawn with validation on
+// Dawn's share is encoding minus engine, its validation the difference
+// between the last two. Returns an exit code.
+int RunEncodingBenchmark(const EncodingBenchmarkOptions &options);
+
+} // namespace photon
+
+#endif // PHOTON_ENCODINGBENCHMARK_H
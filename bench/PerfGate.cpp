@@ -0,0 +1,222 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "PerfGate.h"
+#include "src/core/Logger.h"
+#include "src/core/PhotonCore.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <json.hpp>
+
+namespace photon {
+
+namespace {
+
+using json = nlohmann::json;
+
+constexpr f64 kDefaultTolerance = 0.1;
+
+bool ReadJson(const std::string &path, json &out) {
+  std::ifstream file(path);
+  out = json::parse(file, nullptr, false);
+  if (!file || out.is_discarded()) {
+    LogError("Could not read %s", path.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::string Quote(const std::string &argument) {
+  return '"' + argument + '"';
+}
+
+// Splits on dots outside brackets, so selector values may contain dots.
+std::vector<std::string> SplitPath(const std::string &path) {
+  std::vector<std::string> segments(1);
+  u32 depth = 0;
+  for (const char c : path) {
+    if (c == '[')
+      ++depth;
+    else if (c == ']' && depth > 0)
+      --depth;
+    if (c == '.' && depth == 0)
+      segments.emplace_back();
+    else
+      segments.back() += c;
+  }
+  return segments;
+}
+
+// Resolves a metric path in report, or returns null when any part of it is
+// missing.
+const json *FindMetric(const json &report, const std::string &path) {
+  const json *node = &report;
+  for (const std::string &segment : SplitPath(path)) {
+    const size_t open = segment.find('[');
+    const std::string key = segment.substr(0, open);
+    if (!node->is_object() || !node->contains(key))
+      return nullptr;
+    node = &(*node)[key];
+    if (open == std::string::npos)
+      continue;
+
+    // key[field=value]
+    const size_t equals = segment.find('=', open);
+    const size_t close = segment.rfind(']');
+    if (equals == std::string::npos || close == std::string::npos ||
+        !node->is_array())
+      return nullptr;
+    const std::string field = segment.substr(open + 1, equals - open - 1);
+    const std::string value = segment.substr(equals + 1, close - equals - 1);
+    const json *match = nullptr;
+    for (const json &element : *node) {
+      if (!element.is_object() || !element.contains(field))
+        continue;
+      const json &candidate = element[field];
+      if ((candidate.is_string() && candidate.get<std::string>() == value) ||
+          candidate.dump() == value) {
+        match = &element;
+        break;
+      }
+    }
+    if (!match)
+      return nullptr;
+    node = match;
+  }
+  return node;
+}
+
+// Runs a benchmark and loads its report; false when it was skipped or
+// failed, with bSkipped telling the two apart.
+bool RunBenchmark(const PerfGateOptions &options, const json &benchmark,
+                  json &report, bool &bSkipped) {
+  bSkipped = false;
+  const std::string name = benchmark.value("name", std::string("unnamed"));
+  const std::filesystem::path executable =
+      std::filesystem::path(options.ExecutableDirectory) /
+      benchmark.value("executable", std::string("photon_bench"));
+  if (!std::filesystem::exists(executable) &&
+      benchmark.value("optional", false)) {
+    LogWarning("%s: %s not built, skipping", name.c_str(),
+               executable.string().c_str());
+    bSkipped = true;
+    return false;
+  }
+
+  const std::string reportPath =
+      benchmark.value("report", "gate_" + name + ".json");
+  // Flags ending in '=' take the path in the same argument.
+  const std::string outputFlag =
+      benchmark.value("output_flag", std::string("--output"));
+  std::string command = Quote(executable.string());
+  for (const json &argument : benchmark.value("args", json::array()))
+    command += " " + Quote(argument.get<std::string>());
+  command += outputFlag.ends_with('=')
+                 ? " " + Quote(outputFlag + reportPath)
+                 : " " + outputFlag + " " + Quote(reportPath);
+
+  LogInfo("%s: %s", name.c_str(), command.c_str());
+  std::error_code error;
+  std::filesystem::remove(reportPath, error);
+  if (std::system(command.c_str()) != 0) {
+    LogError("%s: benchmark failed", name.c_str());
+    return false;
+  }
+  return ReadJson(reportPath, report);
+}
+
+} // namespace
+
+int RunPerfGate(const PerfGateOptions &options) {
+  json baseline;
+  if (!ReadJson(options.BaselinePath, baseline))
+    return EXIT_FAILURE;
+
+  u32 regressions = 0;
+  u32 failures = 0;
+  u32 unrecorded = 0;
+  for (json &benchmark : baseline["benchmarks"]) {
+    const std::string name = benchmark.value("name", std::string("unnamed"));
+    json report;
+    bool bSkipped = false;
+    if (!RunBenchmark(options, benchmark, report, bSkipped)) {
+      if (!bSkipped)
+        ++failures;
+      continue;
+    }
+
+    LogInfo("%s", name.c_str());
+    LogInfo("  %-44s %12s %12s %9s", "metric", "baseline", "current",
+            "change");
+    for (auto &[path, metric] : benchmark["metrics"].items()) {
+      const json *current = FindMetric(report, path);
+      if (!current || !current->is_number()) {
+        LogError("  %-44s missing from the report", path.c_str());
+        ++failures;
+        continue;
+      }
+      const f64 value = current->get<f64>();
+      if (options.bUpdateBaseline) {
+        metric["value"] = value;
+        LogInfo("  %-44s %12s %12.4g", path.c_str(), "recorded", value);
+        continue;
+      }
+      if (!metric.contains("value") || metric["value"].is_null()) {
+        LogError("  %-44s %12s %12.4g", path.c_str(), "unrecorded", value);
+        ++unrecorded;
+        continue;
+      }
+
+      const f64 expected = metric["value"].get<f64>();
+      const f64 tolerance = metric.value("tolerance", kDefaultTolerance);
+      const f64 allowed =
+          std::max(tolerance * std::abs(expected), metric.value("slack", 0.0));
+      const f64 change = expected != 0.0 ? (value - expected) / expected
+                         : value > 0.0   ? 1.0
+                                         : 0.0;
+      if (value - expected > allowed) {
+        LogError("  %-44s %12.4g %12.4g %+8.1f%%  REGRESSED (allowed "
+                 "+%.4g)",
+                 path.c_str(), expected, value, change * 100.0, allowed);
+        ++regressions;
+      } else if (expected - value > allowed) {
+        LogInfo("  %-44s %12.4g %12.4g %+8.1f%%  improved; consider "
+                "--update-baseline",
+                path.c_str(), expected, value, change * 100.0);
+      } else {
+        LogInfo("  %-44s %12.4g %12.4g %+8.1f%%", path.c_str(), expected,
+                value, change * 100.0);
+      }
+    }
+  }
+
+  if (options.bUpdateBaseline) {
+    std::ofstream file(options.BaselinePath);
+    if (!file) {
+      LogError("Could not write %s", options.BaselinePath.c_str());
+      return EXIT_FAILURE;
+    }
+    file << baseline.dump(2) << '\n';
+    LogInfo("Updated %s", options.BaselinePath.c_str());
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  if (unrecorded > 0)
+    LogError("%u metrics have no baseline value yet; record them with "
+             "--update-baseline on the reference machine",
+             unrecorded);
+  if (regressions > 0 || failures > 0 || unrecorded > 0) {
+    LogError("Performance gate failed: %u regressions, %u errors, %u "
+             "unrecorded",
+             regressions, failures, unrecorded);
+    return EXIT_FAILURE;
+  }
+  LogInfo("Performance gate passed");
+  return EXIT_SUCCESS;
+}
+
+} // namespace photon
@@ -0,0 +1,45 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_PERFGATE_H
+#define PHOTON_PERFGATE_H
+
+#include <string>
+
+namespace photon {
+
+struct PerfGateOptions {
+  std::string BaselinePath = "bench/baseline.json";
+  // Directory of the benchmark executables named in the baseline.
+  std::string ExecutableDirectory = ".";
+  // Overwrites the baseline's values with this run's instead of comparing.
+  bool bUpdateBaseline = false;
+};
+
+// Runs every benchmark listed in the baseline file, reads the metrics it
+// names out of each JSON report and fails when one is worse than its
+// baseline by more than its tolerance. The baseline looks like:
+//
+//   {"benchmarks": [{
+//      "name": "grid_256",
+//      "executable": "photon_bench",        // default
+//      "optional": false,                   // skip if not built
+//      "args": ["--scene", "grid_256", "--headless", "--backend", "null"],
+//      "report": "gate_grid_256.json",      // passed with output_flag
+//      "output_flag": "--output",           // default; "--x=" joins the path
+//      "metrics": {"frame_ms.p95": {"value": 3.2, "tolerance": 0.15}}}]}
+//
+// Metric paths are dot separated; key[field=value] picks the element of an
+// array whose field matches, e.g. results[draws=10000].total_ns_per_draw.
+// Every metric is lower-is-better. Its tolerance is relative to the value,
+// and an optional absolute "slack" allows at least that much on top of it,
+// for averaged counters near zero. A null value has not been recorded yet
+// and fails the gate until --update-baseline fills it in, so add a metric
+// with a null value and record it on the reference machine in the same
+// change. Returns an exit code.
+int RunPerfGate(const PerfGateOptions &options);
+
+} // namespace photon
+
+#endif // PHOTON_PERFGATE_H
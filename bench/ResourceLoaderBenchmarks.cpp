@@ -0,0 +1,216 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "BenchDevice.h"
+#include "src/core/Reader.h"
+#include "src/core/ResourceLoader.h"
+#include <algorithm>
+#include <array>
+#include <benchmark/benchmark.h>
+#include <bit>
+#include <stb_image.h>
+#include <string>
+#include <tiny_gltf.h>
+#include <vector>
+#include <webgpu/webgpu_cpp.h>
+
+// Microbenchmarks for asset import, split into the stages LoadMesh and
+// LoadTexture run. Stages that need a device use one on the Null backend,
+// which validates and records uploads without a GPU, so the numbers are the
+// CPU side of import only. Run from the build directory, where res lives:
+//   photon_microbench --benchmark_filter=Mesh
+// Build in Release; Debug also records profiling scopes.
+
+namespace {
+
+using namespace photon;
+
+constexpr std::array kMeshes{"sphere.glb", "box.glb", "su.glb"};
+constexpr std::array kTextures{"brick_c.jpg", "metal_c.png"};
+constexpr std::array kTextureTypes{ETextureImportType::jpg,
+                                   ETextureImportType::png};
+constexpr const char *kCubeMap = "golden_bay";
+constexpr const char *kShader = "shaders/pbr_mat.wgsl";
+
+wgpu::Device &NullDevice() {
+  static wgpu::Device device = CreateNullDevice();
+  return device;
+}
+
+std::string TexturePath(const char *name) {
+  return std::string("./res/textures/") + name;
+}
+
+tinygltf::Model ParseMesh(benchmark::State &state) {
+  tinygltf::Model model;
+  if (!ResourceLoader::ParseGltf(kMeshes[state.range(0)],
+                                 EModelImportType::glb, model))
+    state.SkipWithError("Could not parse mesh");
+  return model;
+}
+
+void BM_ParseGltf(benchmark::State &state) {
+  state.SetLabel(kMeshes[state.range(0)]);
+  for (auto _ : state) {
+    tinygltf::Model model;
+    benchmark::DoNotOptimize(ResourceLoader::ParseGltf(
+        kMeshes[state.range(0)], EModelImportType::glb, model));
+  }
+}
+
+void BM_CopyAccessors(benchmark::State &state) {
+  state.SetLabel(kMeshes[state.range(0)]);
+  const tinygltf::Model model = ParseMesh(state);
+  for (auto _ : state) {
+    CMesh mesh;
+    ResourceLoader::CopyAccessors(model, mesh);
+    benchmark::DoNotOptimize(mesh.pointData.data());
+  }
+}
+
+void BM_ComputeBounds(benchmark::State &state) {
+  state.SetLabel(kMeshes[state.range(0)]);
+  CMesh mesh;
+  ResourceLoader::CopyAccessors(ParseMesh(state), mesh);
+  for (auto _ : state) {
+    ResourceLoader::ComputeBounds(mesh);
+    benchmark::DoNotOptimize(mesh.boundsRadius);
+  }
+}
+
+// Clearing keeps the tangent storage, so this measures the math, not the
+// allocation.
+void BM_GenerateTangents(benchmark::State &state) {
+  state.SetLabel(kMeshes[state.range(0)]);
+  CMesh mesh;
+  ResourceLoader::CopyAccessors(ParseMesh(state), mesh);
+  for (auto _ : state) {
+    mesh.tangentData.clear();
+    mesh.bitangentData.clear();
+    ResourceLoader::GenerateTangents(mesh);
+    benchmark::DoNotOptimize(mesh.tangentData.data());
+  }
+}
+
+void BM_LoadMeshData(benchmark::State &state) {
+  state.SetLabel(kMeshes[state.range(0)]);
+  for (auto _ : state) {
+    CMesh mesh;
+    benchmark::DoNotOptimize(ResourceLoader::LoadMeshData(
+        kMeshes[state.range(0)], EModelImportType::glb, mesh));
+  }
+}
+
+void BM_LoadMesh(benchmark::State &state) {
+  state.SetLabel(kMeshes[state.range(0)]);
+  const wgpu::Device &device = NullDevice();
+  if (!device)
+    state.SkipWithError("No Null backend device");
+  for (auto _ : state) {
+    CMesh mesh = ResourceLoader::LoadMesh(kMeshes[state.range(0)], device);
+    benchmark::DoNotOptimize(mesh.positionBuffer.Get());
+  }
+}
+
+void BM_DecodeImage(benchmark::State &state) {
+  state.SetLabel(kTextures[state.range(0)]);
+  const std::string path = TexturePath(kTextures[state.range(0)]);
+  i32 width = 0, height = 0, channels = 0;
+  for (auto _ : state) {
+    u8 *pixels =
+        stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+      state.SkipWithError("Could not decode image");
+      break;
+    }
+    stbi_image_free(pixels);
+  }
+  state.SetBytesProcessed(static_cast<i64>(state.iterations()) * width *
+                          height * 4);
+}
+
+// The CPU half of WriteMipMaps: every level below the decoded one.
+void BM_MipChain(benchmark::State &state) {
+  state.SetLabel(kTextures[state.range(0)]);
+  const std::string path = TexturePath(kTextures[state.range(0)]);
+  i32 width = 0, height = 0, channels = 0;
+  u8 *pixels =
+      stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+  if (!pixels) {
+    state.SkipWithError("Could not decode image");
+    return;
+  }
+  MipLevel base{.Pixels = std::vector<u8>(pixels, pixels + width * height * 4),
+                .Width = static_cast<u32>(width),
+                .Height = static_cast<u32>(height)};
+  stbi_image_free(pixels);
+
+  // As many levels as LoadTexture creates.
+  const u32 levelCount = std::bit_width(std::max(base.Width, base.Height));
+  for (auto _ : state) {
+    MipLevel level = ResourceLoader::NextMipLevel(base);
+    for (u32 mip = 2; mip < levelCount; ++mip)
+      level = ResourceLoader::NextMipLevel(level);
+    benchmark::DoNotOptimize(level.Pixels.data());
+  }
+  state.SetBytesProcessed(static_cast<i64>(state.iterations()) *
+                          static_cast<i64>(base.Pixels.size()));
+}
+
+void BM_LoadTexture(benchmark::State &state) {
+  state.SetLabel(kTextures[state.range(0)]);
+  wgpu::Device &device = NullDevice();
+  if (!device)
+    state.SkipWithError("No Null backend device");
+  for (auto _ : state) {
+    wgpu::Texture texture = ResourceLoader::LoadTexture(
+        kTextures[state.range(0)], device, kTextureTypes[state.range(0)]);
+    benchmark::DoNotOptimize(texture.Get());
+  }
+}
+
+void BM_LoadCubeMap(benchmark::State &state) {
+  state.SetLabel(kCubeMap);
+  wgpu::Device &device = NullDevice();
+  if (!device)
+    state.SkipWithError("No Null backend device");
+  for (auto _ : state) {
+    wgpu::Texture texture =
+        ResourceLoader::LoadCubeMap(kCubeMap, device, ETextureImportType::png);
+    benchmark::DoNotOptimize(texture.Get());
+  }
+}
+
+void BM_ReadTextFile(benchmark::State &state) {
+  state.SetLabel(kShader);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(Reader::ReadTextFile(kShader));
+}
+
+constexpr i64 kLastMesh = static_cast<i64>(kMeshes.size()) - 1;
+constexpr i64 kLastTexture = static_cast<i64>(kTextures.size()) - 1;
+
+} // namespace
+
+BENCHMARK(BM_ParseGltf)
+    ->DenseRange(0, kLastMesh)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CopyAccessors)
+    ->DenseRange(0, kLastMesh)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ComputeBounds)
+    ->DenseRange(0, kLastMesh)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GenerateTangents)
+    ->DenseRange(0, kLastMesh)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LoadMeshData)
+    ->DenseRange(0, kLastMesh)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LoadMesh)->DenseRange(0, kLastMesh)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DecodeImage)
+    ->DenseRange(0, kLastTexture)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MipChain)
+    ->DenseRange(0, kLastTexture)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadTexture)
+    ->DenseRange(0, kLastTexture)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadCubeMap)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ReadTextFile)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
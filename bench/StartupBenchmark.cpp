@@ -0,0 +1,183 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "StartupBenchmark.h"
+#include "src/core/Logger.h"
+#include "src/core/StartupTimeline.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <json.hpp>
+#include <map>
+
+namespace photon {
+
+namespace {
+
+using json = nlohmann::json;
+
+// Gives up on launches whose pipelines never finish building.
+constexpr u32 kMaxStartupFrames = 600;
+constexpr const char *kChildReportPath = "./bench_startup_run.json";
+
+struct Samples {
+  // Keyed by name, in order of first appearance.
+  std::vector<std::string> Order;
+  std::map<std::string, u32> Depths;
+  std::map<std::string, std::vector<f64>> Values;
+
+  void Add(const std::string &name, f64 value, u32 depth = 0) {
+    if (!Values.contains(name)) {
+      Order.push_back(name);
+      Depths[name] = depth;
+    }
+    Values[name].push_back(value);
+  }
+};
+
+struct ModeSamples {
+  Samples Stages;
+  Samples Marks;
+  std::vector<f64> ProcessMs;
+};
+
+f64 Median(std::vector<f64> values) {
+  if (values.empty())
+    return 0.0;
+  std::nth_element(values.begin(), values.begin() + values.size() / 2,
+                   values.end());
+  return values[values.size() / 2];
+}
+
+std::string Quote(const std::string &argument) {
+  return '"' + argument + '"';
+}
+
+// Runs one child launch and adds its timeline to samples.
+bool Launch(const StartupBenchmarkOptions &options, ModeSamples *samples) {
+  std::string command = Quote(options.Executable) + " --startup-child" +
+                        " --output " + Quote(kChildReportPath);
+  for (const std::string &argument : options.Arguments)
+    command += " " + Quote(argument);
+
+  const auto start = std::chrono::steady_clock::now();
+  const int result = std::system(command.c_str());
+  const f64 processMs = std::chrono::duration<f64, std::milli>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+  if (result != 0) {
+    LogError("Startup launch failed: %s", command.c_str());
+    return false;
+  }
+
+  std::ifstream file(kChildReportPath);
+  const json report = json::parse(file, nullptr, false);
+  if (report.is_discarded()) {
+    LogError("Could not read %s", kChildReportPath);
+    return false;
+  }
+  if (!samples)
+    return true;
+
+  for (const json &stage : report["stages"])
+    samples->Stages.Add(stage["name"].get<std::string>(),
+                        stage["duration_ms"].get<f64>(),
+                        stage["depth"].get<u32>());
+  for (const json &mark : report["marks"])
+    samples->Marks.Add(mark["name"].get<std::string>(),
+                       mark["time_ms"].get<f64>());
+  samples->ProcessMs.push_back(processMs);
+  return true;
+}
+
+json Summarize(const ModeSamples &samples) {
+  json stages = json::array();
+  for (const std::string &name : samples.Stages.Order) {
+    const std::vector<f64> &values = samples.Stages.Values.at(name);
+    stages.push_back(
+        {{"name", name},
+         {"depth", samples.Stages.Depths.at(name)},
+         {"median_ms", Median(values)},
+         {"min_ms", *std::min_element(values.begin(), values.end())},
+         {"max_ms", *std::max_element(values.begin(), values.end())}});
+  }
+  json marks = json::array();
+  for (const std::string &name : samples.Marks.Order)
+    marks.push_back(
+        {{"name", name}, {"median_ms", Median(samples.Marks.Values.at(name))}});
+  // Launch to exit, so it includes loading the executable and shutdown.
+  return {{"stages", stages},
+          {"marks", marks},
+          {"process_median_ms", Median(samples.ProcessMs)}};
+}
+
+} // namespace
+
+int RunStartupChild(RunOptions options, const std::string &outputPath) {
+  options.FrameCount = kMaxStartupFrames;
+  options.OnFrameEnd = [](u64) {
+    return !StartupTimeline::Instance().HasMark(
+        StartupTimeline::kPipelinesReady);
+  };
+  const int result = Renderer::Run(options);
+  if (result != EXIT_SUCCESS)
+    return result;
+  return StartupTimeline::Instance().WriteJson(outputPath) ? EXIT_SUCCESS
+                                                           : EXIT_FAILURE;
+}
+
+int RunStartupBenchmark(const StartupBenchmarkOptions &options) {
+  std::error_code error;
+  ModeSamples cold;
+  for (u32 run = 0; run < options.Runs; ++run) {
+    std::filesystem::remove_all(kPipelineCachePath, error);
+    if (!Launch(options, &cold))
+      return EXIT_FAILURE;
+  }
+
+  // The last cold launch already filled the cache; one more makes sure
+  // everything requested at startup was stored.
+  ModeSamples warm;
+  if (!Launch(options, nullptr))
+    return EXIT_FAILURE;
+  for (u32 run = 0; run < options.Runs; ++run) {
+    if (!Launch(options, &warm))
+      return EXIT_FAILURE;
+  }
+  std::filesystem::remove(kChildReportPath, error);
+
+  LogInfo("%-24s %12s %12s", "stage (median)", "cold ms", "warm ms");
+  for (const std::string &name : cold.Stages.Order) {
+    const u32 depth = cold.Stages.Depths.at(name);
+    const f64 warmMs = warm.Stages.Values.contains(name)
+                           ? Median(warm.Stages.Values.at(name))
+                           : 0.0;
+    LogInfo("%*s%-*s %12.2f %12.2f", depth * 2, "", 24 - depth * 2,
+            name.c_str(), Median(cold.Stages.Values.at(name)), warmMs);
+  }
+  for (const std::string &name : cold.Marks.Order) {
+    const f64 warmMs = warm.Marks.Values.contains(name)
+                           ? Median(warm.Marks.Values.at(name))
+                           : 0.0;
+    LogInfo("%-24s %12.2f %12.2f", name.c_str(),
+            Median(cold.Marks.Values.at(name)), warmMs);
+  }
+
+  const json report = {{"runs", options.Runs},
+                       {"arguments", options.Arguments},
+                       {"cold", Summarize(cold)},
+                       {"warm", Summarize(warm)}};
+  std::ofstream file(options.OutputPath);
+  if (!file) {
+    LogError("Could not write %s", options.OutputPath.c_str());
+    return EXIT_FAILURE;
+  }
+  file << report.dump(2) << '\n';
+  LogInfo("Wrote %s", options.OutputPath.c_str());
+  return EXIT_SUCCESS;
+}
+
+} // namespace photon
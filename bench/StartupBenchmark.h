@@ -0,0 +1,37 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_STARTUPBENCHMARK_H
+#define PHOTON_STARTUPBENCHMARK_H
+
+#include "src/core/Renderer.h"
+#include <string>
+#include <vector>
+
+namespace photon {
+
+struct StartupBenchmarkOptions {
+  // This executable; every launch is a fresh process.
+  std::string Executable;
+  // Launches per mode; medians are reported.
+  u32 Runs = 5;
+  // Passed through to each launch, e.g. --headless or --scene.
+  std::vector<std::string> Arguments;
+  std::string OutputPath = "bench_startup.json";
+};
+
+// Launches the engine repeatedly until its first frame with every pipeline
+// ready, cold (pipeline cache deleted before each launch) and then warm
+// (cache filled by an untimed launch first), and reports the median startup
+// timeline of each. The OS file cache is not dropped, so cold means a cold
+// Dawn cache, not a cold disk. Returns an exit code.
+int RunStartupBenchmark(const StartupBenchmarkOptions &options);
+
+// One launch: runs until startup completes and writes the timeline to
+// outputPath.
+int RunStartupChild(RunOptions options, const std::string &outputPath);
+
+} // namespace photon
+
+#endif // PHOTON_STARTUPBENCHMARK_H
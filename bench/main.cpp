@@ -0,0 +1,315 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "EncodingBenchmark.h"
+#include "PerfGate.h"
+#include "StartupBenchmark.h"
+#include "src/core/CommandLine.h"
+#include "src/core/Logger.h"
+#include "src/core/Renderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <json.hpp>
+#include <numeric>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+// Renders a scene for a warm-up period and then a fixed number of measured
+// frames, and writes frame, CPU and GPU time distributions as JSON:
+//   photon_bench [--scene NAME|FILE] [--warmup N] [--frames N] [--output FILE]
+//                [any photon run option]
+// A NAME without ".json" resolves to bench/scenes/NAME.json. Dynamic
+// resolution is off unless --dynamic-resolution on is given.
+//
+// With --encoding it instead measures per-draw encoding overhead on the Null
+// backend, see EncodingBenchmark.h:
+//   photon_bench --encoding [--draws N,N,...] [--repeat N] [--output FILE]
+//
+// With --startup it launches itself repeatedly and reports cold and warm
+// startup timelines, see StartupBenchmark.h:
+//   photon_bench --startup [--runs N] [--scene NAME|FILE] [--output FILE]
+//                [any photon run option]
+//
+// With --gate it runs the benchmarks listed in a baseline file and fails on
+// regressions, see PerfGate.h:
+//   photon_bench --gate FILE [--update-baseline]
+
+using json = nlohmann::json;
+
+namespace {
+
+struct BenchOptions {
+  std::string ScenePath = "bench/scenes/default.json";
+  u32 WarmupFrames = 60;
+  u32 MeasuredFrames = 600;
+  std::string OutputPath;
+
+  bool bEncoding = false;
+  photon::EncodingBenchmarkOptions Encoding;
+
+  bool bStartup = false;
+  // Set on the launches made by --startup.
+  bool bStartupChild = false;
+  photon::StartupBenchmarkOptions Startup;
+
+  bool bGate = false;
+  photon::PerfGateOptions Gate;
+};
+
+struct Samples {
+  std::vector<f32> FrameMs;
+  std::vector<f32> CpuMs;
+  std::vector<f32> GpuMs;
+  std::vector<f32> ResolutionScale;
+};
+
+json Summarize(std::vector<f32> samples) {
+  if (samples.empty())
+    return nullptr;
+  std::sort(samples.begin(), samples.end());
+  const f64 sum = std::accumulate(samples.begin(), samples.end(), 0.0);
+  return {{"samples", samples.size()},
+          {"mean", sum / static_cast<f64>(samples.size())},
+          {"min", samples.front()},
+          {"max", samples.back()},
+          {"p50", photon::Percentile(samples, 0.50f)},
+          {"p95", photon::Percentile(samples, 0.95f)},
+          {"p99", photon::Percentile(samples, 0.99f)}};
+}
+
+json ToJson(const photon::FrameStats &stats) {
+  return {{"draw_calls", stats.DrawCalls},
+          {"indirect_draw_calls", stats.IndirectDrawCalls},
+          {"triangles", stats.Triangles},
+          {"pipeline_switches", stats.PipelineSwitches},
+          {"bind_group_switches", stats.BindGroupSwitches},
+          {"buffer_bytes_uploaded", stats.BufferBytesUploaded},
+          {"texture_bytes_uploaded", stats.TextureBytesUploaded},
+          {"command_buffers_submitted", stats.CommandBuffersSubmitted}};
+}
+
+json ToJson(const photon::FramePacingStats &stats) {
+  return {{"interval_p50_ms", stats.P50IntervalMs},
+          {"interval_p95_ms", stats.P95IntervalMs},
+          {"interval_p99_ms", stats.P99IntervalMs},
+          {"jitter_ms", stats.JitterMs},
+          {"hitches", stats.HitchCount},
+          {"gpu_latency_ms", stats.AverageLatencyMs},
+          {"gpu_latency_p95_ms", stats.P95LatencyMs},
+          {"throttle_ms", stats.AverageThrottleMs},
+          {"frames_in_flight", stats.AverageFramesInFlight},
+          {"input_latency_ms", stats.AverageInputLatencyMs},
+          {"input_latency_p95_ms", stats.P95InputLatencyMs}};
+}
+
+const char *PresentModeName(wgpu::PresentMode mode) {
+  switch (mode) {
+  case wgpu::PresentMode::Mailbox:
+    return "mailbox";
+  case wgpu::PresentMode::Immediate:
+    return "immediate";
+  default:
+    return "fifo";
+  }
+}
+
+const char *BackendName(const photon::RunOptions &options) {
+  if (options.bForceFallbackAdapter)
+    return "swiftshader";
+  switch (options.Backend) {
+  case wgpu::BackendType::Null:
+    return "null";
+  case wgpu::BackendType::Vulkan:
+    return "vulkan";
+  case wgpu::BackendType::Metal:
+    return "metal";
+  case wgpu::BackendType::D3D12:
+    return "d3d12";
+  default:
+    return "default";
+  }
+}
+
+// Takes the bench's own flags out of argv and leaves the rest, program name
+// included, for ParseRunOptions.
+std::vector<char *> ParseBenchOptions(int argc, char **argv,
+                                      BenchOptions &options) {
+  std::vector<char *> remaining{argv[0]};
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (value && arg == "--scene") {
+      options.ScenePath = value;
+      if (!options.ScenePath.ends_with(".json"))
+        options.ScenePath = "bench/scenes/" + options.ScenePath + ".json";
+    } else if (value && arg == "--warmup") {
+      options.WarmupFrames = static_cast<u32>(std::atoi(value));
+    } else if (value && arg == "--frames") {
+      options.MeasuredFrames = static_cast<u32>(std::atoi(value));
+    } else if (value && arg == "--output") {
+      options.OutputPath = value;
+    } else if (arg == "--encoding") {
+      options.bEncoding = true;
+      continue;
+    } else if (value && arg == "--draws") {
+      options.Encoding.DrawCounts.clear();
+      std::stringstream counts(value);
+      for (std::string count; std::getline(counts, count, ',');)
+        options.Encoding.DrawCounts.push_back(
+            static_cast<u32>(std::atoi(count.c_str())));
+    } else if (value && arg == "--repeat") {
+      options.Encoding.Repetitions = static_cast<u32>(std::atoi(value));
+    } else if (arg == "--startup") {
+      options.bStartup = true;
+      continue;
+    } else if (arg == "--startup-child") {
+      options.bStartupChild = true;
+      continue;
+    } else if (value && arg == "--runs") {
+      options.Startup.Runs = static_cast<u32>(std::atoi(value));
+    } else if (value && arg == "--gate") {
+      options.bGate = true;
+      options.Gate.BaselinePath = value;
+    } else if (arg == "--update-baseline") {
+      options.Gate.bUpdateBaseline = true;
+      continue;
+    } else {
+      remaining.push_back(argv[i]);
+      continue;
+    }
+    ++i;
+  }
+  return remaining;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  BenchOptions bench;
+  std::vector<char *> args = ParseBenchOptions(argc, argv, bench);
+  if (bench.bGate) {
+    bench.Gate.ExecutableDirectory =
+        std::filesystem::path(argv[0]).parent_path().string();
+    if (bench.Gate.ExecutableDirectory.empty())
+      bench.Gate.ExecutableDirectory = ".";
+    return photon::RunPerfGate(bench.Gate);
+  }
+  if (bench.bEncoding) {
+    if (!bench.OutputPath.empty())
+      bench.Encoding.OutputPath = bench.OutputPath;
+    return photon::RunEncodingBenchmark(bench.Encoding);
+  }
+  if (bench.bStartup) {
+    bench.Startup.Executable = argv[0];
+    bench.Startup.Arguments.assign(args.begin() + 1, args.end());
+    bench.Startup.Arguments.insert(bench.Startup.Arguments.end(),
+                                   {"--scene", bench.ScenePath});
+    if (!bench.OutputPath.empty())
+      bench.Startup.OutputPath = bench.OutputPath;
+    return photon::RunStartupBenchmark(bench.Startup);
+  }
+
+  photon::RunOptions options;
+  if (!photon::SceneDescription::LoadFromFile(bench.ScenePath, options.Scene))
+    return EXIT_FAILURE;
+  if (!photon::ParseRunOptions(static_cast<int>(args.size()), args.data(),
+                               options))
+    return EXIT_FAILURE;
+  if (bench.bStartupChild)
+    return photon::RunStartupChild(std::move(options), bench.OutputPath);
+  if (bench.MeasuredFrames == 0) {
+    photon::LogError("Nothing to measure");
+    return EXIT_FAILURE;
+  }
+  if (bench.OutputPath.empty())
+    bench.OutputPath = "bench_" + options.Scene.Name + ".json";
+
+  const u32 totalFrames = bench.WarmupFrames + bench.MeasuredFrames;
+  options.FrameCount = totalFrames;
+  // A render size that follows GPU time would make runs incomparable; it
+  // takes --dynamic-resolution on to measure with it.
+  const bool bDynamicResolution = options.DynamicResolution.value_or(false);
+  options.DynamicResolution = bDynamicResolution;
+
+  Samples samples;
+  samples.FrameMs.reserve(bench.MeasuredFrames);
+  samples.CpuMs.reserve(bench.MeasuredFrames);
+  samples.GpuMs.reserve(bench.MeasuredFrames);
+  samples.ResolutionScale.reserve(bench.MeasuredFrames);
+  auto lastFrameEnd = std::chrono::steady_clock::now();
+  u64 lastGpuFrame = 0;
+
+  // Frame time is end to end, so windowed runs include presentation and
+  // vsync. GPU times arrive a few frames late and only when the device has
+  // timestamp queries; anything resolved during warm-up is dropped.
+  options.OnFrameEnd = [&](u64 frame) {
+    const auto now = std::chrono::steady_clock::now();
+    const photon::Renderer &renderer = photon::Renderer::Instance();
+    const photon::GpuProfiler &profiler = renderer.GetGpuProfiler();
+    const u64 gpuFrame = profiler.GetResolvedFrameCount();
+
+    if (frame >= bench.WarmupFrames) {
+      // The first interval would include startup.
+      if (frame > 0)
+        samples.FrameMs.push_back(
+            std::chrono::duration<f32, std::milli>(now - lastFrameEnd)
+                .count());
+      samples.CpuMs.push_back(renderer.GetCpuFrameMs());
+      if (gpuFrame > lastGpuFrame)
+        samples.GpuMs.push_back(profiler.GetFrameMs());
+      samples.ResolutionScale.push_back(renderer.GetResolutionScale());
+    }
+    lastFrameEnd = now;
+    lastGpuFrame = gpuFrame;
+    return frame + 1 < totalFrames;
+  };
+
+  photon::LogInfo("Benchmarking %s: %u warm-up and %u measured frames",
+                  options.Scene.Name.c_str(), bench.WarmupFrames,
+                  bench.MeasuredFrames);
+  const int result = photon::Renderer::Run(options);
+  if (result != EXIT_SUCCESS)
+    return result;
+
+  const json report = {
+      {"scene", options.Scene.Name},
+      {"scene_file", bench.ScenePath},
+      {"mode", options.bHeadless ? "headless" : "windowed"},
+      {"backend", BackendName(options)},
+      {"width", options.Width},
+      {"height", options.Height},
+      {"present_mode", PresentModeName(options.PresentMode)},
+      {"max_frames_in_flight", options.MaxFramesInFlight},
+      {"simulation_thread", options.bSimulationThread},
+      {"dynamic_resolution", bDynamicResolution},
+      {"resolution_scale", Summarize(samples.ResolutionScale)},
+      {"instances", options.Scene.InstanceCount},
+      {"warmup_frames", bench.WarmupFrames},
+      {"measured_frames", samples.CpuMs.size()},
+      {"frame_ms", Summarize(samples.FrameMs)},
+      {"cpu_ms", Summarize(samples.CpuMs)},
+      {"gpu_ms", Summarize(samples.GpuMs)},
+      {"render_stats", ToJson(photon::RenderStats::Instance().GetAverage())},
+      {"pacing",
+       ToJson(photon::Renderer::Instance().GetFramePacer().GetStats())}};
+
+  std::ofstream file(bench.OutputPath);
+  if (!file) {
+    photon::LogError("Could not write %s", bench.OutputPath.c_str());
+    return EXIT_FAILURE;
+  }
+  file << report.dump(2) << '\n';
+
+  const json &frameMs = report["frame_ms"];
+  if (!frameMs.is_null())
+    photon::LogInfo("%s: frame p50 %.3f ms, p95 %.3f ms, p99 %.3f ms",
+                    options.Scene.Name.c_str(), frameMs["p50"].get<f64>(),
+                    frameMs["p95"].get<f64>(), frameMs["p99"].get<f64>());
+  photon::LogInfo("Wrote %s", bench.OutputPath.c_str());
+  return EXIT_SUCCESS;
+}
@@ -1,6 +1,15 @@
+#include "src/core/CommandLine.h"
 #include "src/core/Renderer.h"
+#include <cstdlib>
 
-int main()
+int main(int argc, char **argv)
 {
+#if !defined(__EMSCRIPTEN__)
+  photon::RunOptions options;
+  if (!photon::ParseRunOptions(argc, argv, options))
+    return EXIT_FAILURE;
+  return photon::Renderer::Run(options);
+#else
   return photon::Renderer::Go();
+#endif
 }
@@ -0,0 +1,87 @@
+const MAX_CLUSTER_LIGHTS = 63u;
+
+struct ClusterUniforms {
+    view: mat4x4f,
+    inverse_proj: mat4x4f,
+    screen_size: vec2f,
+    near: f32,
+    far: f32,
+    grid_size: vec3u,
+    light_count: u32,
+    slice_scale: f32,
+    slice_bias: f32
+}
+
+struct Light {
+    position: vec3f,
+    radius: f32,
+    color: vec3f,
+    intensity: f32,
+    direction: vec3f,
+    spot_cos: f32,
+    shadow_tile: i32,
+    shadow_faces: u32
+}
+
+struct Cluster {
+    count: u32,
+    lights: array<u32, MAX_CLUSTER_LIGHTS>
+}
+
+@group(0) @binding(0) var<uniform> u_clusters: ClusterUniforms;
+@group(0) @binding(1) var<storage, read> lights: array<Light>;
+@group(0) @binding(2) var<storage, read_write> clusters: array<Cluster>;
+
+// View-space point at depth 1 along the ray through a pixel.
+fn view_ray(pixel: vec2f) -> vec3f {
+    let ndc = vec2f(pixel.x / u_clusters.screen_size.x * 2.0 - 1.0,
+                    1.0 - pixel.y / u_clusters.screen_size.y * 2.0);
+    let point = u_clusters.inverse_proj * vec4f(ndc, 1.0, 1.0);
+    let view = point.xyz / point.w;
+    return view / -view.z;
+}
+
+fn slice_depth(slice: u32) -> f32 {
+    return u_clusters.near * pow(u_clusters.far / u_clusters.near, f32(slice) / f32(u_clusters.grid_size.z));
+}
+
+@compute @workgroup_size(64)
+fn cs_main(@builtin(global_invocation_id) id: vec3u) {
+    let grid = u_clusters.grid_size;
+    let index = id.x;
+    if (index >= grid.x * grid.y * grid.z) {
+        return;
+    }
+
+    let cell = vec3u(index % grid.x, (index / grid.x) % grid.y, index / (grid.x * grid.y));
+    let tile_size = u_clusters.screen_size / vec2f(grid.xy);
+    let min_pixel = vec2f(cell.xy) * tile_size;
+    let max_pixel = min_pixel + tile_size;
+
+    var rays = array<vec3f, 4>(
+        view_ray(min_pixel),
+        view_ray(vec2f(max_pixel.x, min_pixel.y)),
+        view_ray(vec2f(min_pixel.x, max_pixel.y)),
+        view_ray(max_pixel));
+    let near_depth = slice_depth(cell.z);
+    let far_depth = slice_depth(cell.z + 1u);
+
+    var aabb_min = vec3f(1e30);
+    var aabb_max = vec3f(-1e30);
+    for (var i = 0u; i < 4u; i++) {
+        aabb_min = min(aabb_min, min(rays[i] * near_depth, rays[i] * far_depth));
+        aabb_max = max(aabb_max, max(rays[i] * near_depth, rays[i] * far_depth));
+    }
+
+    var count = 0u;
+    for (var i = 0u; i < u_clusters.light_count && count < MAX_CLUSTER_LIGHTS; i++) {
+        let light = lights[i];
+        let center = (u_clusters.view * vec4f(light.position, 1.0)).xyz;
+        let offset = clamp(center, aabb_min, aabb_max) - center;
+        if (dot(offset, offset) <= light.radius * light.radius) {
+            clusters[index].lights[count] = i;
+            count++;
+        }
+    }
+    clusters[index].count = count;
+}
@@ -1,5 +1,9 @@
-struct Uniforms {
+struct FrameUniforms {
+  view: mat4x4f,
+  proj: mat4x4f,
   viewDirectionProjectionInverse: mat4x4f,
+  viewPos: vec3f,
+  deltaTime: f32,
 };
 
 struct VSOutput {
@@ -7,7 +11,7 @@ struct VSOutput {
   @location(0) pos: vec4f,
 };
 
-@group(0) @binding(0) var<uniform> uni: Uniforms;
+@group(0) @binding(0) var<uniform> uni: FrameUniforms;
 @group(0) @binding(1) var ourSampler: sampler;
 @group(0) @binding(2) var ourTexture: texture_cube<f32>;
 
@@ -0,0 +1,119 @@
+struct CullUniforms {
+    planes: array<vec4f, 6>,
+    view_proj: mat4x4f,
+    camera_pos: vec3f,
+    instance_count: u32,
+    lod_distance: f32,
+    phase: u32,
+    draw_count: u32,
+    pyramid_mip_count: u32,
+    pyramid_size: vec2f
+}
+
+struct Instance {
+    model: mat4x4f,
+    sphere: vec4f,
+    first_draw: u32,
+    lod_count: u32
+}
+
+struct DrawCommand {
+    index_count: u32,
+    instance_count: atomic<u32>,
+    first_index: u32,
+    base_vertex: i32,
+    first_instance: u32
+}
+
+@group(0) @binding(0) var<uniform> u_cull: CullUniforms;
+@group(0) @binding(1) var<storage, read> instances: array<Instance>;
+@group(0) @binding(2) var<storage, read> draw_offsets: array<u32>;
+@group(0) @binding(3) var<storage, read_write> draws: array<DrawCommand>;
+@group(0) @binding(4) var<storage, read_write> visible_instances: array<u32>;
+@group(0) @binding(5) var<storage, read_write> visibility: array<u32>;
+@group(0) @binding(6) var depth_pyramid: texture_2d<f32>;
+
+fn is_in_frustum(sphere: vec4f) -> bool {
+    for (var i = 0u; i < 6u; i++) {
+        let plane = u_cull.planes[i];
+        if (dot(plane.xyz, sphere.xyz) + plane.w <= -sphere.w) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Projects the sphere's bounding cube and compares its nearest depth with the
+// farthest depth of the pyramid texels covering its screen rectangle.
+fn is_occluded(sphere: vec4f) -> bool {
+    var ndc_min = vec3f(1e30);
+    var ndc_max = vec2f(-1e30);
+    for (var i = 0u; i < 8u; i++) {
+        let corner = sphere.xyz + sphere.w * vec3f(
+            select(-1.0, 1.0, (i & 1u) != 0u),
+            select(-1.0, 1.0, (i & 2u) != 0u),
+            select(-1.0, 1.0, (i & 4u) != 0u));
+        let clip = u_cull.view_proj * vec4f(corner, 1.0);
+        if (clip.w <= 0.0) {
+            // Crosses the camera plane; the projection is unbounded.
+            return false;
+        }
+        let ndc = clip.xyz / clip.w;
+        ndc_min = min(ndc_min, ndc);
+        ndc_max = max(ndc_max, ndc.xy);
+    }
+
+    let uv_min = clamp(vec2f(ndc_min.x, -ndc_max.y) * 0.5 + 0.5, vec2f(0.0), vec2f(1.0));
+    let uv_max = clamp(vec2f(ndc_max.x, -ndc_min.y) * 0.5 + 0.5, vec2f(0.0), vec2f(1.0));
+    let pixel_last = vec2u(u_cull.pyramid_size) - 1u;
+    let pixel_min = min(vec2u(uv_min * u_cull.pyramid_size), pixel_last);
+    let pixel_max = min(vec2u(uv_max * u_cull.pyramid_size), pixel_last);
+
+    // Coarsest level at which the rectangle spans at most two texels per axis.
+    let extent = f32(max(pixel_max.x - pixel_min.x, pixel_max.y - pixel_min.y));
+    let level = min(u32(ceil(log2(max(extent, 1.0)))), u_cull.pyramid_mip_count - 1u);
+    let level_last = textureDimensions(depth_pyramid, level) - 1u;
+    let texel_min = min(pixel_min >> vec2u(level), level_last);
+    let texel_max = min(pixel_max >> vec2u(level), level_last);
+
+    let depth = max(
+        max(textureLoad(depth_pyramid, texel_min, level).r,
+            textureLoad(depth_pyramid, vec2u(texel_max.x, texel_min.y), level).r),
+        max(textureLoad(depth_pyramid, vec2u(texel_min.x, texel_max.y), level).r,
+            textureLoad(depth_pyramid, texel_max, level).r));
+
+    return ndc_min.z > depth;
+}
+
+@compute @workgroup_size(64)
+fn cs_main(@builtin(global_invocation_id) id: vec3u) {
+    let index = id.x;
+    if (index >= u_cull.instance_count) {
+        return;
+    }
+
+    let instance = instances[index];
+    let was_visible = visibility[index] != 0u;
+
+    if (u_cull.phase == 0u) {
+        // Draw last frame's visible set; it becomes this frame's occluders.
+        if (!was_visible || !is_in_frustum(instance.sphere)) {
+            return;
+        }
+    } else {
+        let is_visible = is_in_frustum(instance.sphere) && !is_occluded(instance.sphere);
+        visibility[index] = select(0u, 1u, is_visible);
+        // Anything visible last frame was already drawn in phase 0.
+        if (!is_visible || was_visible) {
+            return;
+        }
+    }
+
+    let distance = length(instance.sphere.xyz - u_cull.camera_pos);
+    let lod_range = max(instance.sphere.w * u_cull.lod_distance, 0.0001);
+    let lod = min(u32(distance / lod_range), instance.lod_count - 1u);
+
+    let draw = u_cull.phase * u_cull.draw_count + instance.first_draw + lod;
+    let slot = atomicAdd(&draws[draw].instance_count, 1u);
+    visible_instances[draw_offsets[draw] + slot] = index;
+}
@@ -0,0 +1,41 @@
+// cs_copy_depth uses bindings 1 and 2, cs_downsample bindings 0 and 1.
+@group(0) @binding(0) var source: texture_2d<f32>;
+@group(0) @binding(1) var destination: texture_storage_2d<r32float, write>;
+@group(0) @binding(2) var depth_texture: texture_depth_2d;
+
+@compute @workgroup_size(8, 8)
+fn cs_copy_depth(@builtin(global_invocation_id) id: vec3u) {
+    let size = textureDimensions(destination);
+    if (any(id.xy >= size)) {
+        return;
+    }
+
+    let depth = textureLoad(depth_texture, id.xy, 0);
+    textureStore(destination, id.xy, vec4f(depth, 0.0, 0.0, 1.0));
+}
+
+@compute @workgroup_size(8, 8)
+fn cs_downsample(@builtin(global_invocation_id) id: vec3u) {
+    let size = textureDimensions(destination);
+    if (any(id.xy >= size)) {
+        return;
+    }
+
+    // The last texel of an odd-sized source row/column also covers the
+    // trailing one, so nothing is dropped.
+    let source_size = textureDimensions(source, 0);
+    let last = id.xy == size - 1u;
+    let odd = (source_size & vec2u(1u)) != vec2u(0u);
+    let extent = select(vec2u(2u), vec2u(3u), last & odd);
+
+    let base = id.xy * 2u;
+    var depth = 0.0;
+    for (var y = 0u; y < extent.y; y++) {
+        for (var x = 0u; x < extent.x; x++) {
+            let texel = min(base + vec2u(x, y), source_size - 1u);
+            depth = max(depth, textureLoad(source, texel, 0).r);
+        }
+    }
+
+    textureStore(destination, id.xy, vec4f(depth, 0.0, 0.0, 1.0));
+}
@@ -8,7 +8,8 @@ struct VertexInput {
 }
 
 struct VertexOutput {
-	@builtin(position) position: vec4f,
+	// Invariant so shading matches the depth prepass exactly under Equal.
+	@builtin(position) @invariant position: vec4f,
 	@location(0) color: vec4f,
     @location(1) normal: vec3f,
     @location(2) tangent: vec3f,
@@ -22,38 +23,117 @@ struct VertexOutput {
     @location(10) roughness: f32
 }
 
-struct MyUniforms {
-    model : mat4x4f,
+struct FrameUniforms {
     view : mat4x4<f32>,
     proj : mat4x4<f32>,
+    skybox_mvpi : mat4x4<f32>,
     view_pos: vec3f,
-    delta_time : f32,
+    delta_time : f32
+}
+
+struct MaterialUniforms {
     metalic: f32,
     roughness: f32
 }
 
-@group(0) @binding(0) var<uniform> u_uniforms: MyUniforms;
+struct ObjectUniforms {
+    model : mat4x4f
+}
+
+const MAX_CLUSTER_LIGHTS = 63u;
+
+struct ClusterUniforms {
+    view: mat4x4f,
+    inverse_proj: mat4x4f,
+    screen_size: vec2f,
+    near: f32,
+    far: f32,
+    grid_size: vec3u,
+    light_count: u32,
+    slice_scale: f32,
+    slice_bias: f32
+}
+
+struct Light {
+    position: vec3f,
+    radius: f32,
+    color: vec3f,
+    intensity: f32,
+    direction: vec3f,
+    spot_cos: f32,
+    shadow_tile: i32,
+    shadow_faces: u32
+}
+
+struct Cluster {
+    count: u32,
+    lights: array<u32, MAX_CLUSTER_LIGHTS>
+}
+
+const SHADOW_CASCADES = 4u;
+
+struct ShadowUniforms {
+    view_proj: array<mat4x4f, SHADOW_CASCADES>,
+    split_depths: vec4f,
+    light_dir: vec3f,
+    depth_bias: f32,
+    light_color: vec3f,
+    normal_bias: f32,
+    texel_size: f32
+}
+
+struct ShadowTile {
+    view_proj: mat4x4f,
+    rect: vec4f
+}
+
+@group(0) @binding(0) var<uniform> u_frame: FrameUniforms;
 @group(0) @binding(1) var texture_sampler: sampler;
+@group(0) @binding(2) var irradiance_texture: texture_cube<f32>;
+@group(0) @binding(3) var<storage, read> lights: array<Light>;
+@group(0) @binding(4) var<storage, read> clusters: array<Cluster>;
+@group(0) @binding(5) var<uniform> u_clusters: ClusterUniforms;
+@group(0) @binding(6) var shadow_map: texture_depth_2d_array;
+@group(0) @binding(7) var shadow_sampler: sampler_comparison;
+@group(0) @binding(8) var<uniform> u_shadow: ShadowUniforms;
+@group(0) @binding(9) var shadow_atlas: texture_depth_2d;
+@group(0) @binding(10) var<storage, read> shadow_tiles: array<ShadowTile>;
+
+@group(1) @binding(0) var<uniform> u_material: MaterialUniforms;
+@group(1) @binding(1) var base_color_texture: texture_2d<f32>;
+@group(1) @binding(2) var normal_texture: texture_2d<f32>;
+@group(1) @binding(3) var metallic_texture: texture_2d<f32>;
+@group(1) @binding(4) var roughness_texture: texture_2d<f32>;
+
+@group(2) @binding(0) var<uniform> u_object: ObjectUniforms;
+
+// Instanced path: group 2 is owned by GpuScene instead of a per-object buffer.
+struct DrawUniforms {
+    visible_offset: u32
+}
 
-@group(0) @binding(2) var base_color_texture: texture_2d<f32>;
-@group(0) @binding(3) var normal_texture: texture_2d<f32>;
-@group(0) @binding(4) var roughness_texture: texture_2d<f32>;
-@group(0) @binding(5) var metallic_texture: texture_2d<f32>;
+struct Instance {
+    model: mat4x4f,
+    sphere: vec4f,
+    first_draw: u32,
+    lod_count: u32
+}
 
-@group(0) @binding(6) var irradiance_texture: texture_cube<f32>;
+@group(2) @binding(1) var<uniform> u_draw: DrawUniforms;
+@group(2) @binding(2) var<storage, read> instances: array<Instance>;
+@group(2) @binding(3) var<storage, read> visible_instances: array<u32>;
 
 const PI = 3.14159265359;
 
-@vertex
-fn vs_main(in: VertexInput) -> VertexOutput {
+fn transform_vertex(in: VertexInput, model: mat4x4f) -> VertexOutput {
     var out: VertexOutput;
-    out.position = u_uniforms.proj * u_uniforms.view * u_uniforms.model * vec4f(in.position, 1.0);
+    out.position = u_frame.proj * u_frame.view * model * vec4f(in.position, 1.0);
 
-    let worldPosition = u_uniforms.model * vec4f(in.position, 1.0);
+    let worldPosition = model * vec4f(in.position, 1.0);
 
-    let T = normalize((u_uniforms.model * vec4f(in.tangent, 0.0)).xyz);
-    let B = normalize((u_uniforms.model * vec4f(in.bitangent, 0.0)).xyz);
-    let N = normalize((u_uniforms.model * vec4f(in.normal, 0.0)).xyz);
+    let T = normalize((model * vec4f(in.tangent, 0.0)).xyz);
+    let B = normalize((model * vec4f(in.bitangent, 0.0)).xyz);
+    let N = normalize((model * vec4f(in.normal, 0.0)).xyz);
 
     out.tangent = T;
     out.bitangent = B;
@@ -61,15 +141,42 @@ fn vs_main(in: VertexInput) -> VertexOutput {
 
     out.uv = in.uv;
     out.color = in.color;
-    out.view_pos = u_uniforms.view_pos;
-    out.frag_pos = (u_uniforms.model * vec4f(in.position, 1.0)).xyz;
-    out.metalness = u_uniforms.metalic;
-    out.roughness = u_uniforms.roughness;
-    out.delta_time = u_uniforms.delta_time;
+    out.view_pos = u_frame.view_pos;
+    out.frag_pos = worldPosition.xyz;
+    out.metalness = u_material.metalic;
+    out.roughness = u_material.roughness;
+    out.delta_time = u_frame.delta_time;
     out.view_dir = out.view_pos - worldPosition.xyz;
     return out;
 }
 
+@vertex
+fn vs_main(in: VertexInput) -> VertexOutput {
+    return transform_vertex(in, u_object.model);
+}
+
+@vertex
+fn vs_instanced(in: VertexInput, @builtin(instance_index) instance_index: u32) -> VertexOutput {
+    let index = visible_instances[u_draw.visible_offset + instance_index];
+    return transform_vertex(in, instances[index].model);
+}
+
+// Position-only entry points for the depth prepass.
+struct DepthOutput {
+    @builtin(position) @invariant position: vec4f
+}
+
+@vertex
+fn vs_depth(@location(0) position: vec3f) -> DepthOutput {
+    return DepthOutput(u_frame.proj * u_frame.view * u_object.model * vec4f(position, 1.0));
+}
+
+@vertex
+fn vs_depth_instanced(@location(0) position: vec3f, @builtin(instance_index) instance_index: u32) -> DepthOutput {
+    let index = visible_instances[u_draw.visible_offset + instance_index];
+    return DepthOutput(u_frame.proj * u_frame.view * instances[index].model * vec4f(position, 1.0));
+}
+
 
 fn fresnelSchlick(cos_theta: f32, F0: vec3f) -> vec3f
 {
@@ -111,36 +218,118 @@ fn GeometrySmith(N: vec3f, V: vec3f, L: vec3f, roughness: f32) -> f32
     return ggx1 * ggx2;
 }
 
-struct Light {
-    position: vec3f,
-    color: vec3f
+fn cluster_index(frag_coord: vec2f, world_pos: vec3f) -> u32 {
+    let grid = u_clusters.grid_size;
+    let view_depth = max(-(u_frame.view * vec4f(world_pos, 1.0)).z, u_clusters.near);
+    let tile = vec2u(frag_coord / u_clusters.screen_size * vec2f(grid.xy));
+    let slice = u32(max(log(view_depth) * u_clusters.slice_scale + u_clusters.slice_bias, 0.0));
+    let cell = min(vec3u(tile, slice), grid - 1u);
+    return cell.x + cell.y * grid.x + cell.z * grid.x * grid.y;
 }
 
-@fragment
-fn fs_main(in: VertexOutput) -> @location(0) vec4f {
-    var lights = array<Light, 4>();
+// Smoothly reaches zero at the light's radius so clusters can ignore it beyond.
+fn range_window(distance: f32, radius: f32) -> f32 {
+    let ratio = distance / radius;
+    let window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return window * window;
+}
+
+fn evaluate_light(N: vec3f, V: vec3f, L: vec3f, radiance: vec3f, albedo: vec3f, metalic: f32, roughness: f32,
+                  F0: vec3f) -> vec3f
+{
+    let H = normalize(V + L);
+
+    let NDF = DistributionGGX(N, H, roughness);
+    let G = GeometrySmith(N, V, L, roughness);
+    let F = fresnelSchlick(max(dot(H, V), 0.0), F0);
+
+    let kS = F;
+    var kD = vec3f(1.0) - kS;
+    kD *= 1.0 - metalic;
+
+    let numerator = NDF * G * F;
+    let denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001;
+    let specular = numerator / denominator;
+
+    let NdotL = max(dot(N, L), 0.0);
+    return (kD * albedo / PI + specular) * radiance * NdotL;
+}
+
+// 3x3 PCF in the first cascade whose split lies beyond the fragment; 1 past
+// the last one. Uses the Level variant so it can run in non-uniform control flow.
+fn cascade_shadow(world_pos: vec3f, normal: vec3f) -> f32 {
+    let view_depth = -(u_frame.view * vec4f(world_pos, 1.0)).z;
+    var cascade = 0u;
+    while (cascade < SHADOW_CASCADES && view_depth > u_shadow.split_depths[cascade]) {
+        cascade++;
+    }
+    if (cascade >= SHADOW_CASCADES) {
+        return 1.0;
+    }
 
-    let cos0 = cos(in.delta_time);
-    let sin0 = sin(in.delta_time);
-    let cos1 = cos(in.delta_time + PI / 2.0);
-    let sin1 = sin(in.delta_time + PI / 2.0);
-    let cos2 = cos(in.delta_time + PI);
-    let sin2 = sin(in.delta_time + PI);
-    let cos3 = cos(in.delta_time + PI * 3.0 / 2.0);
-    let sin3 = sin(in.delta_time + PI * 3.0 / 2.0);
+    let offset_pos = world_pos + normalize(normal) * u_shadow.normal_bias * f32(cascade + 1u);
+    let light_pos = u_shadow.view_proj[cascade] * vec4f(offset_pos, 1.0);
+    let uv = light_pos.xy * vec2f(0.5, -0.5) + 0.5;
+    let depth = light_pos.z - u_shadow.depth_bias;
+
+    var lit = 0.0;
+    for (var y = -1; y <= 1; y++) {
+        for (var x = -1; x <= 1; x++) {
+            let sample_uv = uv + vec2f(f32(x), f32(y)) * u_shadow.texel_size;
+            lit += textureSampleCompareLevel(shadow_map, shadow_sampler, sample_uv, cascade, depth);
+        }
+    }
+    return lit / 9.0;
+}
 
-    lights[0].position = vec3f(cos0, 1, sin0);
-    lights[0].color = vec3f(1.0, 0.0, 0.0);
+const ATLAS_DEPTH_BIAS = 0.0001;
 
-    lights[1].position = vec3f(cos1, 1, sin1);
-    lights[1].color = vec3f(0.0, 1.0, 0.0);
+// Point lights pick the cube face along the major axis; samples are clamped
+// half a texel inside the tile so filtering never reads a neighbour.
+fn atlas_shadow(light: Light, world_pos: vec3f, normal: vec3f) -> f32 {
+    if (light.shadow_tile < 0) {
+        return 1.0;
+    }
 
-    lights[2].position = vec3f(cos2, 0, sin2);
-    lights[2].color = vec3f(0.0, 0.0, 1.0);
+    var tile_index = u32(light.shadow_tile);
+    if (light.shadow_faces > 1u) {
+        let to_frag = world_pos - light.position;
+        let axis = abs(to_frag);
+        if (axis.x >= axis.y && axis.x >= axis.z) {
+            tile_index += select(1u, 0u, to_frag.x > 0.0);
+        } else if (axis.y >= axis.z) {
+            tile_index += select(3u, 2u, to_frag.y > 0.0);
+        } else {
+            tile_index += select(5u, 4u, to_frag.z > 0.0);
+        }
+    }
 
-    lights[3].position = vec3f(cos3, -1, sin3);
-    lights[3].color = vec3f(1.0, 1.0, 0.0);
+    let tile = shadow_tiles[tile_index];
+    let offset_pos = world_pos + normalize(normal) * u_shadow.normal_bias;
+    let clip = tile.view_proj * vec4f(offset_pos, 1.0);
+    if (clip.w <= 0.0) {
+        return 1.0;
+    }
+    let ndc = clip.xyz / clip.w;
+    let uv = ndc.xy * vec2f(0.5, -0.5) + 0.5;
 
+    let inset = 0.5 / vec2f(textureDimensions(shadow_atlas));
+    let atlas_uv = clamp(tile.rect.xy + saturate(uv) * tile.rect.zw, tile.rect.xy + inset,
+                         tile.rect.xy + tile.rect.zw - inset);
+    return textureSampleCompareLevel(shadow_atlas, shadow_sampler, atlas_uv, ndc.z - ATLAS_DEPTH_BIAS);
+}
+
+// 1 inside the inner fifth of the cone, fading to 0 at its edge.
+fn spot_falloff(light: Light, L: vec3f) -> f32 {
+    if (light.spot_cos <= -1.0) {
+        return 1.0;
+    }
+    let inner = mix(light.spot_cos, 1.0, 0.2);
+    return smoothstep(light.spot_cos, inner, dot(-L, normalize(light.direction)));
+}
+
+@fragment
+fn fs_main(in: VertexOutput) -> @location(0) vec4f {
     let frag_pos = in.frag_pos;
 
     // let metalic = textureSample(base_color_texture, texture_sampler, in.uv).r * in.metalness;
@@ -171,35 +360,30 @@ fn fs_main(in: VertexOutput) -> @location(0) vec4f {
     var F0 = vec3f(0.04);
     F0 = mix(F0, albedo, metalic);
 
+    let cluster = cluster_index(in.position.xy, frag_pos);
+    let light_count = min(clusters[cluster].count, MAX_CLUSTER_LIGHTS);
+
     var Lo = vec3f(0.0);
-    for(var i = 0; i < 4; i++)
+    for(var i = 0u; i < light_count; i++)
     {
-        let light_pos = lights[i].position;
-        let light_color = lights[i].color;
+        let light = lights[clusters[cluster].lights[i]];
+        let light_pos = light.position;
+        let light_color = light.color * light.intensity;
 
         let L = normalize(light_pos - frag_pos);
-        let H = normalize(V + L);
 
         let distance     = length(light_pos - frag_pos);
-        let attenuation  = 1.0 / (distance * distance);
-        let radiance     = light_color * attenuation;
+        let attenuation  = range_window(distance, light.radius) / (distance * distance);
+        let visibility   = spot_falloff(light, L) * atlas_shadow(light, frag_pos, in.normal);
+        let radiance     = light_color * attenuation * visibility;
 
-        let NDF = DistributionGGX(N, H, roughness);
-        let G = GeometrySmith(N, V, L, roughness);
-        let F = fresnelSchlick(max(dot(H, V), 0.0), F0);
-
-        let kS = F;
-        var kD = vec3f(1.0) - kS;
-        kD *= 1.0 - metalic;
-
-        let numerator = NDF * G * F;
-        let denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.0001;
-        let specular = numerator / denominator;
-
-        let NdotL = max(dot(N, L), 0.0);
-        Lo += (kD * albedo / PI + specular) * radiance * NdotL;
+        Lo += evaluate_light(N, V, L, radiance, albedo, metalic, roughness, F0);
     }
 
+    let sun_L = -u_shadow.light_dir;
+    let sun_shadow = cascade_shadow(frag_pos, in.normal);
+    Lo += evaluate_light(N, V, sun_L, u_shadow.light_color * sun_shadow, albedo, metalic, roughness, F0);
+
     var color = Lo; 
 
     color = color / (color + vec3f(1.0));
@@ -0,0 +1,22 @@
+struct CascadeUniforms {
+    view_proj: mat4x4f
+}
+
+struct ObjectUniforms {
+    model: mat4x4f
+}
+
+@group(0) @binding(0) var<uniform> u_cascade: CascadeUniforms;
+@group(1) @binding(0) var<uniform> u_object: ObjectUniforms;
+
+@vertex
+fn vs_main(@location(0) position: vec3f) -> @builtin(position) vec4f {
+    return u_cascade.view_proj * u_object.model * vec4f(position, 1.0);
+}
+
+// Covers the viewport at the far plane; clears one shadow atlas tile.
+@vertex
+fn vs_clear(@builtin(vertex_index) index: u32) -> @builtin(position) vec4f {
+    let uv = vec2f(f32((index << 1u) & 2u), f32(index & 2u));
+    return vec4f(uv * 2.0 - 1.0, 1.0, 1.0);
+}
@@ -0,0 +1,64 @@
+struct UpscaleUniforms {
+    source_size: vec2f,
+    // 0 = mild, 1 = strongest sharpening.
+    sharpness: f32
+}
+
+struct VertexOutput {
+    @builtin(position) position: vec4f,
+    @location(0) uv: vec2f
+}
+
+@group(0) @binding(0) var source_texture: texture_2d<f32>;
+@group(0) @binding(1) var source_sampler: sampler;
+@group(0) @binding(2) var<uniform> u_upscale: UpscaleUniforms;
+
+@vertex
+fn vs_main(@builtin(vertex_index) index: u32) -> VertexOutput {
+    let uv = vec2f(f32((index << 1u) & 2u), f32(index & 2u));
+    var out: VertexOutput;
+    out.position = vec4f(uv * vec2f(2.0, -2.0) + vec2f(-1.0, 1.0), 0.0, 1.0);
+    out.uv = uv;
+    return out;
+}
+
+fn luma(color: vec3f) -> f32 {
+    return dot(color, vec3f(0.299, 0.587, 0.114));
+}
+
+fn source(uv: vec2f) -> vec3f {
+    return textureSampleLevel(source_texture, source_sampler, uv, 0.0).rgb;
+}
+
+// Edge-adaptive upscale followed by contrast-adaptive sharpening, both on the
+// source's four neighbours of the output pixel.
+@fragment
+fn fs_main(in: VertexOutput) -> @location(0) vec4f {
+    let texel = 1.0 / u_upscale.source_size;
+    let center = source(in.uv);
+    let north = source(in.uv - vec2f(0.0, texel.y));
+    let south = source(in.uv + vec2f(0.0, texel.y));
+    let west = source(in.uv - vec2f(texel.x, 0.0));
+    let east = source(in.uv + vec2f(texel.x, 0.0));
+
+    // Bilinear blurs across edges; blend towards taps along the edge instead,
+    // by how pronounced the edge is.
+    let gradient = vec2f(luma(east) - luma(west), luma(south) - luma(north));
+    let strength = length(gradient);
+    var color = center;
+    if (strength > 1e-4) {
+        let along = vec2f(-gradient.y, gradient.x) / strength * texel * 0.5;
+        let directional = (source(in.uv + along) + source(in.uv - along)) * 0.5;
+        color = mix(center, directional, saturate(strength * 4.0));
+    }
+
+    // Sharpen less where the neighbourhood already has contrast, so edges do
+    // not ring.
+    let lowest = min(center, min(min(north, south), min(west, east)));
+    let highest = max(center, max(max(north, south), max(west, east)));
+    let amount = sqrt(saturate(min(lowest, 1.0 - highest) / max(highest, vec3f(1e-4))));
+    let weight = -amount * mix(0.125, 0.2, u_upscale.sharpness);
+    let sharpened = (color + (north + south + west + east) * weight) / (1.0 + 4.0 * weight);
+
+    return vec4f(saturate(sharpened), 1.0);
+}
@@ -0,0 +1,42 @@
+//
+// Created by Raul Romero on 2026-10-18.
+//
+
+#ifndef PHOTON_CMATERIAL_H
+#define PHOTON_CMATERIAL_H
+
+#include "CComponent.h"
+#include <webgpu/webgpu_cpp.h>
+#include <string>
+
+namespace photon
+{
+
+struct CMaterial : public CComponent
+{
+    // Scene material name, which its textures are loaded by.
+    std::string Name;
+    f32 Metallic = 0.f;
+    f32 Roughness = 0.f;
+    bool bDirty = true;
+
+    wgpu::Texture albedoTexture;
+    wgpu::TextureView albedoTextureView;
+    wgpu::Texture normalTexture;
+    wgpu::TextureView normalTextureView;
+    wgpu::Texture roughnessTexture;
+    wgpu::TextureView roughnessTextureView;
+    wgpu::Texture metallicTexture;
+    wgpu::TextureView metallicTextureView;
+
+    wgpu::Buffer uniformBuffer;
+    wgpu::BindGroup bindGroup;
+    // PipelineHandles of the pipelines this material is drawn with, without
+    // and with a depth prepass.
+    u64 pipeline = 0;
+    u64 depthEqualPipeline = 0;
+};
+
+} // photon
+
+#endif //PHOTON_CMATERIAL_H
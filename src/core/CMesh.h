@@ -12,6 +12,13 @@
 namespace photon
 {
 
+// A contiguous range of the index buffer drawn for one level of detail.
+struct MeshLod
+{
+    u32 firstIndex;
+    u32 indexCount;
+};
+
 struct CMesh : public CComponent
 {
     const char* Path;
@@ -32,6 +39,15 @@ struct CMesh : public CComponent
     wgpu::Buffer indexBuffer;
     std::vector<u16> indexData{};
 
+    // Ordered from most to least detailed; LoadMesh fills in LOD 0 only.
+    std::vector<MeshLod> lods{};
+
+    // Object-space bounds, computed at load.
+    v3f boundsMin{};
+    v3f boundsMax{};
+    v3f boundsCenter{};
+    f32 boundsRadius = 0.f;
+
 };
 
 } // photon
@@ -0,0 +1,266 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "CascadedShadows.h"
+#include "CpuProfiler.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace photon
+{
+
+// Casters up to this far beyond a cascade's sphere, towards the light, still
+// land in its depth range.
+static constexpr f32 kCasterMargin = 20.f;
+// Cached cascades move in steps of this fraction of their radius.
+static constexpr f32 kCachedSnapFraction = 0.25f;
+
+void CascadedShadows::Init(const wgpu::Device& device)
+{
+    PHOTON_PROFILE_FUNCTION();
+    m_Device = device;
+
+    wgpu::TextureDescriptor textureDescriptor{
+        .label = "Cascaded Shadow Map",
+        .usage = wgpu::TextureUsage::RenderAttachment | wgpu::TextureUsage::TextureBinding,
+        .dimension = wgpu::TextureDimension::e2D,
+        .size = {kResolution, kResolution, kCascadeCount},
+        .format = wgpu::TextureFormat::Depth32Float,
+        .mipLevelCount = 1,
+        .sampleCount = 1,
+    };
+    m_ShadowMap = m_Device.CreateTexture(&textureDescriptor);
+
+    wgpu::TextureViewDescriptor arrayViewDescriptor{
+        .format = wgpu::TextureFormat::Depth32Float,
+        .dimension = wgpu::TextureViewDimension::e2DArray,
+        .baseMipLevel = 0,
+        .mipLevelCount = 1,
+        .baseArrayLayer = 0,
+        .arrayLayerCount = kCascadeCount,
+        .aspect = wgpu::TextureAspect::DepthOnly,
+    };
+    m_ShadowMapView = m_ShadowMap.CreateView(&arrayViewDescriptor);
+
+    for (u32 cascade = 0; cascade < kCascadeCount; ++cascade)
+    {
+        wgpu::TextureViewDescriptor layerViewDescriptor = arrayViewDescriptor;
+        layerViewDescriptor.dimension = wgpu::TextureViewDimension::e2D;
+        layerViewDescriptor.baseArrayLayer = cascade;
+        layerViewDescriptor.arrayLayerCount = 1;
+        m_CascadeViews[cascade] = m_ShadowMap.CreateView(&layerViewDescriptor);
+    }
+
+    wgpu::SamplerDescriptor samplerDescriptor{
+        .addressModeU = wgpu::AddressMode::ClampToEdge,
+        .addressModeV = wgpu::AddressMode::ClampToEdge,
+        .addressModeW = wgpu::AddressMode::ClampToEdge,
+        .magFilter = wgpu::FilterMode::Linear,
+        .minFilter = wgpu::FilterMode::Linear,
+        .mipmapFilter = wgpu::MipmapFilterMode::Nearest,
+        .compare = wgpu::CompareFunction::Less,
+        .maxAnisotropy = 1,
+    };
+    m_Sampler = m_Device.CreateSampler(&samplerDescriptor);
+
+    m_DepthStencilState = wgpu::DepthStencilState{
+        .format = wgpu::TextureFormat::Depth32Float,
+        .depthWriteEnabled = true,
+        .depthCompare = wgpu::CompareFunction::Less,
+        .stencilReadMask = 0,
+        .stencilWriteMask = 0,
+        .depthBiasSlopeScale = 1.5f,
+    };
+
+    wgpu::BufferDescriptor bufferDescriptor{.label = "Shadow Uniforms",
+                                            .usage = wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst,
+                                            .size = sizeof(GpuShadowUniforms),
+                                            .mappedAtCreation = false};
+    m_UniformBuffer = m_Device.CreateBuffer(&bufferDescriptor);
+
+    bufferDescriptor.label = "Shadow Cascades";
+    bufferDescriptor.size = kCascadeCount * kCascadeUniformStride;
+    m_CascadeBuffer = m_Device.CreateBuffer(&bufferDescriptor);
+
+    wgpu::BindGroupLayoutEntry layoutEntry{};
+    layoutEntry.binding = 0;
+    layoutEntry.visibility = wgpu::ShaderStage::Vertex;
+    layoutEntry.buffer.type = wgpu::BufferBindingType::Uniform;
+    layoutEntry.buffer.hasDynamicOffset = true;
+    layoutEntry.buffer.minBindingSize = sizeof(m4);
+
+    wgpu::BindGroupLayoutDescriptor layoutDescriptor{.entryCount = 1, .entries = &layoutEntry};
+    m_CascadeBindGroupLayout = m_Device.CreateBindGroupLayout(&layoutDescriptor);
+
+    wgpu::BindGroupEntry entry{.binding = 0, .buffer = m_CascadeBuffer, .offset = 0, .size = sizeof(m4)};
+    wgpu::BindGroupDescriptor bindGroupDescriptor{
+        .layout = m_CascadeBindGroupLayout, .entryCount = 1, .entries = &entry};
+    m_CascadeBindGroup = m_Device.CreateBindGroup(&bindGroupDescriptor);
+}
+
+void CascadedShadows::Update(const CCamera& camera, const m4& view, const v3f& lightDirection, const v3f& lightColor)
+{
+    const v3f direction = glm::normalize(lightDirection);
+    if (direction != m_LightDirection)
+    {
+        m_LightDirection = direction;
+        InvalidateCache();
+    }
+
+    const m4 inverseView = glm::inverse(view);
+    const f32 tanHalfFovY = std::tan(glm::radians(camera.Fov) * 0.5f);
+    const f32 tanHalfFovX = tanHalfFovY * camera.Aspect;
+    const f32 nearDepth = camera.Near;
+    const f32 farDepth = std::min(camera.Far, MaxDistance);
+
+    const v3f up = std::abs(direction.y) > 0.99f ? v3f(0.f, 0.f, 1.f) : v3f(0.f, 1.f, 0.f);
+    const m4 lightRotation = glm::lookAt(v3f(0.f), direction, up);
+    const m4 inverseLightRotation = glm::inverse(lightRotation);
+
+    GpuShadowUniforms uniforms{};
+    uniforms.LightDirection = direction;
+    uniforms.LightColor = lightColor;
+    uniforms.DepthBias = 0.001f;
+    uniforms.NormalBias = 0.02f;
+    uniforms.TexelSize = 1.f / kResolution;
+
+    wgpu::Queue queue = m_Device.GetQueue();
+    f32 splitNear = nearDepth;
+    for (u32 cascade = 0; cascade < kCascadeCount; ++cascade)
+    {
+        const f32 t = static_cast<f32>(cascade + 1) / kCascadeCount;
+        const f32 logSplit = nearDepth * std::pow(farDepth / nearDepth, t);
+        const f32 uniformSplit = nearDepth + (farDepth - nearDepth) * t;
+        const f32 splitFar = glm::mix(uniformSplit, logSplit, SplitLambda);
+        uniforms.SplitDepths[cascade] = splitFar;
+
+        // Bounding sphere of the camera frustum between the two splits.
+        std::array<v3f, 8> corners;
+        v3f center(0.f);
+        for (u32 i = 0; i < corners.size(); ++i)
+        {
+            const f32 depth = (i & 4) ? splitFar : splitNear;
+            const f32 x = ((i & 1) ? 1.f : -1.f) * tanHalfFovX * depth;
+            const f32 y = ((i & 2) ? 1.f : -1.f) * tanHalfFovY * depth;
+            corners[i] = v3f(inverseView * v4f(x, y, -depth, 1.f));
+            center += corners[i] / static_cast<f32>(corners.size());
+        }
+
+        f32 radius = 0.f;
+        for (const v3f& corner : corners)
+        {
+            radius = std::max(radius, glm::length(corner - center));
+        }
+        // Rounded up so float noise cannot change the cascade's size.
+        radius = std::ceil(radius * 16.f) / 16.f;
+
+        // Near cascades snap to whole texels. Cached cascades snap in all three
+        // axes to coarse steps, padding the radius so the slice stays covered.
+        const bool bCached = IsCached(cascade);
+        const f32 step = bCached ? radius * kCachedSnapFraction : 2.f * radius / kResolution;
+        if (bCached)
+        {
+            radius += step * 1.5f;
+        }
+
+        v3f lightCenter = v3f(lightRotation * v4f(center, 1.f));
+        lightCenter.x = std::floor(lightCenter.x / step) * step;
+        lightCenter.y = std::floor(lightCenter.y / step) * step;
+        if (bCached)
+        {
+            lightCenter.z = std::floor(lightCenter.z / step) * step;
+        }
+        center = v3f(inverseLightRotation * v4f(lightCenter, 1.f));
+
+        const f32 eyeDistance = radius + kCasterMargin;
+        const m4 lightView = glm::lookAt(center - direction * eyeDistance, center, up);
+        const m4 lightProjection = glm::orthoRH_ZO(-radius, radius, -radius, radius, 0.f, eyeDistance + radius);
+        const m4 viewProjection = lightProjection * lightView;
+
+        if (!bCached || viewProjection != m_ViewProjections[cascade])
+        {
+            m_bNeedsRender[cascade] = true;
+        }
+        m_ViewProjections[cascade] = viewProjection;
+        uniforms.ViewProjection[cascade] = viewProjection;
+
+        if (m_bNeedsRender[cascade])
+        {
+            queue.WriteBuffer(m_CascadeBuffer, cascade * kCascadeUniformStride, &viewProjection, sizeof(m4));
+            RenderStats::Instance().CountBufferUpload(sizeof(m4));
+        }
+
+        splitNear = splitFar;
+    }
+
+    queue.WriteBuffer(m_UniformBuffer, 0, &uniforms, sizeof(GpuShadowUniforms));
+    RenderStats::Instance().CountBufferUpload(sizeof(GpuShadowUniforms));
+}
+
+void CascadedShadows::InvalidateCache()
+{
+    for (u32 cascade = kFirstCachedCascade; cascade < kCascadeCount; ++cascade)
+    {
+        m_bNeedsRender[cascade] = true;
+    }
+}
+
+bool CascadedShadows::NeedsRender(u32 cascade) const
+{
+    return m_bNeedsRender[cascade];
+}
+
+bool CascadedShadows::IsCached(u32 cascade) const
+{
+    return cascade >= kFirstCachedCascade;
+}
+
+void CascadedShadows::MarkRendered(u32 cascade)
+{
+    m_bNeedsRender[cascade] = false;
+}
+
+const m4& CascadedShadows::GetViewProjection(u32 cascade) const
+{
+    return m_ViewProjections[cascade];
+}
+
+const wgpu::TextureView& CascadedShadows::GetCascadeView(u32 cascade) const
+{
+    return m_CascadeViews[cascade];
+}
+
+const wgpu::TextureView& CascadedShadows::GetShadowMapView() const
+{
+    return m_ShadowMapView;
+}
+
+const wgpu::Sampler& CascadedShadows::GetSampler() const
+{
+    return m_Sampler;
+}
+
+const wgpu::Buffer& CascadedShadows::GetUniformBuffer() const
+{
+    return m_UniformBuffer;
+}
+
+const wgpu::BindGroupLayout& CascadedShadows::GetCascadeBindGroupLayout() const
+{
+    return m_CascadeBindGroupLayout;
+}
+
+const wgpu::BindGroup& CascadedShadows::GetCascadeBindGroup() const
+{
+    return m_CascadeBindGroup;
+}
+
+const wgpu::DepthStencilState& CascadedShadows::GetDepthStencilState() const
+{
+    return m_DepthStencilState;
+}
+
+} // photon
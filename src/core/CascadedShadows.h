@@ -0,0 +1,96 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_CASCADEDSHADOWS_H
+#define PHOTON_CASCADEDSHADOWS_H
+
+#include "CCamera.h"
+#include <webgpu/webgpu_cpp.h>
+#include <array>
+
+namespace photon
+{
+
+// Mirrors `ShadowUniforms` in pbr_mat.wgsl.
+struct GpuShadowUniforms
+{
+    m4 ViewProjection[4];
+    // View-space distance at which each cascade ends.
+    v4f SplitDepths;
+    // Direction the light travels in.
+    v3f LightDirection;
+    f32 DepthBias;
+    v3f LightColor;
+    f32 NormalBias;
+    f32 TexelSize;
+    f32 pad[3];
+};
+
+// Directional light shadows split into cascades along the view. Every cascade
+// is a bounding sphere of its slice of the camera frustum, so its size does
+// not change as the camera turns, and its origin is snapped to whole texels to
+// keep edges from shimmering.
+//
+// Distant cascades only hold static casters and are cached: their origin
+// moves in coarse steps, and they are re-rendered only when that step, the
+// light or the static set changes. Near cascades are re-rendered every frame
+// with every caster.
+class CascadedShadows
+{
+public:
+    static constexpr u32 kCascadeCount = 4;
+    static constexpr u32 kFirstCachedCascade = 2;
+    static constexpr u32 kResolution = 2048;
+    static constexpr u32 kCascadeUniformStride = 256;
+
+    void Init(const wgpu::Device& device);
+
+    // Fits the cascades to the camera and uploads the shading uniforms.
+    void Update(const CCamera& camera, const m4& view, const v3f& lightDirection, const v3f& lightColor);
+
+    // Forces cached cascades to re-render, e.g. when static casters change.
+    void InvalidateCache();
+
+    [[nodiscard]] bool NeedsRender(u32 cascade) const;
+    [[nodiscard]] bool IsCached(u32 cascade) const;
+    void MarkRendered(u32 cascade);
+
+    [[nodiscard]] const m4& GetViewProjection(u32 cascade) const;
+    [[nodiscard]] const wgpu::TextureView& GetCascadeView(u32 cascade) const;
+    [[nodiscard]] const wgpu::TextureView& GetShadowMapView() const;
+    [[nodiscard]] const wgpu::Sampler& GetSampler() const;
+    [[nodiscard]] const wgpu::Buffer& GetUniformBuffer() const;
+
+    // Group 0 of the caster pipeline: the cascade's matrix by dynamic offset.
+    [[nodiscard]] const wgpu::BindGroupLayout& GetCascadeBindGroupLayout() const;
+    [[nodiscard]] const wgpu::BindGroup& GetCascadeBindGroup() const;
+    [[nodiscard]] const wgpu::DepthStencilState& GetDepthStencilState() const;
+
+    // Shadows end at min(camera far plane, MaxDistance).
+    f32 MaxDistance = 50.f;
+    // Blend between uniform (0) and logarithmic (1) split distances.
+    f32 SplitLambda = 0.75f;
+
+private:
+    wgpu::Device m_Device;
+
+    wgpu::Texture m_ShadowMap;
+    wgpu::TextureView m_ShadowMapView;
+    std::array<wgpu::TextureView, kCascadeCount> m_CascadeViews;
+    wgpu::Sampler m_Sampler;
+    wgpu::DepthStencilState m_DepthStencilState;
+
+    wgpu::Buffer m_UniformBuffer;
+    wgpu::Buffer m_CascadeBuffer;
+    wgpu::BindGroupLayout m_CascadeBindGroupLayout;
+    wgpu::BindGroup m_CascadeBindGroup;
+
+    std::array<m4, kCascadeCount> m_ViewProjections{};
+    std::array<bool, kCascadeCount> m_bNeedsRender{};
+    v3f m_LightDirection{};
+};
+
+} // photon
+
+#endif //PHOTON_CASCADEDSHADOWS_H
@@ -0,0 +1,147 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "ClusteredLighting.h"
+#include "CpuProfiler.h"
+#include "Reader.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace photon
+{
+
+void ClusteredLighting::Init(const wgpu::Device& device, u32 width, u32 height)
+{
+    PHOTON_PROFILE_FUNCTION();
+    m_Device = device;
+    m_Width = width;
+    m_Height = height;
+
+    wgpu::BufferDescriptor bufferDescriptor{.label = "Lights",
+                                            .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst,
+                                            .size = kMaxLights * sizeof(GpuLight),
+                                            .mappedAtCreation = false};
+    m_LightBuffer = m_Device.CreateBuffer(&bufferDescriptor);
+
+    // One u32 count followed by kMaxLightsPerCluster indices per cluster.
+    bufferDescriptor.label = "Light Clusters";
+    bufferDescriptor.usage = wgpu::BufferUsage::Storage;
+    bufferDescriptor.size = kClusterCount * (kMaxLightsPerCluster + 1) * sizeof(u32);
+    m_ClusterBuffer = m_Device.CreateBuffer(&bufferDescriptor);
+
+    bufferDescriptor.label = "Cluster Uniforms";
+    bufferDescriptor.usage = wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst;
+    bufferDescriptor.size = sizeof(GpuClusterUniforms);
+    m_UniformBuffer = m_Device.CreateBuffer(&bufferDescriptor);
+
+    std::array<wgpu::BindGroupLayoutEntry, 3> layoutEntries{};
+    layoutEntries[0].binding = 0;
+    layoutEntries[0].visibility = wgpu::ShaderStage::Compute;
+    layoutEntries[0].buffer.type = wgpu::BufferBindingType::Uniform;
+    layoutEntries[0].buffer.minBindingSize = sizeof(GpuClusterUniforms);
+
+    layoutEntries[1].binding = 1;
+    layoutEntries[1].visibility = wgpu::ShaderStage::Compute;
+    layoutEntries[1].buffer.type = wgpu::BufferBindingType::ReadOnlyStorage;
+
+    layoutEntries[2].binding = 2;
+    layoutEntries[2].visibility = wgpu::ShaderStage::Compute;
+    layoutEntries[2].buffer.type = wgpu::BufferBindingType::Storage;
+
+    wgpu::BindGroupLayoutDescriptor layoutDescriptor{.entryCount = layoutEntries.size(),
+                                                     .entries = layoutEntries.data()};
+    wgpu::BindGroupLayout bindGroupLayout = m_Device.CreateBindGroupLayout(&layoutDescriptor);
+
+    std::array<wgpu::BindGroupEntry, 3> entries{};
+    entries[0] = {.binding = 0, .buffer = m_UniformBuffer, .size = sizeof(GpuClusterUniforms)};
+    entries[1] = {.binding = 1, .buffer = m_LightBuffer, .size = m_LightBuffer.GetSize()};
+    entries[2] = {.binding = 2, .buffer = m_ClusterBuffer, .size = m_ClusterBuffer.GetSize()};
+
+    wgpu::BindGroupDescriptor bindGroupDescriptor{.layout = bindGroupLayout,
+                                                  .entryCount = entries.size(),
+                                                  .entries = entries.data()};
+    m_AssignBindGroup = m_Device.CreateBindGroup(&bindGroupDescriptor);
+
+    wgpu::ShaderModuleWGSLDescriptor wgslDesc{};
+    wgslDesc.code = Reader::ReadTextFile("shaders/cluster_lights.wgsl");
+
+    wgpu::ShaderModuleDescriptor shaderModuleDescriptor{.nextInChain = &wgslDesc};
+    shaderModuleDescriptor.label = "Light Clustering Shader Module";
+    wgpu::ShaderModule shaderModule = m_Device.CreateShaderModule(&shaderModuleDescriptor);
+
+    wgpu::PipelineLayoutDescriptor pipelineLayoutDescriptor{.bindGroupLayoutCount = 1,
+                                                            .bindGroupLayouts = &bindGroupLayout};
+
+    wgpu::ComputePipelineDescriptor pipelineDescriptor{
+        .label = "Light Clustering",
+        .layout = m_Device.CreatePipelineLayout(&pipelineLayoutDescriptor),
+        .compute = {.module = shaderModule, .entryPoint = "cs_main"},
+    };
+    m_AssignPipeline = m_Device.CreateComputePipeline(&pipelineDescriptor);
+}
+
+void ClusteredLighting::Resize(u32 width, u32 height)
+{
+    m_Width = width;
+    m_Height = height;
+}
+
+void ClusteredLighting::Update(const std::vector<GpuLight>& lights, const m4& view, const m4& projection, f32 near,
+                               f32 far)
+{
+    const u32 lightCount = static_cast<u32>(std::min<size_t>(lights.size(), kMaxLights));
+    const f32 logDepthRange = std::log(far / near);
+
+    GpuClusterUniforms uniforms{};
+    uniforms.View = view;
+    uniforms.InverseProjection = glm::inverse(projection);
+    uniforms.ScreenSize = v2f(static_cast<f32>(m_Width), static_cast<f32>(m_Height));
+    uniforms.Near = near;
+    uniforms.Far = far;
+    uniforms.GridSize[0] = kGridX;
+    uniforms.GridSize[1] = kGridY;
+    uniforms.GridSize[2] = kGridZ;
+    uniforms.LightCount = lightCount;
+    uniforms.SliceScale = kGridZ / logDepthRange;
+    uniforms.SliceBias = -(kGridZ * std::log(near)) / logDepthRange;
+
+    wgpu::Queue queue = m_Device.GetQueue();
+    queue.WriteBuffer(m_UniformBuffer, 0, &uniforms, sizeof(GpuClusterUniforms));
+    RenderStats::Instance().CountBufferUpload(sizeof(GpuClusterUniforms));
+    if (lightCount > 0)
+    {
+        queue.WriteBuffer(m_LightBuffer, 0, lights.data(), lightCount * sizeof(GpuLight));
+        RenderStats::Instance().CountBufferUpload(lightCount * sizeof(GpuLight));
+    }
+}
+
+void ClusteredLighting::Assign(wgpu::CommandEncoder& encoder,
+                               const wgpu::ComputePassTimestampWrites* timestampWrites) const
+{
+    wgpu::ComputePassDescriptor passDescriptor{.label = "Light Clustering", .timestampWrites = timestampWrites};
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass(&passDescriptor);
+    pass.SetPipeline(m_AssignPipeline);
+    pass.SetBindGroup(0, m_AssignBindGroup);
+    pass.DispatchWorkgroups((kClusterCount + kWorkgroupSize - 1) / kWorkgroupSize);
+    pass.End();
+}
+
+const wgpu::Buffer& ClusteredLighting::GetLightBuffer() const
+{
+    return m_LightBuffer;
+}
+
+const wgpu::Buffer& ClusteredLighting::GetClusterBuffer() const
+{
+    return m_ClusterBuffer;
+}
+
+const wgpu::Buffer& ClusteredLighting::GetUniformBuffer() const
+{
+    return m_UniformBuffer;
+}
+
+} // photon
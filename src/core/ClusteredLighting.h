@@ -0,0 +1,97 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_CLUSTEREDLIGHTING_H
+#define PHOTON_CLUSTEREDLIGHTING_H
+
+#include "PhotonCore.h"
+#include <webgpu/webgpu_cpp.h>
+#include <vector>
+
+namespace photon
+{
+
+// Mirrors `Light` in cluster_lights.wgsl and pbr_mat.wgsl. Contribution is
+// windowed to zero at Radius, which is what clusters are tested against.
+struct GpuLight
+{
+    v3f Position;
+    f32 Radius = 10.f;
+    v3f Color;
+    f32 Intensity = 1.f;
+    // Spot lights shine along Direction within a cone whose half-angle has
+    // this cosine; -1 makes a point light.
+    v3f Direction = v3f(0.f, -1.f, 0.f);
+    f32 SpotCosine = -1.f;
+    // Written by ShadowAtlas: first tile and face count, -1 and 0 when unshadowed.
+    i32 ShadowTile = -1;
+    u32 ShadowFaces = 0;
+    f32 pad[2];
+};
+
+// Mirrors `ClusterUniforms` in cluster_lights.wgsl and pbr_mat.wgsl.
+struct GpuClusterUniforms
+{
+    m4 View;
+    m4 InverseProjection;
+    v2f ScreenSize;
+    f32 Near;
+    f32 Far;
+    u32 GridSize[3];
+    u32 LightCount;
+    // Maps log(view depth) to a depth slice: slice = log(z) * scale + bias.
+    f32 SliceScale;
+    f32 SliceBias;
+    f32 pad[2];
+};
+
+// Clustered forward lighting. The view frustum is split into a grid of
+// screen tiles by exponential depth slices; a compute pass lists the lights
+// touching each cluster, and shading only loops over its own cluster's list.
+class ClusteredLighting
+{
+public:
+    static constexpr u32 kGridX = 16;
+    static constexpr u32 kGridY = 9;
+    static constexpr u32 kGridZ = 24;
+    static constexpr u32 kClusterCount = kGridX * kGridY * kGridZ;
+    static constexpr u32 kMaxLights = 1024;
+    // Lights beyond this in one cluster are dropped.
+    static constexpr u32 kMaxLightsPerCluster = 63;
+    static constexpr u32 kWorkgroupSize = 64;
+
+    void Init(const wgpu::Device& device, u32 width, u32 height);
+
+    // Render target size in pixels; applies from the next Update.
+    void Resize(u32 width, u32 height);
+
+    // Uploads the lights (at most kMaxLights) and the camera for this frame.
+    void Update(const std::vector<GpuLight>& lights, const m4& view, const m4& projection, f32 near, f32 far);
+
+    // Records the light assignment; must precede the passes that shade.
+    void Assign(wgpu::CommandEncoder& encoder,
+                const wgpu::ComputePassTimestampWrites* timestampWrites = nullptr) const;
+
+    // Bound by the frame bind group: lights, clusters and uniforms.
+    [[nodiscard]] const wgpu::Buffer& GetLightBuffer() const;
+    [[nodiscard]] const wgpu::Buffer& GetClusterBuffer() const;
+    [[nodiscard]] const wgpu::Buffer& GetUniformBuffer() const;
+
+private:
+    wgpu::Device m_Device;
+
+    wgpu::ComputePipeline m_AssignPipeline;
+    wgpu::BindGroup m_AssignBindGroup;
+
+    wgpu::Buffer m_LightBuffer;
+    wgpu::Buffer m_ClusterBuffer;
+    wgpu::Buffer m_UniformBuffer;
+
+    u32 m_Width = 0;
+    u32 m_Height = 0;
+};
+
+} // photon
+
+#endif //PHOTON_CLUSTEREDLIGHTING_H
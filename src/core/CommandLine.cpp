@@ -0,0 +1,141 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "CommandLine.h"
+#include "Logger.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+namespace photon
+{
+
+bool ParseRunOptions(int argc, char** argv, RunOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg == "--headless")
+        {
+            options.bHeadless = true;
+            continue;
+        }
+        if (arg == "--sim-thread")
+        {
+            options.bSimulationThread = true;
+            continue;
+        }
+        if (!value)
+        {
+            LogWarning("Ignoring argument %s", argv[i]);
+            continue;
+        }
+
+        ++i;
+        if (arg == "--frames")
+        {
+            options.FrameCount = static_cast<u32>(std::atoi(value));
+        }
+        else if (arg == "--size")
+        {
+            std::sscanf(value, "%ux%u", &options.Width, &options.Height);
+        }
+        else if (arg == "--scene")
+        {
+            if (!SceneDescription::LoadFromFile(value, options.Scene))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--backend")
+        {
+            const std::string_view backend = value;
+            if (backend == "null")
+            {
+                options.Backend = wgpu::BackendType::Null;
+            }
+            else if (backend == "vulkan")
+            {
+                options.Backend = wgpu::BackendType::Vulkan;
+            }
+            else if (backend == "metal")
+            {
+                options.Backend = wgpu::BackendType::Metal;
+            }
+            else if (backend == "d3d12")
+            {
+                options.Backend = wgpu::BackendType::D3D12;
+            }
+            else if (backend == "swiftshader")
+            {
+                options.bForceFallbackAdapter = true;
+            }
+            else
+            {
+                LogWarning("Unknown backend %s", value);
+            }
+        }
+        else if (arg == "--present")
+        {
+            const std::string_view mode = value;
+            if (mode == "fifo")
+            {
+                options.PresentMode = wgpu::PresentMode::Fifo;
+            }
+            else if (mode == "mailbox")
+            {
+                options.PresentMode = wgpu::PresentMode::Mailbox;
+            }
+            else if (mode == "immediate")
+            {
+                options.PresentMode = wgpu::PresentMode::Immediate;
+            }
+            else
+            {
+                LogWarning("Unknown present mode %s", value);
+            }
+        }
+        else if (arg == "--frames-in-flight")
+        {
+            options.MaxFramesInFlight = static_cast<u32>(std::atoi(value));
+        }
+        else if (arg == "--capture")
+        {
+            options.CapturePrefix = value;
+        }
+        else if (arg == "--capture-interval")
+        {
+            options.CaptureInterval = static_cast<u32>(std::atoi(value));
+        }
+        else if (arg == "--record")
+        {
+            options.RecordPath = value;
+        }
+        else if (arg == "--replay")
+        {
+            options.ReplayPath = value;
+        }
+        else if (arg == "--dynamic-resolution")
+        {
+            const std::string_view enabled = value;
+            if (enabled == "on" || enabled == "off")
+            {
+                options.DynamicResolution = enabled == "on";
+            }
+            else
+            {
+                LogWarning("Expected on or off after --dynamic-resolution, got %s", value);
+            }
+        }
+        else
+        {
+            LogWarning("Ignoring argument %s", argv[i - 1]);
+            --i;
+        }
+    }
+    return true;
+}
+
+} // photon
@@ -0,0 +1,25 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_COMMANDLINE_H
+#define PHOTON_COMMANDLINE_H
+
+#include "Renderer.h"
+
+namespace photon
+{
+
+// Parses the arguments every native executable understands:
+//   [--headless] [--frames N] [--size WxH] [--scene FILE]
+//   [--backend null|vulkan|metal|d3d12|swiftshader]
+//   [--present fifo|mailbox|immediate] [--frames-in-flight N]
+//   [--capture PREFIX] [--capture-interval N]
+//   [--record FILE | --replay FILE] [--sim-thread]
+//   [--dynamic-resolution on|off]
+// argv[0] is skipped. Returns false when a scene file fails to load.
+bool ParseRunOptions(int argc, char** argv, RunOptions& options);
+
+} // photon
+
+#endif //PHOTON_COMMANDLINE_H
@@ -0,0 +1,161 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "CpuProfiler.h"
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace photon
+{
+
+namespace
+{
+
+struct ProfileEvent
+{
+    const char* Name;
+    u64 StartNs;
+    u64 EndNs;
+};
+
+struct ThreadEvents
+{
+    u32 ThreadId = 0;
+    std::atomic<const char*> Name{nullptr};
+    // Total events ever written; the writer publishes with release so readers
+    // see complete entries below it.
+    std::atomic<u64> Count{0};
+    std::unique_ptr<ProfileEvent[]> Events = std::make_unique<ProfileEvent[]>(CpuProfiler::kEventCapacity);
+};
+
+struct Registry
+{
+    std::mutex Mutex;
+    // Buffers outlive their threads so late exports still see them.
+    std::vector<std::shared_ptr<ThreadEvents>> Threads;
+};
+
+Registry& GetRegistry()
+{
+    static Registry registry;
+    return registry;
+}
+
+ThreadEvents& GetThreadEvents()
+{
+    thread_local std::shared_ptr<ThreadEvents> events = []
+    {
+        auto buffer = std::make_shared<ThreadEvents>();
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.Mutex);
+        buffer->ThreadId = static_cast<u32>(registry.Threads.size());
+        registry.Threads.push_back(buffer);
+        return buffer;
+    }();
+    return *events;
+}
+
+void WriteJsonString(std::ofstream& file, const char* text)
+{
+    file << '"';
+    for (const char* c = text; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            file << '\\';
+        }
+        file << *c;
+    }
+    file << '"';
+}
+
+} // namespace
+
+u64 CpuProfiler::Now()
+{
+    using Clock = std::chrono::steady_clock;
+    static const Clock::time_point epoch = Clock::now();
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count());
+}
+
+void CpuProfiler::Record(const char* name, u64 startNs, u64 endNs)
+{
+    ThreadEvents& events = GetThreadEvents();
+    const u64 count = events.Count.load(std::memory_order_relaxed);
+    events.Events[count % kEventCapacity] = {name, startNs, endNs};
+    events.Count.store(count + 1, std::memory_order_release);
+}
+
+void CpuProfiler::SetThreadName(const char* name)
+{
+    GetThreadEvents().Name.store(name, std::memory_order_release);
+}
+
+bool CpuProfiler::WriteChromeTrace(const std::string& path)
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file)
+    {
+        LogError("Could not write CPU trace to %s", path.c_str());
+        return false;
+    }
+
+    std::vector<std::shared_ptr<ThreadEvents>> threads;
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.Mutex);
+        threads = registry.Threads;
+    }
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool bFirst = true;
+    auto separator = [&]
+    {
+        if (!bFirst)
+        {
+            file << ",\n";
+        }
+        bFirst = false;
+    };
+
+    file.setf(std::ios::fixed);
+    file.precision(3);
+    for (const std::shared_ptr<ThreadEvents>& thread : threads)
+    {
+        if (const char* name = thread->Name.load(std::memory_order_acquire))
+        {
+            separator();
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->ThreadId
+                 << ",\"args\":{\"name\":";
+            WriteJsonString(file, name);
+            file << "}}";
+        }
+
+        const u64 count = thread->Count.load(std::memory_order_acquire);
+        const u64 first = count > kEventCapacity ? count - kEventCapacity : 0;
+        for (u64 i = first; i < count; ++i)
+        {
+            const ProfileEvent& event = thread->Events[i % kEventCapacity];
+            // Trace timestamps are in microseconds.
+            separator();
+            file << "{\"name\":";
+            WriteJsonString(file, event.Name);
+            file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->ThreadId
+                 << ",\"ts\":" << static_cast<f64>(event.StartNs) * 1e-3
+                 << ",\"dur\":" << static_cast<f64>(event.EndNs - event.StartNs) * 1e-3 << '}';
+        }
+    }
+    file << "]}\n";
+
+    LogInfo("Wrote CPU trace to %s", path.c_str());
+    return static_cast<bool>(file);
+}
+
+} // photon
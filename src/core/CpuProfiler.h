@@ -0,0 +1,76 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_CPUPROFILER_H
+#define PHOTON_CPUPROFILER_H
+
+#include "PhotonCore.h"
+#include <string>
+
+namespace photon
+{
+
+// Scoped CPU timing markers. Each thread appends finished scopes to its own
+// ring buffer without locking; only a thread's first scope takes a lock, to
+// register the buffer. WriteChromeTrace exports every thread's events as
+// trace-event JSON for Perfetto or chrome://tracing. Once a ring is full the
+// oldest events are overwritten, so long sessions keep their most recent
+// history.
+//
+// The PHOTON_PROFILE_* macros compile to nothing unless
+// PHOTON_ENABLE_PROFILING is defined (Debug builds, or the CMake option).
+class CpuProfiler
+{
+public:
+    // Events kept per thread.
+    static constexpr u32 kEventCapacity = 1u << 15;
+
+    // Nanoseconds since the profiler's epoch, the first call in the process.
+    static u64 Now();
+    static void Record(const char* name, u64 startNs, u64 endNs);
+    static void SetThreadName(const char* name);
+
+    // Best called while other threads are idle; events overwritten during the
+    // export may come out torn.
+    static bool WriteChromeTrace(const std::string& path);
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name)
+        : m_Name(name), m_Start(CpuProfiler::Now())
+    {
+    }
+
+    ~ProfileScope()
+    {
+        CpuProfiler::Record(m_Name, m_Start, CpuProfiler::Now());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* m_Name;
+    u64 m_Start;
+};
+
+} // photon
+
+#if defined(PHOTON_ENABLE_PROFILING)
+#define PHOTON_PROFILE_CONCAT_INNER(a, b) a##b
+#define PHOTON_PROFILE_CONCAT(a, b) PHOTON_PROFILE_CONCAT_INNER(a, b)
+// name must outlive the profiler, e.g. a string literal.
+#define PHOTON_PROFILE_SCOPE(name) \
+    ::photon::ProfileScope PHOTON_PROFILE_CONCAT(profileScope, __COUNTER__)(name)
+#define PHOTON_PROFILE_FUNCTION() PHOTON_PROFILE_SCOPE(__func__)
+#define PHOTON_PROFILE_THREAD(name) ::photon::CpuProfiler::SetThreadName(name)
+#else
+#define PHOTON_PROFILE_SCOPE(name) ((void)0)
+#define PHOTON_PROFILE_FUNCTION() ((void)0)
+#define PHOTON_PROFILE_THREAD(name) ((void)0)
+#endif
+
+#endif //PHOTON_CPUPROFILER_H
@@ -0,0 +1,130 @@
+//
+// Created by Raul Romero on 2026-10-18.
+//
+
+#include "DepthPyramid.h"
+#include "CpuProfiler.h"
+#include "Reader.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace photon
+{
+
+void DepthPyramid::Init(const wgpu::Device& device, const wgpu::TextureView& depthView, u32 width, u32 height)
+{
+    PHOTON_PROFILE_FUNCTION();
+    m_Device = device;
+    m_Width = width;
+    m_Height = height;
+    m_MipCount = std::bit_width(std::max(width, height));
+
+    wgpu::TextureDescriptor textureDescriptor{
+        .label = "Depth Pyramid",
+        .usage = wgpu::TextureUsage::StorageBinding | wgpu::TextureUsage::TextureBinding,
+        .dimension = wgpu::TextureDimension::e2D,
+        .size = {width, height, 1},
+        .format = wgpu::TextureFormat::R32Float,
+        .mipLevelCount = m_MipCount,
+        .sampleCount = 1,
+    };
+    m_Texture = m_Device.CreateTexture(&textureDescriptor);
+    m_View = m_Texture.CreateView();
+
+    wgpu::ShaderModuleWGSLDescriptor wgslDesc{};
+    wgslDesc.code = Reader::ReadTextFile("shaders/depth_pyramid.wgsl");
+
+    wgpu::ShaderModuleDescriptor shaderModuleDescriptor{.nextInChain = &wgslDesc};
+    shaderModuleDescriptor.label = "Depth Pyramid Shader Module";
+    wgpu::ShaderModule shaderModule = m_Device.CreateShaderModule(&shaderModuleDescriptor);
+
+    m_CopyPipeline = CreatePipeline(shaderModule, "Depth Pyramid Copy", "cs_copy_depth");
+    m_DownsamplePipeline = CreatePipeline(shaderModule, "Depth Pyramid Downsample", "cs_downsample");
+
+    std::vector<wgpu::TextureView> mipViews(m_MipCount);
+    for (u32 mip = 0; mip < m_MipCount; ++mip)
+    {
+        wgpu::TextureViewDescriptor viewDescriptor{
+            .format = wgpu::TextureFormat::R32Float,
+            .dimension = wgpu::TextureViewDimension::e2D,
+            .baseMipLevel = mip,
+            .mipLevelCount = 1,
+            .baseArrayLayer = 0,
+            .arrayLayerCount = 1,
+        };
+        mipViews[mip] = m_Texture.CreateView(&viewDescriptor);
+    }
+
+    m_BindGroups.resize(m_MipCount);
+
+    std::array<wgpu::BindGroupEntry, 2> copyEntries{};
+    copyEntries[0] = {.binding = 1, .textureView = mipViews[0]};
+    copyEntries[1] = {.binding = 2, .textureView = depthView};
+
+    wgpu::BindGroupDescriptor copyDescriptor{.layout = m_CopyPipeline.GetBindGroupLayout(0),
+                                             .entryCount = copyEntries.size(),
+                                             .entries = copyEntries.data()};
+    m_BindGroups[0] = m_Device.CreateBindGroup(&copyDescriptor);
+
+    wgpu::BindGroupLayout downsampleLayout = m_DownsamplePipeline.GetBindGroupLayout(0);
+    for (u32 mip = 1; mip < m_MipCount; ++mip)
+    {
+        std::array<wgpu::BindGroupEntry, 2> entries{};
+        entries[0] = {.binding = 0, .textureView = mipViews[mip - 1]};
+        entries[1] = {.binding = 1, .textureView = mipViews[mip]};
+
+        wgpu::BindGroupDescriptor descriptor{.layout = downsampleLayout,
+                                             .entryCount = entries.size(),
+                                             .entries = entries.data()};
+        m_BindGroups[mip] = m_Device.CreateBindGroup(&descriptor);
+    }
+}
+
+wgpu::ComputePipeline DepthPyramid::CreatePipeline(const wgpu::ShaderModule& module, const char* label,
+                                                   const char* entryPoint)
+{
+    // Layouts are derived from the shader; each entry point only uses its own bindings.
+    wgpu::ComputePipelineDescriptor pipelineDescriptor{
+        .label = label,
+        .compute = {.module = module, .entryPoint = entryPoint},
+    };
+    return m_Device.CreateComputePipeline(&pipelineDescriptor);
+}
+
+void DepthPyramid::Build(wgpu::CommandEncoder& encoder,
+                         const wgpu::ComputePassTimestampWrites* timestampWrites) const
+{
+    wgpu::ComputePassDescriptor passDescriptor{.label = "Depth Pyramid", .timestampWrites = timestampWrites};
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass(&passDescriptor);
+
+    for (u32 mip = 0; mip < m_MipCount; ++mip)
+    {
+        const u32 width = std::max(m_Width >> mip, 1u);
+        const u32 height = std::max(m_Height >> mip, 1u);
+
+        pass.SetPipeline(mip == 0 ? m_CopyPipeline : m_DownsamplePipeline);
+        pass.SetBindGroup(0, m_BindGroups[mip]);
+        pass.DispatchWorkgroups((width + kWorkgroupSize - 1) / kWorkgroupSize,
+                                (height + kWorkgroupSize - 1) / kWorkgroupSize);
+    }
+
+    pass.End();
+}
+
+const wgpu::TextureView& DepthPyramid::GetView() const
+{
+    return m_View;
+}
+
+v2f DepthPyramid::GetSize() const
+{
+    return {static_cast<f32>(m_Width), static_cast<f32>(m_Height)};
+}
+
+u32 DepthPyramid::GetMipCount() const
+{
+    return m_MipCount;
+}
+
+} // photon
@@ -0,0 +1,54 @@
+//
+// Created by Raul Romero on 2026-10-18.
+//
+
+#ifndef PHOTON_DEPTHPYRAMID_H
+#define PHOTON_DEPTHPYRAMID_H
+
+#include "PhotonCore.h"
+#include <webgpu/webgpu_cpp.h>
+#include <vector>
+
+namespace photon
+{
+
+// Hierarchical-Z buffer: mip 0 is a copy of the depth buffer and each further
+// mip keeps the farthest depth of the texels below it, so a single texel
+// bounds every depth in its footprint. Odd dimensions fold the trailing
+// row/column into the last texel, so pixel p maps to min(p >> mip, size - 1).
+class DepthPyramid
+{
+public:
+    static constexpr u32 kWorkgroupSize = 8;
+
+    void Init(const wgpu::Device& device, const wgpu::TextureView& depthView, u32 width, u32 height);
+
+    // Records the copy and every reduction; must follow the pass that wrote depth.
+    void Build(wgpu::CommandEncoder& encoder,
+               const wgpu::ComputePassTimestampWrites* timestampWrites = nullptr) const;
+
+    [[nodiscard]] const wgpu::TextureView& GetView() const;
+    [[nodiscard]] v2f GetSize() const;
+    [[nodiscard]] u32 GetMipCount() const;
+
+private:
+    wgpu::ComputePipeline CreatePipeline(const wgpu::ShaderModule& module, const char* label,
+                                         const char* entryPoint);
+
+    wgpu::Device m_Device;
+    wgpu::Texture m_Texture;
+    wgpu::TextureView m_View;
+
+    wgpu::ComputePipeline m_CopyPipeline;
+    wgpu::ComputePipeline m_DownsamplePipeline;
+    // [0] copies depth into mip 0, [i] reduces mip i - 1 into mip i.
+    std::vector<wgpu::BindGroup> m_BindGroups;
+
+    u32 m_Width = 0;
+    u32 m_Height = 0;
+    u32 m_MipCount = 0;
+};
+
+} // photon
+
+#endif //PHOTON_DEPTHPYRAMID_H
@@ -0,0 +1,235 @@
+//
+// Created by Raul Romero on 2026-10-18.
+//
+
+#include "DiskBlobCache.h"
+
+#if !defined(__EMSCRIPTEN__)
+
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace photon
+{
+
+namespace fs = std::filesystem;
+
+static constexpr u32 kEntryMagic = 0x50484243; // "PHBC"
+
+struct EntryHeader
+{
+    u32 magic;
+    u32 keySize;
+    u64 valueSize;
+};
+
+DiskBlobCache::DiskBlobCache(const fs::path& directory, u64 maxBytes) :
+    m_Directory(directory / GetVersionKey()),
+    m_MaxBytes(maxBytes)
+{
+    std::error_code error;
+    fs::create_directories(m_Directory, error);
+    if (error)
+    {
+        LogWarning("Could not create pipeline cache directory %s", m_Directory.string().c_str());
+        return;
+    }
+
+    Scan();
+}
+
+const char* DiskBlobCache::GetVersionKey()
+{
+    static const std::string key = std::string("photon-") + PHOTON_VERSION_STRING + "-blob" + std::to_string(kFormatVersion);
+    return key.c_str();
+}
+
+u64 DiskBlobCache::HashKey(const void* key, size_t keySize)
+{
+    // FNV-1a; the full key is stored in the entry and compared on load.
+    u64 hash = 0xcbf29ce484222325ull;
+    const u8* bytes = static_cast<const u8*>(key);
+    for (size_t i = 0; i < keySize; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+fs::path DiskBlobCache::GetEntryPath(u64 hash) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(hash));
+    return m_Directory / name;
+}
+
+void DiskBlobCache::Scan()
+{
+    struct Found
+    {
+        u64 hash;
+        u64 size;
+        fs::file_time_type time;
+    };
+    std::vector<Found> found;
+
+    std::error_code error;
+    for (const fs::directory_entry& file : fs::directory_iterator(m_Directory, error))
+    {
+        if (!file.is_regular_file() || file.path().extension() != ".bin")
+        {
+            continue;
+        }
+
+        const u64 hash = std::strtoull(file.path().stem().string().c_str(), nullptr, 16);
+        found.push_back({hash, file.file_size(), file.last_write_time()});
+    }
+
+    // Oldest first so use counters preserve the on-disk LRU order.
+    std::sort(found.begin(), found.end(), [](const Found& a, const Found& b) { return a.time < b.time; });
+
+    for (const Found& file : found)
+    {
+        m_Entries[file.hash] = {file.size, ++m_UseCounter};
+        m_TotalBytes += file.size;
+    }
+
+    EvictLocked();
+}
+
+size_t DiskBlobCache::LoadData(const void* key, size_t keySize, void* valueOut, size_t valueSize)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    const u64 hash = HashKey(key, keySize);
+    auto it = m_Entries.find(hash);
+    if (it == m_Entries.end())
+    {
+        return 0;
+    }
+
+    const fs::path path = GetEntryPath(hash);
+    std::ifstream file(path, std::ios::binary);
+
+    EntryHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != kEntryMagic ||
+        header.keySize != keySize)
+    {
+        return 0;
+    }
+
+    std::vector<u8> storedKey(keySize);
+    if (!file.read(reinterpret_cast<char*>(storedKey.data()), keySize) ||
+        memcmp(storedKey.data(), key, keySize) != 0)
+    {
+        return 0;
+    }
+
+    if (valueOut == nullptr)
+    {
+        return header.valueSize;
+    }
+
+    if (valueSize < header.valueSize ||
+        !file.read(static_cast<char*>(valueOut), static_cast<std::streamsize>(header.valueSize)))
+    {
+        return 0;
+    }
+
+    it->second.lastUse = ++m_UseCounter;
+    std::error_code error;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+
+    return header.valueSize;
+}
+
+void DiskBlobCache::StoreData(const void* key, size_t keySize, const void* value, size_t valueSize)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    const u64 hash = HashKey(key, keySize);
+    const fs::path path = GetEntryPath(hash);
+    fs::path tempPath = path;
+    tempPath.replace_extension(".tmp");
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        EntryHeader header{kEntryMagic, static_cast<u32>(keySize), valueSize};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(static_cast<const char*>(key), static_cast<std::streamsize>(keySize));
+        file.write(static_cast<const char*>(value), static_cast<std::streamsize>(valueSize));
+        if (!file)
+        {
+            LogWarning("Could not write pipeline cache entry %s", tempPath.string().c_str());
+            return;
+        }
+    }
+
+    // Rename so a crash never leaves a truncated entry behind.
+    std::error_code error;
+    fs::rename(tempPath, path, error);
+    if (error)
+    {
+        fs::remove(tempPath, error);
+        return;
+    }
+
+    const u64 size = sizeof(EntryHeader) + keySize + valueSize;
+    auto it = m_Entries.find(hash);
+    if (it != m_Entries.end())
+    {
+        m_TotalBytes -= it->second.size;
+    }
+    m_Entries[hash] = {size, ++m_UseCounter};
+    m_TotalBytes += size;
+
+    EvictLocked();
+}
+
+void DiskBlobCache::EvictLocked()
+{
+    while (m_TotalBytes > m_MaxBytes && !m_Entries.empty())
+    {
+        auto oldest = std::min_element(m_Entries.begin(), m_Entries.end(), [](const auto& a, const auto& b) {
+            return a.second.lastUse < b.second.lastUse;
+        });
+
+        std::error_code error;
+        fs::remove(GetEntryPath(oldest->first), error);
+        m_TotalBytes -= oldest->second.size;
+        m_Entries.erase(oldest);
+    }
+}
+
+u64 DiskBlobCache::GetTotalBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_TotalBytes;
+}
+
+const fs::path& DiskBlobCache::GetDirectory() const
+{
+    return m_Directory;
+}
+
+CachingPlatform::CachingPlatform(const fs::path& directory, u64 maxBytes) :
+    m_Cache(directory, maxBytes)
+{}
+
+dawn::platform::CachingInterface* CachingPlatform::GetCachingInterface()
+{
+    return &m_Cache;
+}
+
+DiskBlobCache& CachingPlatform::GetCache()
+{
+    return m_Cache;
+}
+
+} // photon
+
+#endif
@@ -0,0 +1,79 @@
+//
+// Created by Raul Romero on 2026-10-18.
+//
+
+#ifndef PHOTON_DISKBLOBCACHE_H
+#define PHOTON_DISKBLOBCACHE_H
+
+#if !defined(__EMSCRIPTEN__)
+
+#include "PhotonCore.h"
+#include <dawn/platform/DawnPlatform.h>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace photon
+{
+
+// Persistent store for Dawn's blob cache (compiled shaders and pipelines).
+// One file per entry under a version-keyed directory; least recently used
+// entries are evicted once the directory grows past its size cap.
+class DiskBlobCache : public dawn::platform::CachingInterface
+{
+public:
+    static constexpr u32 kFormatVersion = 1;
+    static constexpr u64 kDefaultMaxBytes = 256ull * 1024 * 1024;
+
+    explicit DiskBlobCache(const std::filesystem::path& directory, u64 maxBytes = kDefaultMaxBytes);
+
+    size_t LoadData(const void* key, size_t keySize, void* valueOut, size_t valueSize) override;
+    void StoreData(const void* key, size_t keySize, const void* value, size_t valueSize) override;
+
+    [[nodiscard]] u64 GetTotalBytes() const;
+    [[nodiscard]] const std::filesystem::path& GetDirectory() const;
+
+    // Key isolating cache entries from other engine or cache format versions.
+    static const char* GetVersionKey();
+
+private:
+    struct Entry
+    {
+        u64 size;
+        u64 lastUse;
+    };
+
+    static u64 HashKey(const void* key, size_t keySize);
+    std::filesystem::path GetEntryPath(u64 hash) const;
+    void Scan();
+    void EvictLocked();
+
+    std::filesystem::path m_Directory;
+    u64 m_MaxBytes;
+    u64 m_TotalBytes = 0;
+    u64 m_UseCounter = 0;
+    std::unordered_map<u64, Entry> m_Entries;
+    mutable std::mutex m_Mutex;
+};
+
+// Dawn platform that exposes a DiskBlobCache to the instance.
+class CachingPlatform : public dawn::platform::Platform
+{
+public:
+    explicit CachingPlatform(const std::filesystem::path& directory,
+                             u64 maxBytes = DiskBlobCache::kDefaultMaxBytes);
+
+    dawn::platform::CachingInterface* GetCachingInterface() override;
+
+    DiskBlobCache& GetCache();
+
+private:
+    DiskBlobCache m_Cache;
+};
+
+} // photon
+
+#endif
+
+#endif //PHOTON_DISKBLOBCACHE_H
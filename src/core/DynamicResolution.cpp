@@ -0,0 +1,90 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+
+namespace photon
+{
+
+// Weight of the newest frame in the running average.
+static constexpr f32 kSmoothing = 0.1f;
+
+void DynamicResolution::Init(u32 outputWidth, u32 outputHeight)
+{
+    m_OutputWidth = outputWidth;
+    m_OutputHeight = outputHeight;
+    m_Scale = kMaxScale;
+    m_RenderWidth = outputWidth;
+    m_RenderHeight = outputHeight;
+    m_AverageMs = 0.f;
+    m_Cooldown = kCooldownFrames;
+}
+
+bool DynamicResolution::Update(f32 frameMs)
+{
+    if (!bEnabled)
+    {
+        return SetScale(kMaxScale);
+    }
+    if (frameMs <= 0.f)
+    {
+        return false;
+    }
+
+    if (m_Cooldown > 0)
+    {
+        // The first frames after a change still carry the old resolution's cost.
+        --m_Cooldown;
+        m_AverageMs = frameMs;
+        return false;
+    }
+    m_AverageMs += (frameMs - m_AverageMs) * kSmoothing;
+
+    if (m_AverageMs > TargetFrameMs)
+    {
+        const f32 scale = m_Scale * std::sqrt(TargetFrameMs / m_AverageMs);
+        return SetScale(std::floor(scale / kScaleStep + 1e-3f) * kScaleStep);
+    }
+    if (m_AverageMs < TargetFrameMs * Headroom)
+    {
+        return SetScale(m_Scale + kScaleStep);
+    }
+    return false;
+}
+
+f32 DynamicResolution::GetScale() const
+{
+    return m_Scale;
+}
+
+u32 DynamicResolution::GetRenderWidth() const
+{
+    return m_RenderWidth;
+}
+
+u32 DynamicResolution::GetRenderHeight() const
+{
+    return m_RenderHeight;
+}
+
+bool DynamicResolution::SetScale(f32 scale)
+{
+    scale = std::clamp(scale, kMinScale, kMaxScale);
+    const u32 width = std::max(1u, static_cast<u32>(std::lround(m_OutputWidth * scale)));
+    const u32 height = std::max(1u, static_cast<u32>(std::lround(m_OutputHeight * scale)));
+    m_Scale = scale;
+    if (width == m_RenderWidth && height == m_RenderHeight)
+    {
+        return false;
+    }
+
+    m_RenderWidth = width;
+    m_RenderHeight = height;
+    m_Cooldown = kCooldownFrames;
+    return true;
+}
+
+} // photon
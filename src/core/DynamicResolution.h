@@ -0,0 +1,57 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_DYNAMICRESOLUTION_H
+#define PHOTON_DYNAMICRESOLUTION_H
+
+#include "PhotonCore.h"
+
+namespace photon
+{
+
+// Picks the scene's render resolution from measured GPU frame times. Cost is
+// taken to scale with pixel count, so an over-budget frame shrinks the scale by
+// sqrt(target / time); the scale grows back one step at a time once frames have
+// headroom. Scales are quantized and changes are spaced apart, since every
+// change re-creates the render targets.
+class DynamicResolution
+{
+public:
+    static constexpr f32 kMinScale = 0.5f;
+    static constexpr f32 kMaxScale = 1.f;
+    static constexpr f32 kScaleStep = 0.05f;
+    // Frames to wait after a change before measuring again.
+    static constexpr u32 kCooldownFrames = 30;
+
+    void Init(u32 outputWidth, u32 outputHeight);
+
+    // Feeds one frame's GPU time, ignored when not positive; returns true when
+    // the render size changed.
+    bool Update(f32 frameMs);
+
+    [[nodiscard]] f32 GetScale() const;
+    [[nodiscard]] u32 GetRenderWidth() const;
+    [[nodiscard]] u32 GetRenderHeight() const;
+
+    f32 TargetFrameMs = 16.6f;
+    // Frames faster than this fraction of the target allow a step up.
+    f32 Headroom = 0.8f;
+    bool bEnabled = true;
+
+private:
+    bool SetScale(f32 scale);
+
+    u32 m_OutputWidth = 0;
+    u32 m_OutputHeight = 0;
+    u32 m_RenderWidth = 0;
+    u32 m_RenderHeight = 0;
+    f32 m_Scale = kMaxScale;
+
+    f32 m_AverageMs = 0.f;
+    u32 m_Cooldown = 0;
+};
+
+} // photon
+
+#endif //PHOTON_DYNAMICRESOLUTION_H
@@ -0,0 +1,103 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "FrameCapture.h"
+#include "Logger.h"
+#include "stb_image_write.h"
+
+namespace photon
+{
+
+// Texture-to-buffer copies need rows aligned to 256 bytes.
+static constexpr u32 kRowAlignment = 256;
+
+void FrameCapture::Init(const wgpu::Device& device)
+{
+    m_Device = device;
+}
+
+void FrameCapture::Capture(const wgpu::Texture& texture, u32 width, u32 height, const std::string& path)
+{
+    auto pending = std::make_unique<Pending>();
+    pending->Width = width;
+    pending->Height = height;
+    pending->BytesPerRow = (width * 4 + kRowAlignment - 1) & ~(kRowAlignment - 1);
+    pending->Path = path;
+
+    const u64 size = static_cast<u64>(pending->BytesPerRow) * height;
+    wgpu::BufferDescriptor bufferDescriptor{.label = "Frame Capture",
+                                            .usage = wgpu::BufferUsage::MapRead | wgpu::BufferUsage::CopyDst,
+                                            .size = size,
+                                            .mappedAtCreation = false};
+    pending->Buffer = m_Device.CreateBuffer(&bufferDescriptor);
+
+    wgpu::ImageCopyTexture source{.texture = texture};
+    wgpu::ImageCopyBuffer destination{
+        .layout = {.offset = 0, .bytesPerRow = pending->BytesPerRow, .rowsPerImage = height},
+        .buffer = pending->Buffer,
+    };
+    wgpu::Extent3D extent{width, height, 1};
+
+    wgpu::CommandEncoder encoder = m_Device.CreateCommandEncoder();
+    encoder.CopyTextureToBuffer(&source, &destination, &extent);
+    wgpu::CommandBuffer commands = encoder.Finish();
+    m_Device.GetQueue().Submit(1, &commands);
+
+    pending->Buffer.MapAsync(wgpu::MapMode::Read, 0, size, OnMapped, pending.get());
+    m_Pending.push_back(std::move(pending));
+}
+
+bool FrameCapture::HasPending()
+{
+    std::erase_if(m_Pending, [](const std::unique_ptr<Pending>& pending) { return pending->bDone; });
+    return !m_Pending.empty();
+}
+
+void FrameCapture::OnMapped(WGPUBufferMapAsyncStatus status, void* userdata)
+{
+    Pending& pending = *static_cast<Pending*>(userdata);
+    pending.bDone = true;
+    if (status != WGPUBufferMapAsyncStatus_Success)
+    {
+        LogError("Could not read back frame for %s", pending.Path.c_str());
+        return;
+    }
+
+    const u8* mapped = static_cast<const u8*>(
+        pending.Buffer.GetConstMappedRange(0, static_cast<size_t>(pending.BytesPerRow) * pending.Height));
+    if (!mapped)
+    {
+        // The Null backend has no contents to read.
+        pending.Buffer.Unmap();
+        return;
+    }
+
+    // Drop the row padding and swizzle BGRA to RGBA.
+    std::vector<u8> pixels(static_cast<size_t>(pending.Width) * pending.Height * 4);
+    for (u32 y = 0; y < pending.Height; ++y)
+    {
+        const u8* row = mapped + static_cast<size_t>(y) * pending.BytesPerRow;
+        u8* out = pixels.data() + static_cast<size_t>(y) * pending.Width * 4;
+        for (u32 x = 0; x < pending.Width; ++x)
+        {
+            out[x * 4 + 0] = row[x * 4 + 2];
+            out[x * 4 + 1] = row[x * 4 + 1];
+            out[x * 4 + 2] = row[x * 4 + 0];
+            out[x * 4 + 3] = row[x * 4 + 3];
+        }
+    }
+    pending.Buffer.Unmap();
+
+    if (stbi_write_png(pending.Path.c_str(), static_cast<i32>(pending.Width), static_cast<i32>(pending.Height), 4,
+                       pixels.data(), static_cast<i32>(pending.Width * 4)))
+    {
+        LogInfo("Wrote %s", pending.Path.c_str());
+    }
+    else
+    {
+        LogError("Could not write %s", pending.Path.c_str());
+    }
+}
+
+} // photon
@@ -0,0 +1,52 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_FRAMECAPTURE_H
+#define PHOTON_FRAMECAPTURE_H
+
+#include "PhotonCore.h"
+#include <webgpu/webgpu_cpp.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace photon
+{
+
+// Reads rendered frames back to PNG files. Capture copies the texture into a
+// staging buffer on its own command buffer and maps it asynchronously; the PNG
+// is written from the map callback, so rendering continues meanwhile. Each
+// capture owns its buffer, so any number can be in flight.
+class FrameCapture
+{
+public:
+    void Init(const wgpu::Device& device);
+
+    // texture must be BGRA8Unorm with CopySrc usage; the copy is ordered after
+    // everything already submitted.
+    void Capture(const wgpu::Texture& texture, u32 width, u32 height, const std::string& path);
+
+    // Releases finished captures; true while any is still waiting on its map.
+    bool HasPending();
+
+private:
+    struct Pending
+    {
+        wgpu::Buffer Buffer;
+        u32 Width = 0;
+        u32 Height = 0;
+        u32 BytesPerRow = 0;
+        std::string Path;
+        bool bDone = false;
+    };
+
+    static void OnMapped(WGPUBufferMapAsyncStatus status, void* userdata);
+
+    wgpu::Device m_Device;
+    std::vector<std::unique_ptr<Pending>> m_Pending;
+};
+
+} // photon
+
+#endif //PHOTON_FRAMECAPTURE_H
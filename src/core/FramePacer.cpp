@@ -0,0 +1,161 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "FramePacer.h"
+#include "CpuProfiler.h"
+#include "GpuProfiler.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <thread>
+
+namespace photon
+{
+
+namespace
+{
+
+f32 ElapsedMs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+    return std::chrono::duration<f32, std::milli>(to - from).count();
+}
+
+} // namespace
+
+void FramePacer::History::Add(f32 sample)
+{
+    Samples[Next] = sample;
+    Next = (Next + 1) % kHistorySize;
+    Count = std::min(Count + 1, kHistorySize);
+}
+
+std::vector<f32> FramePacer::History::Sorted() const
+{
+    std::vector<f32> sorted(Samples.begin(), Samples.begin() + Count);
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+f32 FramePacer::History::Average() const
+{
+    if (Count == 0)
+    {
+        return 0.f;
+    }
+    return std::accumulate(Samples.begin(), Samples.begin() + Count, 0.f) / static_cast<f32>(Count);
+}
+
+void FramePacer::Init(u32 maxFramesInFlight)
+{
+    m_MaxFramesInFlight = maxFramesInFlight;
+}
+
+void FramePacer::WaitForFrameSlot(const wgpu::Instance& instance)
+{
+    if (m_MaxFramesInFlight == 0)
+    {
+        return;
+    }
+
+    PHOTON_PROFILE_FUNCTION();
+    const Clock::time_point start = Clock::now();
+    while (m_Submitted.size() >= m_MaxFramesInFlight)
+    {
+        instance.ProcessEvents();
+        std::this_thread::yield();
+    }
+    m_Throttle.Add(ElapsedMs(start, Clock::now()));
+}
+
+void FramePacer::OnSubmitted(const wgpu::Queue& queue)
+{
+    m_FramesInFlight.Add(static_cast<f32>(m_Submitted.size()));
+    m_Submitted.push_back(Clock::now());
+    queue.OnSubmittedWorkDone(&FramePacer::OnWorkDone, this);
+}
+
+void FramePacer::OnWorkDone(WGPUQueueWorkDoneStatus, void* userdata)
+{
+    // Reported on failure too, or the limiter would wait forever.
+    FramePacer* pacer = static_cast<FramePacer*>(userdata);
+    if (pacer->m_Submitted.empty())
+    {
+        return;
+    }
+    pacer->m_Latencies.Add(ElapsedMs(pacer->m_Submitted.front(), Clock::now()));
+    pacer->m_Submitted.pop_front();
+}
+
+void FramePacer::OnInput(u64 tick)
+{
+    m_PendingInput.push_back({.Tick = tick, .Arrival = Clock::now()});
+}
+
+void FramePacer::OnPresented(u64 tick)
+{
+    const Clock::time_point now = Clock::now();
+    if (m_bPresented)
+    {
+        m_Intervals.Add(ElapsedMs(m_LastPresent, now));
+    }
+    m_LastPresent = now;
+    m_bPresented = true;
+
+    if (!m_PendingInput.empty() && m_PendingInput.front().Tick <= tick)
+    {
+        m_InputLatencies.Add(ElapsedMs(m_PendingInput.front().Arrival, now));
+    }
+    while (!m_PendingInput.empty() && m_PendingInput.front().Tick <= tick)
+    {
+        m_PendingInput.pop_front();
+    }
+}
+
+FramePacingStats FramePacer::GetStats() const
+{
+    FramePacingStats stats{.AverageThrottleMs = m_Throttle.Average(),
+                           .AverageFramesInFlight = m_FramesInFlight.Average()};
+
+    const std::vector<f32> latencies = m_Latencies.Sorted();
+    if (!latencies.empty())
+    {
+        stats.AverageLatencyMs = m_Latencies.Average();
+        stats.P95LatencyMs = Percentile(latencies, 0.95f);
+    }
+
+    const std::vector<f32> inputLatencies = m_InputLatencies.Sorted();
+    if (!inputLatencies.empty())
+    {
+        stats.InputSampleCount = static_cast<u32>(inputLatencies.size());
+        stats.AverageInputLatencyMs = m_InputLatencies.Average();
+        stats.P95InputLatencyMs = Percentile(inputLatencies, 0.95f);
+    }
+
+    const std::vector<f32> intervals = m_Intervals.Sorted();
+    if (intervals.empty())
+    {
+        return stats;
+    }
+    stats.SampleCount = static_cast<u32>(intervals.size());
+    stats.AverageIntervalMs = m_Intervals.Average();
+    stats.P50IntervalMs = Percentile(intervals, 0.50f);
+    stats.P95IntervalMs = Percentile(intervals, 0.95f);
+    stats.P99IntervalMs = Percentile(intervals, 0.99f);
+    stats.MaxIntervalMs = intervals.back();
+
+    f32 variance = 0.f;
+    for (const f32 interval : intervals)
+    {
+        const f32 deviation = interval - stats.AverageIntervalMs;
+        variance += deviation * deviation;
+        if (interval > 2.f * stats.P50IntervalMs)
+        {
+            ++stats.HitchCount;
+        }
+    }
+    stats.JitterMs = std::sqrt(variance / static_cast<f32>(intervals.size()));
+    return stats;
+}
+
+} // photon
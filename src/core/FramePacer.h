@@ -0,0 +1,113 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_FRAMEPACER_H
+#define PHOTON_FRAMEPACER_H
+
+#include "PhotonCore.h"
+#include <webgpu/webgpu_cpp.h>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+namespace photon
+{
+
+struct FramePacingStats
+{
+    u32 SampleCount = 0;
+    // Present to present.
+    f32 AverageIntervalMs = 0.f;
+    f32 P50IntervalMs = 0.f;
+    f32 P95IntervalMs = 0.f;
+    f32 P99IntervalMs = 0.f;
+    f32 MaxIntervalMs = 0.f;
+    // Standard deviation of the interval.
+    f32 JitterMs = 0.f;
+    // Intervals longer than twice the median.
+    u32 HitchCount = 0;
+    // Submit to the queue reporting the frame's work done.
+    f32 AverageLatencyMs = 0.f;
+    f32 P95LatencyMs = 0.f;
+    // Spent in WaitForFrameSlot before starting a frame.
+    f32 AverageThrottleMs = 0.f;
+    // Frames the GPU had not finished when the next one was submitted.
+    f32 AverageFramesInFlight = 0.f;
+    // From the first input a frame shows to that frame's present, over frames
+    // that showed new input.
+    u32 InputSampleCount = 0;
+    f32 AverageInputLatencyMs = 0.f;
+    f32 P95InputLatencyMs = 0.f;
+};
+
+// Limits how many submitted frames may be unfinished on the GPU and records
+// how evenly frames are presented. Completion comes from
+// Queue::OnSubmittedWorkDone, which reports submissions in order, so frames in
+// flight are simply the submissions without a callback yet. With no limit the
+// CPU runs ahead as far as Dawn and the swap chain allow.
+class FramePacer
+{
+public:
+    static constexpr u32 kHistorySize = 256;
+
+    // maxFramesInFlight 0 disables the limit.
+    void Init(u32 maxFramesInFlight);
+
+    // Waits until another frame may start, processing instance events so
+    // completions arrive.
+    void WaitForFrameSlot(const wgpu::Instance& instance);
+    // Call once the frame's last command buffer was submitted.
+    void OnSubmitted(const wgpu::Queue& queue);
+    // Call when input arrives that the simulation applies at tick. Its
+    // latency runs until the first frame showing that tick is presented.
+    void OnInput(u64 tick);
+    // Call once the frame was presented, or submitted when there is nothing
+    // to present, with the newest simulation tick it shows.
+    void OnPresented(u64 tick);
+
+    [[nodiscard]] u32 GetMaxFramesInFlight() const { return m_MaxFramesInFlight; }
+    [[nodiscard]] u32 GetFramesInFlight() const { return static_cast<u32>(m_Submitted.size()); }
+    [[nodiscard]] FramePacingStats GetStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Last kHistorySize samples.
+    struct History
+    {
+        std::array<f32, kHistorySize> Samples{};
+        u32 Next = 0;
+        u32 Count = 0;
+
+        void Add(f32 sample);
+        [[nodiscard]] std::vector<f32> Sorted() const;
+        [[nodiscard]] f32 Average() const;
+    };
+
+    static void OnWorkDone(WGPUQueueWorkDoneStatus status, void* userdata);
+
+    u32 m_MaxFramesInFlight = 0;
+    // Submit times of unfinished frames, oldest first.
+    std::deque<Clock::time_point> m_Submitted;
+    Clock::time_point m_LastPresent;
+    bool m_bPresented = false;
+    struct PendingInput
+    {
+        u64 Tick = 0;
+        Clock::time_point Arrival;
+    };
+    // Input not shown yet, in arrival order; ticks never decrease.
+    std::deque<PendingInput> m_PendingInput;
+
+    History m_Intervals;
+    History m_Latencies;
+    History m_Throttle;
+    History m_FramesInFlight;
+    History m_InputLatencies;
+};
+
+} // photon
+
+#endif //PHOTON_FRAMEPACER_H
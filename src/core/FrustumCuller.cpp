@@ -0,0 +1,320 @@
+//
+// Created by Raul Romero on 2026-10-18.
+//
+
+#include "FrustumCuller.h"
+#include <algorithm>
+#include <bit>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#if !defined(__EMSCRIPTEN__)
+#include "CpuProfiler.h"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace photon
+{
+
+// Spheres are padded to a multiple of the widest SIMD lane count. Padding
+// uses a huge negative radius so it can never pass a plane test.
+static constexpr u32 kLaneCount = 8;
+static constexpr f32 kPaddingRadius = -1e30f;
+
+#if !defined(__EMSCRIPTEN__)
+namespace
+{
+
+// Threads shared by every culler, started by the first parallel cull and kept
+// until exit, so a cull per shadow cascade or tile does not pay for thread
+// creation. Run hands part t of a job to worker t and does part 0 itself.
+class CullWorkers
+{
+public:
+    static CullWorkers& Get()
+    {
+        static CullWorkers workers;
+        return workers;
+    }
+
+    ~CullWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_bStopping = true;
+        }
+        m_Wake.notify_all();
+        for (std::thread& thread : m_Threads)
+        {
+            thread.join();
+        }
+    }
+
+    [[nodiscard]] u32 GetPartCount() const { return static_cast<u32>(m_Threads.size()) + 1; }
+
+    // Returns once every part has run. Calls from several threads take turns.
+    void Run(const std::function<void(u32)>& job)
+    {
+        std::lock_guard<std::mutex> turn(m_RunMutex);
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Job = &job;
+            m_Remaining = static_cast<u32>(m_Threads.size());
+            ++m_Generation;
+        }
+        m_Wake.notify_all();
+
+        job(0);
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Done.wait(lock, [this] { return m_Remaining == 0; });
+        m_Job = nullptr;
+    }
+
+private:
+    CullWorkers()
+    {
+        const u32 partCount = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+        for (u32 part = 1; part < partCount; ++part)
+        {
+            m_Threads.emplace_back(&CullWorkers::WorkerMain, this, part);
+        }
+    }
+
+    void WorkerMain(u32 part)
+    {
+        PHOTON_PROFILE_THREAD("Frustum Culling");
+        u64 generation = 0;
+        while (true)
+        {
+            const std::function<void(u32)>* job = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Wake.wait(lock, [&] { return m_bStopping || m_Generation != generation; });
+                if (m_bStopping)
+                {
+                    return;
+                }
+                generation = m_Generation;
+                job = m_Job;
+            }
+
+            (*job)(part);
+
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                --m_Remaining;
+            }
+            m_Done.notify_one();
+        }
+    }
+
+    std::mutex m_RunMutex;
+
+    // Guarded by m_Mutex.
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::condition_variable m_Done;
+    const std::function<void(u32)>* m_Job = nullptr;
+    u64 m_Generation = 0;
+    u32 m_Remaining = 0;
+    bool m_bStopping = false;
+
+    std::vector<std::thread> m_Threads;
+};
+
+} // namespace
+#endif
+
+Frustum Frustum::FromViewProjection(const m4& viewProjection)
+{
+    const m4& m = viewProjection;
+    const v4f row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const v4f row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const v4f row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const v4f row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    Frustum frustum{};
+    frustum.Planes[0] = row3 + row0;
+    frustum.Planes[1] = row3 - row0;
+    frustum.Planes[2] = row3 + row1;
+    frustum.Planes[3] = row3 - row1;
+    frustum.Planes[4] = row3 + row2;
+    frustum.Planes[5] = row3 - row2;
+
+    for (v4f& plane : frustum.Planes)
+    {
+        plane /= glm::length(v3f(plane));
+    }
+
+    return frustum;
+}
+
+v4f TransformBoundingSphere(const m4& transform, const v3f& center, f32 radius)
+{
+    const f32 scale = std::max({glm::length(v3f(transform[0])), glm::length(v3f(transform[1])),
+                                glm::length(v3f(transform[2]))});
+    return v4f(v3f(transform * v4f(center, 1.0f)), radius * scale);
+}
+
+void FrustumCuller::Resize(u32 count)
+{
+    m_Count = count;
+    const u32 paddedCount = (count + kLaneCount - 1) & ~(kLaneCount - 1);
+
+    m_CenterX.resize(paddedCount, 0.f);
+    m_CenterY.resize(paddedCount, 0.f);
+    m_CenterZ.resize(paddedCount, 0.f);
+    m_Radius.resize(paddedCount, kPaddingRadius);
+
+    std::fill(m_Radius.begin() + count, m_Radius.end(), kPaddingRadius);
+}
+
+void FrustumCuller::SetSphere(u32 index, const v3f& center, f32 radius)
+{
+    m_CenterX[index] = center.x;
+    m_CenterY[index] = center.y;
+    m_CenterZ[index] = center.z;
+    m_Radius[index] = radius;
+}
+
+v4f FrustumCuller::GetSphere(u32 index) const
+{
+    return v4f(m_CenterX[index], m_CenterY[index], m_CenterZ[index], m_Radius[index]);
+}
+
+u32 FrustumCuller::GetCount() const
+{
+    return m_Count;
+}
+
+const std::vector<u32>& FrustumCuller::Cull(const Frustum& frustum)
+{
+    m_Visible.clear();
+    const u32 paddedCount = static_cast<u32>(m_Radius.size());
+
+#if !defined(__EMSCRIPTEN__)
+    if (m_Count >= kParallelThreshold)
+    {
+        CullWorkers& workers = CullWorkers::Get();
+        const u32 partCount = workers.GetPartCount();
+        const u32 chunk = ((paddedCount / partCount) + kLaneCount - 1) & ~(kLaneCount - 1);
+        m_ThreadVisible.resize(partCount);
+
+        workers.Run([&](u32 part) {
+            const u32 begin = std::min(part * chunk, paddedCount);
+            const u32 end = part + 1 == partCount ? paddedCount : std::min(begin + chunk, paddedCount);
+            CullRange(frustum, m_CenterX.data(), m_CenterY.data(), m_CenterZ.data(), m_Radius.data(), begin, end,
+                      m_ThreadVisible[part]);
+        });
+
+        for (const std::vector<u32>& visible : m_ThreadVisible)
+        {
+            m_Visible.insert(m_Visible.end(), visible.begin(), visible.end());
+        }
+        return m_Visible;
+    }
+#endif
+
+    CullRange(frustum, m_CenterX.data(), m_CenterY.data(), m_CenterZ.data(), m_Radius.data(), 0, paddedCount,
+              m_Visible);
+    return m_Visible;
+}
+
+void FrustumCuller::CullRange(const Frustum& frustum, const f32* centerX, const f32* centerY, const f32* centerZ,
+                              const f32* radius, u32 begin, u32 end, std::vector<u32>& visible)
+{
+    visible.clear();
+
+#if defined(__AVX__)
+    __m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (u32 p = 0; p < 6; ++p)
+    {
+        planeX[p] = _mm256_set1_ps(frustum.Planes[p].x);
+        planeY[p] = _mm256_set1_ps(frustum.Planes[p].y);
+        planeZ[p] = _mm256_set1_ps(frustum.Planes[p].z);
+        planeW[p] = _mm256_set1_ps(frustum.Planes[p].w);
+    }
+
+    const __m256 zero = _mm256_setzero_ps();
+    for (u32 i = begin; i < end; i += 8)
+    {
+        const __m256 x = _mm256_loadu_ps(centerX + i);
+        const __m256 y = _mm256_loadu_ps(centerY + i);
+        const __m256 z = _mm256_loadu_ps(centerZ + i);
+        const __m256 negRadius = _mm256_sub_ps(zero, _mm256_loadu_ps(radius + i));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (u32 p = 0; p < 6; ++p)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(planeX[p], x), planeW[p]);
+            distance = _mm256_add_ps(_mm256_mul_ps(planeY[p], y), distance);
+            distance = _mm256_add_ps(_mm256_mul_ps(planeZ[p], z), distance);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GT_OQ));
+        }
+
+        u32 mask = static_cast<u32>(_mm256_movemask_ps(inside));
+        while (mask)
+        {
+            visible.push_back(i + std::countr_zero(mask));
+            mask &= mask - 1;
+        }
+    }
+#elif defined(__SSE2__)
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (u32 p = 0; p < 6; ++p)
+    {
+        planeX[p] = _mm_set1_ps(frustum.Planes[p].x);
+        planeY[p] = _mm_set1_ps(frustum.Planes[p].y);
+        planeZ[p] = _mm_set1_ps(frustum.Planes[p].z);
+        planeW[p] = _mm_set1_ps(frustum.Planes[p].w);
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+    for (u32 i = begin; i < end; i += 4)
+    {
+        const __m128 x = _mm_loadu_ps(centerX + i);
+        const __m128 y = _mm_loadu_ps(centerY + i);
+        const __m128 z = _mm_loadu_ps(centerZ + i);
+        const __m128 negRadius = _mm_sub_ps(zero, _mm_loadu_ps(radius + i));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (u32 p = 0; p < 6; ++p)
+        {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(planeX[p], x), planeW[p]);
+            distance = _mm_add_ps(_mm_mul_ps(planeY[p], y), distance);
+            distance = _mm_add_ps(_mm_mul_ps(planeZ[p], z), distance);
+            inside = _mm_and_ps(inside, _mm_cmpgt_ps(distance, negRadius));
+        }
+
+        u32 mask = static_cast<u32>(_mm_movemask_ps(inside));
+        while (mask)
+        {
+            visible.push_back(i + std::countr_zero(mask));
+            mask &= mask - 1;
+        }
+    }
+#else
+    for (u32 i = begin; i < end; ++i)
+    {
+        bool bInside = true;
+        for (u32 p = 0; p < 6 && bInside; ++p)
+        {
+            const v4f& plane = frustum.Planes[p];
+            const f32 distance = plane.x * centerX[i] + plane.y * centerY[i] + plane.z * centerZ[i] + plane.w;
+            bInside = distance > -radius[i];
+        }
+        if (bInside)
+        {
+            visible.push_back(i);
+        }
+    }
+#endif
+}
+
+} // photon
@@ -0,0 +1,62 @@
+//
+// Created by Raul Romero on 2026-10-18.
+//
+
+#ifndef PHOTON_FRUSTUMCULLER_H
+#define PHOTON_FRUSTUMCULLER_H
+
+#include "PhotonCore.h"
+#include <vector>
+
+namespace photon
+{
+
+struct Frustum
+{
+    // Normalized planes (xyz = inward normal, w = distance); left, right,
+    // bottom, top, near, far.
+    v4f Planes[6];
+
+    static Frustum FromViewProjection(const m4& viewProjection);
+};
+
+// World-space sphere (xyz = center, w = radius) of an object-space sphere
+// under transform, conservatively scaled by the largest axis scale.
+v4f TransformBoundingSphere(const m4& transform, const v3f& center, f32 radius);
+
+// Tests world-space bounding spheres against a frustum. Bounds are stored as
+// structure-of-arrays so eight (AVX) or four (SSE) spheres are tested per
+// instruction; very large sets are additionally split across a pool of worker
+// threads shared by all cullers.
+class FrustumCuller
+{
+public:
+    static constexpr u32 kParallelThreshold = 65536;
+
+    void Resize(u32 count);
+    void SetSphere(u32 index, const v3f& center, f32 radius);
+    // xyz = center, w = radius; negative until the sphere has been set.
+    [[nodiscard]] v4f GetSphere(u32 index) const;
+    [[nodiscard]] u32 GetCount() const;
+
+    // Returns the indices of every sphere intersecting the frustum, in
+    // ascending order. The result stays valid until the next call.
+    const std::vector<u32>& Cull(const Frustum& frustum);
+
+private:
+    static void CullRange(const Frustum& frustum, const f32* centerX, const f32* centerY, const f32* centerZ,
+                          const f32* radius, u32 begin, u32 end, std::vector<u32>& visible);
+
+    u32 m_Count = 0;
+    std::vector<f32> m_CenterX;
+    std::vector<f32> m_CenterY;
+    std::vector<f32> m_CenterZ;
+    std::vector<f32> m_Radius;
+
+    std::vector<u32> m_Visible;
+    std::vector<std::vector<u32>> m_ThreadVisible;
+};
+
+} // photon
+
+#endif //PHOTON_FRUSTUMCULLER_H
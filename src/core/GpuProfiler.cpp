@@ -0,0 +1,321 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "GpuProfiler.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace photon
+{
+
+static constexpr u32 kQueriesPerSlot = GpuProfiler::kMaxScopes * 2;
+// Resolve offsets must be 256-byte aligned; one slot is 512 bytes.
+static constexpr u64 kSlotBytes = kQueriesPerSlot * sizeof(u64);
+
+f32 Percentile(const std::vector<f32>& sorted, f32 fraction)
+{
+    const size_t index = static_cast<size_t>(fraction * static_cast<f32>(sorted.size() - 1) + 0.5f);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void GpuProfiler::Init(const wgpu::Device& device)
+{
+    m_Device = device;
+    m_bEnabled = m_Device.HasFeature(wgpu::FeatureName::TimestampQuery);
+    if (!m_bEnabled)
+    {
+        LogInfo("timestamp-query is not supported; GPU profiling is disabled");
+        return;
+    }
+
+    wgpu::QuerySetDescriptor querySetDescriptor{.label = "GPU Profiler",
+                                                .type = wgpu::QueryType::Timestamp,
+                                                .count = kQueriesPerSlot * kFramesInFlight};
+    m_QuerySet = m_Device.CreateQuerySet(&querySetDescriptor);
+
+    wgpu::BufferDescriptor bufferDescriptor{.label = "GPU Profiler Resolve",
+                                            .usage = wgpu::BufferUsage::QueryResolve | wgpu::BufferUsage::CopySrc,
+                                            .size = kSlotBytes * kFramesInFlight,
+                                            .mappedAtCreation = false};
+    m_ResolveBuffer = m_Device.CreateBuffer(&bufferDescriptor);
+
+    bufferDescriptor.label = "GPU Profiler Readback";
+    bufferDescriptor.usage = wgpu::BufferUsage::MapRead | wgpu::BufferUsage::CopyDst;
+    bufferDescriptor.size = kSlotBytes;
+    for (Slot& slot : m_Slots)
+    {
+        slot.Profiler = this;
+        slot.ReadbackBuffer = m_Device.CreateBuffer(&bufferDescriptor);
+        slot.Names.reserve(kMaxScopes);
+    }
+}
+
+bool GpuProfiler::IsEnabled() const
+{
+    return m_bEnabled;
+}
+
+void GpuProfiler::BeginFrame()
+{
+    m_bFrameActive = false;
+    if (!m_bEnabled)
+    {
+        return;
+    }
+
+    m_CurrentSlot = static_cast<u32>(m_Frame++ % kFramesInFlight);
+    Slot& slot = m_Slots[m_CurrentSlot];
+    if (slot.State != SlotState::Idle)
+    {
+        return;
+    }
+
+    slot.State = SlotState::Recording;
+    slot.Names.clear();
+    m_bFrameActive = true;
+}
+
+const wgpu::RenderPassTimestampWrites* GpuProfiler::RenderPass(const char* name)
+{
+    const i32 query = AllocateScope(name);
+    if (query < 0)
+    {
+        return nullptr;
+    }
+
+    wgpu::RenderPassTimestampWrites& writes = m_RenderWrites[m_Slots[m_CurrentSlot].Names.size() - 1];
+    writes = {.querySet = m_QuerySet,
+              .beginningOfPassWriteIndex = static_cast<u32>(query),
+              .endOfPassWriteIndex = static_cast<u32>(query) + 1};
+    return &writes;
+}
+
+const wgpu::ComputePassTimestampWrites* GpuProfiler::ComputePass(const char* name)
+{
+    const i32 query = AllocateScope(name);
+    if (query < 0)
+    {
+        return nullptr;
+    }
+
+    wgpu::ComputePassTimestampWrites& writes = m_ComputeWrites[m_Slots[m_CurrentSlot].Names.size() - 1];
+    writes = {.querySet = m_QuerySet,
+              .beginningOfPassWriteIndex = static_cast<u32>(query),
+              .endOfPassWriteIndex = static_cast<u32>(query) + 1};
+    return &writes;
+}
+
+void GpuProfiler::EndFrame(wgpu::CommandEncoder& encoder)
+{
+    if (!m_bFrameActive)
+    {
+        return;
+    }
+
+    Slot& slot = m_Slots[m_CurrentSlot];
+    if (slot.Names.empty())
+    {
+        slot.State = SlotState::Idle;
+        m_bFrameActive = false;
+        return;
+    }
+
+    const u32 firstQuery = m_CurrentSlot * kQueriesPerSlot;
+    const u32 queryCount = static_cast<u32>(slot.Names.size()) * 2;
+    const u64 offset = m_CurrentSlot * kSlotBytes;
+    encoder.ResolveQuerySet(m_QuerySet, firstQuery, queryCount, m_ResolveBuffer, offset);
+    encoder.CopyBufferToBuffer(m_ResolveBuffer, offset, slot.ReadbackBuffer, 0, queryCount * sizeof(u64));
+    slot.State = SlotState::Resolved;
+}
+
+void GpuProfiler::AfterSubmit()
+{
+    if (!m_bFrameActive)
+    {
+        return;
+    }
+    m_bFrameActive = false;
+
+    Slot& slot = m_Slots[m_CurrentSlot];
+    if (slot.State != SlotState::Resolved)
+    {
+        return;
+    }
+    slot.State = SlotState::Mapping;
+    slot.ReadbackBuffer.MapAsync(wgpu::MapMode::Read, 0, slot.Names.size() * 2 * sizeof(u64), OnMapped, &slot);
+}
+
+f32 GpuProfiler::GetFrameMs() const
+{
+    return m_FrameMs;
+}
+
+u64 GpuProfiler::GetResolvedFrameCount() const
+{
+    return m_ResolvedFrames;
+}
+
+std::vector<GpuScopeStats> GpuProfiler::GetStats() const
+{
+    std::vector<GpuScopeStats> stats;
+    stats.reserve(m_ScopeOrder.size());
+    for (const std::string& name : m_ScopeOrder)
+    {
+        const ScopeHistory& history = m_History.at(name);
+        if (history.Samples.empty())
+        {
+            continue;
+        }
+
+        std::vector<f32> sorted = history.Samples;
+        std::sort(sorted.begin(), sorted.end());
+
+        f32 total = 0.f;
+        for (f32 sample : sorted)
+        {
+            total += sample;
+        }
+
+        stats.push_back({
+            .Name = name,
+            .SampleCount = static_cast<u32>(sorted.size()),
+            .AverageMs = total / static_cast<f32>(sorted.size()),
+            .MinMs = sorted.front(),
+            .MaxMs = sorted.back(),
+            .P50Ms = Percentile(sorted, 0.5f),
+            .P95Ms = Percentile(sorted, 0.95f),
+            .P99Ms = Percentile(sorted, 0.99f),
+        });
+    }
+    return stats;
+}
+
+bool GpuProfiler::WriteCsv(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file)
+    {
+        LogError("Could not write GPU profile to %s", path.c_str());
+        return false;
+    }
+
+    file << "scope,samples,avg_ms,min_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+    for (const GpuScopeStats& scope : GetStats())
+    {
+        file << scope.Name << ',' << scope.SampleCount << ',' << scope.AverageMs << ',' << scope.MinMs << ','
+             << scope.P50Ms << ',' << scope.P95Ms << ',' << scope.P99Ms << ',' << scope.MaxMs << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+i32 GpuProfiler::AllocateScope(const char* name)
+{
+    if (!m_bFrameActive)
+    {
+        return -1;
+    }
+
+    Slot& slot = m_Slots[m_CurrentSlot];
+    if (slot.Names.size() >= kMaxScopes)
+    {
+        return -1;
+    }
+
+    const i32 query = static_cast<i32>(m_CurrentSlot * kQueriesPerSlot + slot.Names.size() * 2);
+    slot.Names.push_back(name);
+    return query;
+}
+
+void GpuProfiler::AddSample(const std::string& name, f32 ms)
+{
+    auto [it, bInserted] = m_History.try_emplace(name);
+    if (bInserted)
+    {
+        m_ScopeOrder.push_back(name);
+        it->second.Samples.reserve(kHistorySize);
+    }
+
+    ScopeHistory& history = it->second;
+    if (history.Samples.size() < kHistorySize)
+    {
+        history.Samples.push_back(ms);
+    }
+    else
+    {
+        history.Samples[history.Next] = ms;
+    }
+    history.Next = (history.Next + 1) % kHistorySize;
+}
+
+void GpuProfiler::OnMapped(WGPUBufferMapAsyncStatus status, void* userdata)
+{
+    Slot& slot = *static_cast<Slot*>(userdata);
+    if (status != WGPUBufferMapAsyncStatus_Success)
+    {
+        // Device loss or teardown; the slot is not reused after that.
+        slot.State = SlotState::Idle;
+        return;
+    }
+    slot.Profiler->ReadSlot(slot);
+}
+
+void GpuProfiler::ReadSlot(Slot& slot)
+{
+    const size_t queryCount = slot.Names.size() * 2;
+    const u64* timestamps =
+        static_cast<const u64*>(slot.ReadbackBuffer.GetConstMappedRange(0, queryCount * sizeof(u64)));
+
+    if (timestamps)
+    {
+        // Sum passes sharing a name before recording them.
+        std::vector<std::pair<const char*, u64>> scopes;
+        u64 frameBegin = std::numeric_limits<u64>::max();
+        u64 frameEnd = 0;
+        for (size_t i = 0; i < slot.Names.size(); ++i)
+        {
+            const u64 begin = timestamps[i * 2];
+            const u64 end = timestamps[i * 2 + 1];
+            // Queries of a pass that was never recorded resolve to zero.
+            if (begin == 0 && end == 0)
+            {
+                continue;
+            }
+            // Timestamps can be reset between passes on some backends.
+            const u64 duration = end > begin ? end - begin : 0;
+            frameBegin = std::min(frameBegin, begin);
+            frameEnd = std::max(frameEnd, end);
+
+            auto it = std::find_if(scopes.begin(), scopes.end(),
+                                   [&](const auto& scope) { return std::strcmp(scope.first, slot.Names[i]) == 0; });
+            if (it == scopes.end())
+            {
+                scopes.emplace_back(slot.Names[i], duration);
+            }
+            else
+            {
+                it->second += duration;
+            }
+        }
+
+        constexpr f32 kNanosecondsToMs = 1e-6f;
+        for (const auto& [name, duration] : scopes)
+        {
+            AddSample(name, static_cast<f32>(duration) * kNanosecondsToMs);
+        }
+        if (frameEnd > frameBegin)
+        {
+            m_FrameMs = static_cast<f32>(frameEnd - frameBegin) * kNanosecondsToMs;
+            AddSample(kFrameScope, m_FrameMs);
+            ++m_ResolvedFrames;
+        }
+    }
+
+    slot.ReadbackBuffer.Unmap();
+    slot.State = SlotState::Idle;
+}
+
+} // photon
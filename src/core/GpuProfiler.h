@@ -0,0 +1,127 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_GPUPROFILER_H
+#define PHOTON_GPUPROFILER_H
+
+#include "PhotonCore.h"
+#include <webgpu/webgpu_cpp.h>
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace photon
+{
+
+struct GpuScopeStats
+{
+    std::string Name;
+    u32 SampleCount = 0;
+    f32 AverageMs = 0.f;
+    f32 MinMs = 0.f;
+    f32 MaxMs = 0.f;
+    f32 P50Ms = 0.f;
+    f32 P95Ms = 0.f;
+    f32 P99Ms = 0.f;
+};
+
+// Value at fraction (0 to 1) of an ascending, non-empty sample list, using the
+// nearest rank. Every timing report uses it, so their percentiles agree.
+f32 Percentile(const std::vector<f32>& sorted, f32 fraction);
+
+// Per-pass GPU timings from timestamp queries. Each profiled pass writes a
+// begin and end timestamp; at the end of the frame the queries are resolved
+// and copied into one of kFramesInFlight readback buffers, which is mapped
+// asynchronously and read whenever the map completes. A frame whose buffer is
+// still in flight simply goes unprofiled, so the CPU never waits on results.
+//
+// Passes sharing a name within a frame are summed into one scope. "Frame" is
+// the span from the first timestamp to the last.
+class GpuProfiler
+{
+public:
+    static constexpr u32 kMaxScopes = 32;
+    static constexpr u32 kFramesInFlight = 4;
+    // Samples kept per scope for averages and percentiles.
+    static constexpr u32 kHistorySize = 256;
+    static constexpr const char* kFrameScope = "Frame";
+
+    // Enabled only when device has the timestamp-query feature.
+    void Init(const wgpu::Device& device);
+    [[nodiscard]] bool IsEnabled() const;
+
+    void BeginFrame();
+
+    // Timestamp writes for the next pass, or null when profiling is off, the
+    // frame is skipped or it has run out of scopes. name must outlive the
+    // profiler, e.g. a string literal.
+    const wgpu::RenderPassTimestampWrites* RenderPass(const char* name);
+    const wgpu::ComputePassTimestampWrites* ComputePass(const char* name);
+
+    // Resolves this frame's queries; records into the frame's last encoder.
+    void EndFrame(wgpu::CommandEncoder& encoder);
+    // Starts the readback; call after the frame's commands were submitted.
+    void AfterSubmit();
+
+    // Most recent complete frame, 0 until the first readback lands.
+    [[nodiscard]] f32 GetFrameMs() const;
+    // Frames read back so far; GetFrameMs holds a new value when this grows.
+    [[nodiscard]] u64 GetResolvedFrameCount() const;
+    [[nodiscard]] std::vector<GpuScopeStats> GetStats() const;
+    bool WriteCsv(const std::string& path) const;
+
+private:
+    enum class SlotState
+    {
+        Idle,
+        Recording,
+        Resolved,
+        Mapping,
+    };
+
+    struct Slot
+    {
+        GpuProfiler* Profiler = nullptr;
+        wgpu::Buffer ReadbackBuffer;
+        SlotState State = SlotState::Idle;
+        std::vector<const char*> Names;
+    };
+
+    struct ScopeHistory
+    {
+        std::vector<f32> Samples;
+        u32 Next = 0;
+    };
+
+    // Index of the next scope's begin query, or -1 when none is available.
+    i32 AllocateScope(const char* name);
+    void AddSample(const std::string& name, f32 ms);
+
+    static void OnMapped(WGPUBufferMapAsyncStatus status, void* userdata);
+    void ReadSlot(Slot& slot);
+
+    wgpu::Device m_Device;
+    bool m_bEnabled = false;
+
+    wgpu::QuerySet m_QuerySet;
+    wgpu::Buffer m_ResolveBuffer;
+    std::array<Slot, kFramesInFlight> m_Slots;
+    u32 m_CurrentSlot = 0;
+    bool m_bFrameActive = false;
+    u64 m_Frame = 0;
+
+    std::array<wgpu::RenderPassTimestampWrites, kMaxScopes> m_RenderWrites{};
+    std::array<wgpu::ComputePassTimestampWrites, kMaxScopes> m_ComputeWrites{};
+
+    std::unordered_map<std::string, ScopeHistory> m_History;
+    // Names in order of first appearance, for stable reports.
+    std::vector<std::string> m_ScopeOrder;
+    f32 m_FrameMs = 0.f;
+    u64 m_ResolvedFrames = 0;
+};
+
+} // photon
+
+#endif //PHOTON_GPUPROFILER_H
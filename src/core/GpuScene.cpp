@@ -0,0 +1,365 @@
+//
+// Created by Raul Romero on 2026-10-18.
+//
+
+#include "GpuScene.h"
+#include "CpuProfiler.h"
+#include "Logger.h"
+#include "Reader.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+
+namespace photon
+{
+
+struct GpuDrawUniforms
+{
+    u32 VisibleOffset;
+    u32 pad[3];
+};
+
+void GpuScene::Init(const wgpu::Device& device)
+{
+    PHOTON_PROFILE_FUNCTION();
+    m_Device = device;
+
+    std::array<wgpu::BindGroupLayoutEntry, 7> cullEntries{};
+    cullEntries[0].binding = 0;
+    cullEntries[0].visibility = wgpu::ShaderStage::Compute;
+    cullEntries[0].buffer.type = wgpu::BufferBindingType::Uniform;
+    cullEntries[0].buffer.hasDynamicOffset = true;
+    cullEntries[0].buffer.minBindingSize = sizeof(GpuCullUniforms);
+
+    cullEntries[1].binding = 1;
+    cullEntries[1].visibility = wgpu::ShaderStage::Compute;
+    cullEntries[1].buffer.type = wgpu::BufferBindingType::ReadOnlyStorage;
+
+    cullEntries[2].binding = 2;
+    cullEntries[2].visibility = wgpu::ShaderStage::Compute;
+    cullEntries[2].buffer.type = wgpu::BufferBindingType::ReadOnlyStorage;
+
+    cullEntries[3].binding = 3;
+    cullEntries[3].visibility = wgpu::ShaderStage::Compute;
+    cullEntries[3].buffer.type = wgpu::BufferBindingType::Storage;
+
+    cullEntries[4].binding = 4;
+    cullEntries[4].visibility = wgpu::ShaderStage::Compute;
+    cullEntries[4].buffer.type = wgpu::BufferBindingType::Storage;
+
+    cullEntries[5].binding = 5;
+    cullEntries[5].visibility = wgpu::ShaderStage::Compute;
+    cullEntries[5].buffer.type = wgpu::BufferBindingType::Storage;
+
+    cullEntries[6].binding = 6;
+    cullEntries[6].visibility = wgpu::ShaderStage::Compute;
+    cullEntries[6].texture.sampleType = wgpu::TextureSampleType::UnfilterableFloat;
+    cullEntries[6].texture.viewDimension = wgpu::TextureViewDimension::e2D;
+
+    wgpu::BindGroupLayoutDescriptor cullLayoutDescriptor{.entryCount = cullEntries.size(),
+                                                         .entries = cullEntries.data()};
+    m_CullBindGroupLayout = m_Device.CreateBindGroupLayout(&cullLayoutDescriptor);
+
+    // Replaces the per-object group (2) of the mesh pipeline.
+    std::array<wgpu::BindGroupLayoutEntry, 3> drawEntries{};
+    drawEntries[0].binding = 1;
+    drawEntries[0].visibility = wgpu::ShaderStage::Vertex;
+    drawEntries[0].buffer.type = wgpu::BufferBindingType::Uniform;
+    drawEntries[0].buffer.hasDynamicOffset = true;
+    drawEntries[0].buffer.minBindingSize = sizeof(GpuDrawUniforms);
+
+    drawEntries[1].binding = 2;
+    drawEntries[1].visibility = wgpu::ShaderStage::Vertex;
+    drawEntries[1].buffer.type = wgpu::BufferBindingType::ReadOnlyStorage;
+
+    drawEntries[2].binding = 3;
+    drawEntries[2].visibility = wgpu::ShaderStage::Vertex;
+    drawEntries[2].buffer.type = wgpu::BufferBindingType::ReadOnlyStorage;
+
+    wgpu::BindGroupLayoutDescriptor drawLayoutDescriptor{.entryCount = drawEntries.size(),
+                                                         .entries = drawEntries.data()};
+    m_DrawBindGroupLayout = m_Device.CreateBindGroupLayout(&drawLayoutDescriptor);
+
+    wgpu::ShaderModuleWGSLDescriptor wgslDesc{};
+    wgslDesc.code = Reader::ReadTextFile("shaders/cull_instances.wgsl");
+
+    wgpu::ShaderModuleDescriptor shaderModuleDescriptor{.nextInChain = &wgslDesc};
+    shaderModuleDescriptor.label = "Instance Culling Shader Module";
+    wgpu::ShaderModule shaderModule = m_Device.CreateShaderModule(&shaderModuleDescriptor);
+
+    wgpu::PipelineLayoutDescriptor pipelineLayoutDescriptor{.bindGroupLayoutCount = 1,
+                                                            .bindGroupLayouts = &m_CullBindGroupLayout};
+
+    wgpu::ComputePipelineDescriptor pipelineDescriptor{
+        .label = "Instance Culling",
+        .layout = m_Device.CreatePipelineLayout(&pipelineLayoutDescriptor),
+        .compute = {.module = shaderModule, .entryPoint = "cs_main"},
+    };
+    m_CullPipeline = m_Device.CreateComputePipeline(&pipelineDescriptor);
+
+    // One slot per phase, selected with a dynamic offset.
+    m_CullUniformBuffer = CreateBuffer("Cull Uniforms", kPhaseCount * kDrawUniformStride,
+                                       wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst);
+}
+
+void GpuScene::SetDepthPyramid(const DepthPyramid& pyramid)
+{
+    m_Pyramid = &pyramid;
+}
+
+wgpu::Buffer GpuScene::CreateBuffer(const char* label, u64 size, wgpu::BufferUsage usage)
+{
+    wgpu::BufferDescriptor bufferDesc;
+    bufferDesc.label = label;
+    bufferDesc.size = (size + 3) & ~3;
+    bufferDesc.usage = usage;
+    bufferDesc.mappedAtCreation = false;
+    return m_Device.CreateBuffer(&bufferDesc);
+}
+
+GpuInstance GpuScene::MakeInstance(const m4& transform, const CMesh& mesh, u32 firstDraw)
+{
+    GpuInstance instance{};
+    instance.Model = transform;
+    instance.Sphere = TransformBoundingSphere(transform, mesh.boundsCenter, mesh.boundsRadius);
+    instance.FirstDraw = firstDraw;
+    instance.LodCount = static_cast<u32>(std::max<size_t>(mesh.lods.size(), 1));
+    return instance;
+}
+
+void GpuScene::Build(const std::vector<RenderObject>& objects, const std::vector<CMesh>& meshes)
+{
+    // Ordered so batches (and therefore draw order) are deterministic.
+    std::map<std::pair<u32, u32>, std::vector<u32>> groups;
+    for (u32 i = 0; i < objects.size(); ++i)
+    {
+        groups[{objects[i].MeshIndex, objects[i].MaterialIndex}].push_back(i);
+    }
+
+    m_Batches.clear();
+    m_FirstDraw.assign(objects.size(), 0);
+    m_InstanceCount = static_cast<u32>(objects.size());
+
+    // Filled for phase 0 and duplicated for phase 1 below.
+    std::vector<GpuDrawCommand> commands;
+    std::vector<u32> drawOffsets;
+    u32 visibleCount = 0;
+
+    for (const auto& [key, members] : groups)
+    {
+        const CMesh& mesh = meshes[key.first];
+        const u32 firstDraw = static_cast<u32>(m_Batches.size());
+
+        for (u32 lod = 0; lod < std::max<size_t>(mesh.lods.size(), 1); ++lod)
+        {
+            const MeshLod range = mesh.lods.empty() ? MeshLod{0, static_cast<u32>(mesh.indexCount)} : mesh.lods[lod];
+            m_Batches.push_back({key.first, key.second, lod});
+            commands.push_back({range.indexCount, 0, range.firstIndex, 0, 0});
+            drawOffsets.push_back(visibleCount);
+            visibleCount += static_cast<u32>(members.size());
+        }
+
+        for (u32 index : members)
+        {
+            m_FirstDraw[index] = firstDraw;
+        }
+    }
+
+    const size_t drawCount = commands.size();
+    commands.insert(commands.end(), commands.begin(), commands.end());
+    for (size_t i = 0; i < drawCount; ++i)
+    {
+        drawOffsets.push_back(drawOffsets[i] + visibleCount);
+    }
+    visibleCount *= kPhaseCount;
+
+    std::vector<GpuInstance> instances(objects.size());
+    for (u32 i = 0; i < objects.size(); ++i)
+    {
+        instances[i] = MakeInstance(objects[i].Transform, meshes[objects[i].MeshIndex], m_FirstDraw[i]);
+    }
+
+    std::vector<u8> drawUniformData(std::max<size_t>(drawOffsets.size(), 1) * kDrawUniformStride, 0);
+    for (u32 i = 0; i < drawOffsets.size(); ++i)
+    {
+        GpuDrawUniforms uniforms{.VisibleOffset = drawOffsets[i]};
+        memcpy(drawUniformData.data() + i * kDrawUniformStride, &uniforms, sizeof(uniforms));
+    }
+
+    // Storage bindings may not be empty, so every buffer holds at least one element.
+    const size_t instanceSlots = std::max<size_t>(instances.size(), 1);
+    const size_t drawSlots = std::max<size_t>(commands.size(), 1);
+    const size_t visibleSlots = std::max<size_t>(visibleCount, 1);
+
+    m_InstanceBuffer = CreateBuffer("Instances", instanceSlots * sizeof(GpuInstance),
+                                    wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst);
+    m_DrawOffsetBuffer = CreateBuffer("Draw Offsets", drawSlots * sizeof(u32),
+                                      wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst);
+    m_DrawCommandBuffer =
+        CreateBuffer("Draw Commands", drawSlots * sizeof(GpuDrawCommand),
+                     wgpu::BufferUsage::Storage | wgpu::BufferUsage::Indirect | wgpu::BufferUsage::CopyDst);
+    m_DrawCommandResetBuffer = CreateBuffer("Draw Command Reset", drawSlots * sizeof(GpuDrawCommand),
+                                            wgpu::BufferUsage::CopySrc | wgpu::BufferUsage::CopyDst);
+    m_VisibleBuffer = CreateBuffer("Visible Instances", visibleSlots * sizeof(u32), wgpu::BufferUsage::Storage);
+    // Zero-initialized, so nothing counts as visible last frame after a rebuild.
+    m_VisibilityBuffer = CreateBuffer("Instance Visibility", instanceSlots * sizeof(u32), wgpu::BufferUsage::Storage);
+    m_DrawUniformBuffer = CreateBuffer("Draw Uniforms", drawUniformData.size(),
+                                       wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst);
+
+    wgpu::Queue queue = m_Device.GetQueue();
+    if (!instances.empty())
+    {
+        queue.WriteBuffer(m_InstanceBuffer, 0, instances.data(), instances.size() * sizeof(GpuInstance));
+        RenderStats::Instance().CountBufferUpload(instances.size() * sizeof(GpuInstance));
+    }
+    if (!commands.empty())
+    {
+        queue.WriteBuffer(m_DrawOffsetBuffer, 0, drawOffsets.data(), drawOffsets.size() * sizeof(u32));
+        RenderStats::Instance().CountBufferUpload(drawOffsets.size() * sizeof(u32));
+        queue.WriteBuffer(m_DrawCommandResetBuffer, 0, commands.data(), commands.size() * sizeof(GpuDrawCommand));
+        RenderStats::Instance().CountBufferUpload(commands.size() * sizeof(GpuDrawCommand));
+    }
+    queue.WriteBuffer(m_DrawUniformBuffer, 0, drawUniformData.data(), drawUniformData.size());
+    RenderStats::Instance().CountBufferUpload(drawUniformData.size());
+
+    CreateBindGroups();
+}
+
+void GpuScene::CreateBindGroups()
+{
+    if (!m_Pyramid)
+    {
+        LogError("GpuScene needs a depth pyramid before Build");
+        return;
+    }
+
+    std::array<wgpu::BindGroupEntry, 7> cullEntries{};
+    cullEntries[0] = {.binding = 0, .buffer = m_CullUniformBuffer, .size = sizeof(GpuCullUniforms)};
+    cullEntries[1] = {.binding = 1, .buffer = m_InstanceBuffer, .size = m_InstanceBuffer.GetSize()};
+    cullEntries[2] = {.binding = 2, .buffer = m_DrawOffsetBuffer, .size = m_DrawOffsetBuffer.GetSize()};
+    cullEntries[3] = {.binding = 3, .buffer = m_DrawCommandBuffer, .size = m_DrawCommandBuffer.GetSize()};
+    cullEntries[4] = {.binding = 4, .buffer = m_VisibleBuffer, .size = m_VisibleBuffer.GetSize()};
+    cullEntries[5] = {.binding = 5, .buffer = m_VisibilityBuffer, .size = m_VisibilityBuffer.GetSize()};
+    cullEntries[6] = {.binding = 6, .textureView = m_Pyramid->GetView()};
+
+    wgpu::BindGroupDescriptor cullDescriptor{.layout = m_CullBindGroupLayout,
+                                             .entryCount = cullEntries.size(),
+                                             .entries = cullEntries.data()};
+    m_CullBindGroup = m_Device.CreateBindGroup(&cullDescriptor);
+
+    std::array<wgpu::BindGroupEntry, 3> drawEntries{};
+    drawEntries[0] = {.binding = 1, .buffer = m_DrawUniformBuffer, .size = sizeof(GpuDrawUniforms)};
+    drawEntries[1] = {.binding = 2, .buffer = m_InstanceBuffer, .size = m_InstanceBuffer.GetSize()};
+    drawEntries[2] = {.binding = 3, .buffer = m_VisibleBuffer, .size = m_VisibleBuffer.GetSize()};
+
+    wgpu::BindGroupDescriptor drawDescriptor{.layout = m_DrawBindGroupLayout,
+                                             .entryCount = drawEntries.size(),
+                                             .entries = drawEntries.data()};
+    m_DrawBindGroup = m_Device.CreateBindGroup(&drawDescriptor);
+}
+
+void GpuScene::UpdateInstances(u32 first, u32 count, const std::vector<RenderObject>& objects,
+                               const std::vector<CMesh>& meshes)
+{
+    if (first >= m_InstanceCount)
+    {
+        return;
+    }
+    count = std::min(count, m_InstanceCount - first);
+
+    m_InstanceUploadData.resize(count);
+    for (u32 i = 0; i < count; ++i)
+    {
+        const RenderObject& object = objects[first + i];
+        m_InstanceUploadData[i] = MakeInstance(object.Transform, meshes[object.MeshIndex], m_FirstDraw[first + i]);
+    }
+
+    const size_t size = count * sizeof(GpuInstance);
+    m_Device.GetQueue().WriteBuffer(m_InstanceBuffer, first * sizeof(GpuInstance), m_InstanceUploadData.data(), size);
+    RenderStats::Instance().CountBufferUpload(size);
+}
+
+void GpuScene::SetView(const Frustum& frustum, const m4& viewProjection, const v3f& cameraPosition)
+{
+    if (m_InstanceCount == 0)
+    {
+        return;
+    }
+
+    GpuCullUniforms uniforms{};
+    std::copy(std::begin(frustum.Planes), std::end(frustum.Planes), uniforms.Planes);
+    uniforms.ViewProjection = viewProjection;
+    uniforms.CameraPosition = cameraPosition;
+    uniforms.InstanceCount = m_InstanceCount;
+    uniforms.LodDistance = LodDistance;
+    uniforms.DrawCount = static_cast<u32>(m_Batches.size());
+    uniforms.PyramidMipCount = m_Pyramid->GetMipCount();
+    uniforms.PyramidSize = m_Pyramid->GetSize();
+
+    for (u32 phase = 0; phase < kPhaseCount; ++phase)
+    {
+        uniforms.Phase = phase;
+        m_Device.GetQueue().WriteBuffer(m_CullUniformBuffer, phase * kDrawUniformStride, &uniforms,
+                                        sizeof(GpuCullUniforms));
+        RenderStats::Instance().CountBufferUpload(sizeof(GpuCullUniforms));
+    }
+}
+
+void GpuScene::Cull(wgpu::CommandEncoder& encoder, u32 phase, const wgpu::ComputePassTimestampWrites* timestampWrites)
+{
+    if (m_InstanceCount == 0)
+    {
+        return;
+    }
+
+    const u32 uniformOffset = phase * kDrawUniformStride;
+    if (phase == 0)
+    {
+        // Restore the commands with zero instances before the cull passes append to them.
+        encoder.CopyBufferToBuffer(m_DrawCommandResetBuffer, 0, m_DrawCommandBuffer, 0,
+                                   m_DrawCommandBuffer.GetSize());
+    }
+
+    wgpu::ComputePassDescriptor passDescriptor{.label = phase == 0 ? "Instance Culling (Previous Visible)"
+                                                                   : "Instance Culling (Occlusion)",
+                                               .timestampWrites = timestampWrites};
+    wgpu::ComputePassEncoder pass = encoder.BeginComputePass(&passDescriptor);
+    pass.SetPipeline(m_CullPipeline);
+    pass.SetBindGroup(0, m_CullBindGroup, 1, &uniformOffset);
+    pass.DispatchWorkgroups((m_InstanceCount + kWorkgroupSize - 1) / kWorkgroupSize);
+    pass.End();
+}
+
+const std::vector<GpuDrawBatch>& GpuScene::GetBatches() const
+{
+    return m_Batches;
+}
+
+const wgpu::BindGroupLayout& GpuScene::GetDrawBindGroupLayout() const
+{
+    return m_DrawBindGroupLayout;
+}
+
+const wgpu::BindGroup& GpuScene::GetDrawBindGroup() const
+{
+    return m_DrawBindGroup;
+}
+
+const wgpu::Buffer& GpuScene::GetDrawCommandBuffer() const
+{
+    return m_DrawCommandBuffer;
+}
+
+u32 GpuScene::GetDrawIndex(u32 phase, u32 batch) const
+{
+    return phase * static_cast<u32>(m_Batches.size()) + batch;
+}
+
+u32 GpuScene::GetInstanceCount() const
+{
+    return m_InstanceCount;
+}
+
+} // photon
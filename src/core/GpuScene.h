@@ -0,0 +1,146 @@
+//
+// Created by Raul Romero on 2026-10-18.
+//
+
+#ifndef PHOTON_GPUSCENE_H
+#define PHOTON_GPUSCENE_H
+
+#include "CMesh.h"
+#include "DepthPyramid.h"
+#include "FrustumCuller.h"
+#include "RenderObject.h"
+#include <webgpu/webgpu_cpp.h>
+#include <vector>
+
+namespace photon
+{
+
+// Mirrors `Instance` in cull_instances.wgsl and pbr_mat.wgsl.
+struct GpuInstance
+{
+    m4 Model;
+    v4f Sphere;
+    u32 FirstDraw;
+    u32 LodCount;
+    u32 pad[2];
+};
+
+// Mirrors `DrawIndexedIndirect` argument layout.
+struct GpuDrawCommand
+{
+    u32 IndexCount;
+    u32 InstanceCount;
+    u32 FirstIndex;
+    i32 BaseVertex;
+    u32 FirstInstance;
+};
+
+struct GpuCullUniforms
+{
+    v4f Planes[6];
+    m4 ViewProjection;
+    v3f CameraPosition;
+    u32 InstanceCount;
+    // Distance, in multiples of an instance's bounding radius, covered by
+    // each level of detail.
+    f32 LodDistance;
+    u32 Phase;
+    u32 DrawCount;
+    u32 PyramidMipCount;
+    v2f PyramidSize;
+    f32 pad[2];
+};
+
+// One indirect draw: every visible instance of a mesh/material pair at one
+// level of detail.
+struct GpuDrawBatch
+{
+    u32 MeshIndex;
+    u32 MaterialIndex;
+    u32 LodIndex;
+};
+
+// GPU-resident copy of the scene. Instances and their bounds live in storage
+// buffers, a compute pass frustum culls them and picks a level of detail, and
+// fills DrawIndexedIndirect arguments plus per-draw visible instance lists.
+// CPU cost per frame only depends on the number of batches.
+//
+// Occlusion culling runs in two phases, each with its own set of draws:
+// phase 0 draws what was visible last frame, then phase 1 re-tests every
+// instance against a depth pyramid built from phase 0's depth, draws the newly
+// visible ones and records visibility for the next frame.
+class GpuScene
+{
+public:
+    static constexpr u32 kDrawUniformStride = 256;
+    static constexpr u32 kWorkgroupSize = 64;
+    static constexpr u32 kPhaseCount = 2;
+
+    void Init(const wgpu::Device& device);
+
+    // Pyramid tested against in phase 1; must be set before Build.
+    void SetDepthPyramid(const DepthPyramid& pyramid);
+
+    // Rebuilds batches and every buffer from scratch. Needed whenever objects
+    // are added or change mesh or material.
+    void Build(const std::vector<RenderObject>& objects, const std::vector<CMesh>& meshes);
+
+    // Uploads the transforms and bounds of objects [first, first + count) in
+    // one write. Objects past the last build are ignored.
+    void UpdateInstances(u32 first, u32 count, const std::vector<RenderObject>& objects,
+                         const std::vector<CMesh>& meshes);
+
+    // Uploads the view both culling phases test against. The dispatches read it
+    // when they execute, so it may be set after Cull was recorded, as long as
+    // it is before the submit.
+    void SetView(const Frustum& frustum, const m4& viewProjection, const v3f& cameraPosition);
+
+    // Records the culling dispatch for phase; must precede the render pass that
+    // draws it. Phase 0 also resets the draws of both phases, and phase 1 must
+    // follow the pyramid build.
+    void Cull(wgpu::CommandEncoder& encoder, u32 phase,
+              const wgpu::ComputePassTimestampWrites* timestampWrites = nullptr);
+
+    [[nodiscard]] const std::vector<GpuDrawBatch>& GetBatches() const;
+    [[nodiscard]] const wgpu::BindGroupLayout& GetDrawBindGroupLayout() const;
+    [[nodiscard]] const wgpu::BindGroup& GetDrawBindGroup() const;
+    [[nodiscard]] const wgpu::Buffer& GetDrawCommandBuffer() const;
+    // Index of batch's draw (command and draw uniform slot) in phase.
+    [[nodiscard]] u32 GetDrawIndex(u32 phase, u32 batch) const;
+    [[nodiscard]] u32 GetInstanceCount() const;
+
+    f32 LodDistance = 16.f;
+
+private:
+    static GpuInstance MakeInstance(const m4& transform, const CMesh& mesh, u32 firstDraw);
+    wgpu::Buffer CreateBuffer(const char* label, u64 size, wgpu::BufferUsage usage);
+    void CreateBindGroups();
+
+    wgpu::Device m_Device;
+
+    wgpu::ComputePipeline m_CullPipeline;
+    wgpu::BindGroupLayout m_CullBindGroupLayout;
+    wgpu::BindGroup m_CullBindGroup;
+    wgpu::BindGroupLayout m_DrawBindGroupLayout;
+    wgpu::BindGroup m_DrawBindGroup;
+
+    wgpu::Buffer m_CullUniformBuffer;
+    wgpu::Buffer m_InstanceBuffer;
+    wgpu::Buffer m_DrawOffsetBuffer;
+    wgpu::Buffer m_DrawCommandBuffer;
+    wgpu::Buffer m_DrawCommandResetBuffer;
+    wgpu::Buffer m_VisibleBuffer;
+    wgpu::Buffer m_VisibilityBuffer;
+    wgpu::Buffer m_DrawUniformBuffer;
+
+    const DepthPyramid* m_Pyramid = nullptr;
+
+    std::vector<GpuDrawBatch> m_Batches;
+    std::vector<u32> m_FirstDraw;
+    std::vector<GpuInstance> m_InstanceUploadData;
+    u32 m_InstanceCount = 0;
+};
+
+} // photon
+
+#endif //PHOTON_GPUSCENE_H
@@ -0,0 +1,188 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "InputRecorder.h"
+#include "Logger.h"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <json.hpp>
+
+using json = nlohmann::json;
+
+namespace photon
+{
+
+namespace
+{
+
+constexpr u32 kFormatVersion = 1;
+
+// Indexed by EInputEventType.
+constexpr std::array kEventTypeNames{"key_down",   "key_up",    "mouse_down", "mouse_up",
+                                     "mouse_over", "mouse_out", "slider",     "scroll"};
+
+bool ParseEventType(const std::string& name, EInputEventType& type)
+{
+    const auto found = std::find(kEventTypeNames.begin(), kEventTypeNames.end(), name);
+    if (found == kEventTypeNames.end())
+    {
+        return false;
+    }
+    type = static_cast<EInputEventType>(found - kEventTypeNames.begin());
+    return true;
+}
+
+} // namespace
+
+void InputRecorder::StartRecording(const std::string& path, const std::string& sceneName)
+{
+    m_bRecording = true;
+    m_bReplaying = false;
+    m_Path = path;
+    m_SceneName = sceneName;
+    m_Timestep = kDefaultTimestep;
+    m_FrameCount = 0;
+    m_Events.clear();
+}
+
+bool InputRecorder::LoadReplay(const std::string& path)
+{
+    std::ifstream file(path);
+    const json recording = json::parse(file, nullptr, false);
+    if (!file || recording.is_discarded())
+    {
+        LogError("Could not read input recording %s", path.c_str());
+        return false;
+    }
+    if (recording.value("version", 0u) != kFormatVersion)
+    {
+        LogError("%s is not a version %u input recording", path.c_str(), kFormatVersion);
+        return false;
+    }
+
+    std::vector<InputEvent> events;
+    for (const json& entry : recording.value("events", json::array()))
+    {
+        InputEvent event{.Frame = entry.value("frame", u64{0}),
+                         .bLate = entry.value("late", false),
+                         .Name = entry.value("name", std::string()),
+                         .Button = entry.value("button", 0),
+                         .X = entry.value("x", 0),
+                         .Y = entry.value("y", 0),
+                         .Value = entry.value("value", 0.f)};
+        if (!ParseEventType(entry.value("type", std::string()), event.Type))
+        {
+            LogError("Unknown input event type in %s", path.c_str());
+            return false;
+        }
+        events.push_back(std::move(event));
+    }
+    // Stable, so events of one frame keep their order.
+    std::stable_sort(events.begin(), events.end(),
+                     [](const InputEvent& a, const InputEvent& b) { return a.Frame < b.Frame; });
+
+    m_bRecording = false;
+    m_bReplaying = true;
+    m_Path = path;
+    m_SceneName = recording.value("scene", std::string());
+    m_Timestep = recording.value("timestep", kDefaultTimestep);
+    m_FrameCount = recording.value("frames", u64{0});
+    m_Events = std::move(events);
+    m_Cursor = 0;
+    LogInfo("Replaying %zu input events over %llu frames from %s", m_Events.size(), m_FrameCount,
+            path.c_str());
+    return true;
+}
+
+void InputRecorder::Record(const InputEvent& event)
+{
+    if (m_bRecording)
+    {
+        m_Events.push_back(event);
+    }
+}
+
+std::span<const InputEvent> InputRecorder::BeginFrame(u64 frame)
+{
+    if (m_bRecording)
+    {
+        m_FrameCount = std::max(m_FrameCount, frame + 1);
+    }
+    if (!m_bReplaying)
+    {
+        return {};
+    }
+
+    while (m_Cursor < m_Events.size() && m_Events[m_Cursor].Frame < frame)
+    {
+        ++m_Cursor;
+    }
+    const size_t first = m_Cursor;
+    while (m_Cursor < m_Events.size() && m_Events[m_Cursor].Frame == frame)
+    {
+        ++m_Cursor;
+    }
+    return std::span(m_Events).subspan(first, m_Cursor - first);
+}
+
+bool InputRecorder::Save() const
+{
+    if (!m_bRecording)
+    {
+        return true;
+    }
+
+    json events = json::array();
+    for (const InputEvent& event : m_Events)
+    {
+        json entry = {{"frame", event.Frame}, {"type", kEventTypeNames[static_cast<size_t>(event.Type)]}};
+        if (event.bLate)
+        {
+            entry["late"] = true;
+        }
+        switch (event.Type)
+        {
+        case EInputEventType::KeyDown:
+        case EInputEventType::KeyUp:
+            entry["name"] = event.Name;
+            break;
+        case EInputEventType::MouseDown:
+        case EInputEventType::MouseUp:
+            entry["button"] = event.Button;
+            [[fallthrough]];
+        case EInputEventType::MouseOver:
+        case EInputEventType::MouseOut:
+            entry["x"] = event.X;
+            entry["y"] = event.Y;
+            break;
+        case EInputEventType::Slider:
+            entry["name"] = event.Name;
+            [[fallthrough]];
+        case EInputEventType::Scroll:
+            entry["value"] = event.Value;
+            break;
+        }
+        events.push_back(std::move(entry));
+    }
+
+    std::ofstream file(m_Path);
+    if (!file)
+    {
+        LogError("Could not write input recording %s", m_Path.c_str());
+        return false;
+    }
+    file << json{{"version", kFormatVersion},
+                 {"scene", m_SceneName},
+                 {"timestep", m_Timestep},
+                 {"frames", m_FrameCount},
+                 {"events", events}}
+                .dump(2)
+         << '\n';
+    LogInfo("Recorded %zu input events over %llu frames to %s", m_Events.size(), m_FrameCount,
+            m_Path.c_str());
+    return true;
+}
+
+} // photon
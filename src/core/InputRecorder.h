@@ -0,0 +1,86 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_INPUTRECORDER_H
+#define PHOTON_INPUTRECORDER_H
+
+#include "PhotonCore.h"
+#include <span>
+#include <string>
+#include <vector>
+
+namespace photon
+{
+
+enum class EInputEventType
+{
+    KeyDown,
+    KeyUp,
+    MouseDown,
+    MouseUp,
+    MouseOver,
+    MouseOut,
+    Slider,
+    Scroll
+};
+
+struct InputEvent
+{
+    // Frame that first sees the event.
+    u64 Frame = 0;
+    // Sampled after the frame was encoded, just before its submission.
+    bool bLate = false;
+    EInputEventType Type = EInputEventType::KeyDown;
+    // Key for key events, element id for slider changes.
+    std::string Name;
+    i32 Button = 0;
+    i32 X = 0;
+    i32 Y = 0;
+    // Slider value or scroll delta.
+    f32 Value = 0.f;
+};
+
+// Captures a session's input against frame numbers and plays it back, so a
+// performance problem seen interactively can be rendered again frame for
+// frame. Recording and replay both advance time by a fixed step per frame
+// instead of following the wall clock; with the same scene, size and adapter
+// a replay renders the frames the recorded session did.
+class InputRecorder
+{
+public:
+    static constexpr f64 kDefaultTimestep = 1.0 / 60.0;
+
+    void StartRecording(const std::string& path, const std::string& sceneName);
+    bool LoadReplay(const std::string& path);
+
+    [[nodiscard]] bool IsRecording() const { return m_bRecording; }
+    [[nodiscard]] bool IsReplaying() const { return m_bReplaying; }
+    [[nodiscard]] f64 GetTimestep() const { return m_Timestep; }
+    // Frames the recording spans, or 0 when nothing is loaded.
+    [[nodiscard]] u64 GetFrameCount() const { return m_FrameCount; }
+    [[nodiscard]] const std::string& GetSceneName() const { return m_SceneName; }
+
+    // Appends event while recording; frame numbers must not decrease.
+    void Record(const InputEvent& event);
+    // Called once per frame before input is consumed. While replaying,
+    // returns the events recorded for frame in their original order.
+    std::span<const InputEvent> BeginFrame(u64 frame);
+    // Writes the recording, if one was started.
+    bool Save() const;
+
+private:
+    bool m_bRecording = false;
+    bool m_bReplaying = false;
+    std::string m_Path;
+    std::string m_SceneName;
+    f64 m_Timestep = kDefaultTimestep;
+    u64 m_FrameCount = 0;
+    std::vector<InputEvent> m_Events;
+    // First replay event not yet returned by BeginFrame.
+    size_t m_Cursor = 0;
+};
+
+} // photon
+
+#endif //PHOTON_INPUTRECORDER_H
@@ -0,0 +1,170 @@
+//
+// Created by Raul Romero on 2026-10-18.
+//
+
+#include "PipelineCache.h"
+#include "CpuProfiler.h"
+#include "Logger.h"
+#include "Reader.h"
+#include <string_view>
+
+namespace photon
+{
+
+namespace
+{
+
+template <typename T> void AppendBytes(std::string& key, const T& value)
+{
+    key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendString(std::string& key, const char* value)
+{
+    const std::string_view view = value ? value : "";
+    AppendBytes(key, view.size());
+    key.append(view);
+}
+
+} // namespace
+
+void PipelineCache::Init(const wgpu::Device& device)
+{
+    PHOTON_PROFILE_FUNCTION();
+    m_Device = device;
+}
+
+std::string PipelineCache::MakeKey(const RenderPipelineDesc& desc)
+{
+    std::string key;
+    AppendString(key, desc.ShaderPath.c_str());
+    AppendString(key, desc.VertexEntryPoint);
+    AppendString(key, desc.FragmentEntryPoint);
+
+    AppendBytes(key, desc.VertexBuffers.size());
+    for (const wgpu::VertexBufferLayout& buffer : desc.VertexBuffers)
+    {
+        AppendBytes(key, buffer.arrayStride);
+        AppendBytes(key, buffer.stepMode);
+        AppendBytes(key, buffer.attributeCount);
+        for (u32 i = 0; i < buffer.attributeCount; ++i)
+        {
+            const wgpu::VertexAttribute& attribute = buffer.attributes[i];
+            AppendBytes(key, attribute.format);
+            AppendBytes(key, attribute.offset);
+            AppendBytes(key, attribute.shaderLocation);
+        }
+    }
+
+    AppendBytes(key, desc.ColorFormat);
+    AppendBytes(key, desc.DepthStencil.format);
+    AppendBytes(key, desc.DepthStencil.depthWriteEnabled);
+    AppendBytes(key, desc.DepthStencil.depthCompare);
+    AppendBytes(key, desc.DepthStencil.depthBias);
+    AppendBytes(key, desc.DepthStencil.depthBiasSlopeScale);
+    AppendBytes(key, desc.DepthStencil.depthBiasClamp);
+    AppendBytes(key, desc.Layout.Get());
+
+    return key;
+}
+
+PipelineHandle PipelineCache::Request(const RenderPipelineDesc& desc)
+{
+    std::string key = MakeKey(desc);
+    auto found = m_Handles.find(key);
+    if (found != m_Handles.end())
+    {
+        return found->second;
+    }
+
+    const PipelineHandle handle = m_NextHandle++;
+    m_Handles.emplace(std::move(key), handle);
+    Entry& entry = m_Entries[handle];
+    entry.label = desc.Label ? desc.Label : desc.ShaderPath;
+
+    wgpu::ShaderModule shaderModule = GetShaderModule(desc.ShaderPath);
+
+    wgpu::ColorTargetState colorTargetState{.format = desc.ColorFormat};
+
+    wgpu::FragmentState fragmentState{.module = shaderModule,
+                                      .entryPoint = desc.FragmentEntryPoint,
+                                      .targetCount = 1,
+                                      .targets = &colorTargetState};
+
+    wgpu::RenderPipelineDescriptor descriptor{
+        .label = entry.label.c_str(),
+        .layout = desc.Layout,
+        .vertex = {.module = shaderModule, .entryPoint = desc.VertexEntryPoint},
+        .depthStencil = desc.DepthStencil.format == wgpu::TextureFormat::Undefined ? nullptr : &desc.DepthStencil,
+        .fragment = desc.ColorFormat == wgpu::TextureFormat::Undefined ? nullptr : &fragmentState,
+    };
+
+    descriptor.vertex.bufferCount = desc.VertexBuffers.size();
+    descriptor.vertex.buffers = desc.VertexBuffers.data();
+
+    ++m_PendingCount;
+    m_Device.CreateRenderPipelineAsync(&descriptor, OnPipelineCreated, new PendingRequest{this, handle});
+
+    return handle;
+}
+
+void PipelineCache::OnPipelineCreated(WGPUCreatePipelineAsyncStatus status, WGPURenderPipeline pipeline,
+                                      const char* message, void* userdata)
+{
+    PendingRequest* request = static_cast<PendingRequest*>(userdata);
+    PipelineCache* cache = request->cache;
+    Entry& entry = cache->m_Entries[request->handle];
+    delete request;
+
+    entry.bPending = false;
+    --cache->m_PendingCount;
+
+    if (status != WGPUCreatePipelineAsyncStatus_Success)
+    {
+        LogWarning("Failed to create pipeline %s: %s", entry.label.c_str(), message ? message : "");
+        return;
+    }
+
+    entry.pipeline = wgpu::RenderPipeline::Acquire(pipeline);
+}
+
+wgpu::RenderPipeline PipelineCache::Get(PipelineHandle handle) const
+{
+    auto it = m_Entries.find(handle);
+    if (it == m_Entries.end())
+    {
+        return nullptr;
+    }
+    return it->second.pipeline;
+}
+
+bool PipelineCache::IsReady(PipelineHandle handle) const
+{
+    return static_cast<bool>(Get(handle));
+}
+
+u32 PipelineCache::PendingCount() const
+{
+    return m_PendingCount;
+}
+
+wgpu::ShaderModule PipelineCache::GetShaderModule(const std::string& path)
+{
+    auto it = m_ShaderModules.find(path);
+    if (it != m_ShaderModules.end())
+    {
+        return it->second;
+    }
+
+    wgpu::ShaderModuleWGSLDescriptor wgslDesc{};
+    wgslDesc.code = Reader::ReadTextFile(path);
+
+    wgpu::ShaderModuleDescriptor shaderModuleDescriptor{.nextInChain = &wgslDesc};
+    shaderModuleDescriptor.label = path.c_str();
+    wgpu::ShaderModule shaderModule = m_Device.CreateShaderModule(&shaderModuleDescriptor);
+
+    m_ShaderModules[path] = shaderModule;
+    return shaderModule;
+}
+
+} // photon
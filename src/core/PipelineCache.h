@@ -0,0 +1,83 @@
+//
+// Created by Raul Romero on 2026-10-18.
+//
+
+#ifndef PHOTON_PIPELINECACHE_H
+#define PHOTON_PIPELINECACHE_H
+
+#include "PhotonCore.h"
+#include <webgpu/webgpu_cpp.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace photon
+{
+
+// Everything that identifies a render pipeline. Vertex attribute arrays are
+// owned by the caller and only need to live until Request returns.
+struct RenderPipelineDesc
+{
+    const char* Label = nullptr;
+    std::string ShaderPath;
+    // Entry points may be left null when the module has a single one per stage.
+    const char* VertexEntryPoint = nullptr;
+    const char* FragmentEntryPoint = nullptr;
+    std::vector<wgpu::VertexBufferLayout> VertexBuffers{};
+    // Undefined builds a depth-only pipeline without a fragment stage.
+    wgpu::TextureFormat ColorFormat = wgpu::TextureFormat::BGRA8Unorm;
+    // An Undefined format builds a pipeline without depth.
+    wgpu::DepthStencilState DepthStencil{};
+    wgpu::PipelineLayout Layout;
+};
+
+typedef u64 PipelineHandle;
+
+class PipelineCache
+{
+public:
+    void Init(const wgpu::Device& device);
+
+    // Returns the handle for desc, starting an asynchronous build the first time an
+    // identical description is seen. Handles are never 0.
+    PipelineHandle Request(const RenderPipelineDesc& desc);
+
+    // Null until the pipeline behind handle has finished building.
+    [[nodiscard]] wgpu::RenderPipeline Get(PipelineHandle handle) const;
+    [[nodiscard]] bool IsReady(PipelineHandle handle) const;
+    [[nodiscard]] u32 PendingCount() const;
+
+    // Every field of desc that affects the pipeline, serialized so that two
+    // descriptions get the same key exactly when they build the same pipeline.
+    static std::string MakeKey(const RenderPipelineDesc& desc);
+
+private:
+    struct Entry
+    {
+        wgpu::RenderPipeline pipeline;
+        std::string label;
+        bool bPending = true;
+    };
+
+    struct PendingRequest
+    {
+        PipelineCache* cache;
+        PipelineHandle handle;
+    };
+
+    wgpu::ShaderModule GetShaderModule(const std::string& path);
+
+    static void OnPipelineCreated(WGPUCreatePipelineAsyncStatus status, WGPURenderPipeline pipeline,
+                                  const char* message, void* userdata);
+
+    wgpu::Device m_Device;
+    std::unordered_map<std::string, PipelineHandle> m_Handles;
+    std::unordered_map<PipelineHandle, Entry> m_Entries;
+    PipelineHandle m_NextHandle = 1;
+    std::unordered_map<std::string, wgpu::ShaderModule> m_ShaderModules;
+    u32 m_PendingCount = 0;
+};
+
+} // photon
+
+#endif //PHOTON_PIPELINECACHE_H
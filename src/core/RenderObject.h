@@ -0,0 +1,26 @@
+//
+// Created by Raul Romero on 2026-10-18.
+//
+
+#ifndef PHOTON_RENDEROBJECT_H
+#define PHOTON_RENDEROBJECT_H
+
+#include "PhotonCore.h"
+
+namespace photon
+{
+
+struct RenderObject
+{
+    u32 MeshIndex = 0;
+    u32 MaterialIndex = 0;
+    m4 Transform = m4(1.0f);
+    bool bDirty = true;
+    // Static objects are recorded once into a render bundle. Their transform
+    // may still change, but adding or removing them rebuilds the bundle.
+    bool bStatic = false;
+};
+
+} // photon
+
+#endif //PHOTON_RENDEROBJECT_H
@@ -0,0 +1,100 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "RenderStats.h"
+#include <algorithm>
+
+namespace photon
+{
+
+FrameStats& FrameStats::operator+=(const FrameStats& other)
+{
+    DrawCalls += other.DrawCalls;
+    IndirectDrawCalls += other.IndirectDrawCalls;
+    Triangles += other.Triangles;
+    PipelineSwitches += other.PipelineSwitches;
+    BindGroupSwitches += other.BindGroupSwitches;
+    BufferBytesUploaded += other.BufferBytesUploaded;
+    TextureBytesUploaded += other.TextureBytesUploaded;
+    CommandBuffersSubmitted += other.CommandBuffersSubmitted;
+    return *this;
+}
+
+RenderStats& RenderStats::Instance()
+{
+    static RenderStats stats;
+    return stats;
+}
+
+FrameStats& RenderStats::GetCurrent()
+{
+    return m_Current;
+}
+
+void RenderStats::EndFrame()
+{
+    m_History[m_Next] = m_Current;
+    m_Next = (m_Next + 1) % kHistorySize;
+    m_Count = std::min(m_Count + 1, kHistorySize);
+    m_Current = {};
+}
+
+const FrameStats& RenderStats::GetLast() const
+{
+    return m_History[(m_Next + kHistorySize - 1) % kHistorySize];
+}
+
+std::vector<FrameStats> RenderStats::GetHistory() const
+{
+    std::vector<FrameStats> history;
+    history.reserve(m_Count);
+    const u32 first = (m_Next + kHistorySize - m_Count) % kHistorySize;
+    for (u32 i = 0; i < m_Count; ++i)
+    {
+        history.push_back(m_History[(first + i) % kHistorySize]);
+    }
+    return history;
+}
+
+FrameStats RenderStats::GetAverage() const
+{
+    FrameStats average;
+    if (m_Count == 0)
+    {
+        return average;
+    }
+
+    for (const FrameStats& frame : GetHistory())
+    {
+        average += frame;
+    }
+    average.DrawCalls /= m_Count;
+    average.IndirectDrawCalls /= m_Count;
+    average.Triangles /= m_Count;
+    average.PipelineSwitches /= m_Count;
+    average.BindGroupSwitches /= m_Count;
+    average.BufferBytesUploaded /= m_Count;
+    average.TextureBytesUploaded /= m_Count;
+    average.CommandBuffersSubmitted /= m_Count;
+    return average;
+}
+
+FrameStats RenderStats::GetPeak() const
+{
+    FrameStats peak;
+    for (const FrameStats& frame : GetHistory())
+    {
+        peak.DrawCalls = std::max(peak.DrawCalls, frame.DrawCalls);
+        peak.IndirectDrawCalls = std::max(peak.IndirectDrawCalls, frame.IndirectDrawCalls);
+        peak.Triangles = std::max(peak.Triangles, frame.Triangles);
+        peak.PipelineSwitches = std::max(peak.PipelineSwitches, frame.PipelineSwitches);
+        peak.BindGroupSwitches = std::max(peak.BindGroupSwitches, frame.BindGroupSwitches);
+        peak.BufferBytesUploaded = std::max(peak.BufferBytesUploaded, frame.BufferBytesUploaded);
+        peak.TextureBytesUploaded = std::max(peak.TextureBytesUploaded, frame.TextureBytesUploaded);
+        peak.CommandBuffersSubmitted = std::max(peak.CommandBuffersSubmitted, frame.CommandBuffersSubmitted);
+    }
+    return peak;
+}
+
+} // photon
@@ -0,0 +1,74 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_RENDERSTATS_H
+#define PHOTON_RENDERSTATS_H
+
+#include "PhotonCore.h"
+#include <array>
+#include <vector>
+
+namespace photon
+{
+
+struct FrameStats
+{
+    u32 DrawCalls = 0;
+    // GPU-driven draws; their triangles are decided on the GPU and not counted.
+    u32 IndirectDrawCalls = 0;
+    u64 Triangles = 0;
+    u32 PipelineSwitches = 0;
+    u32 BindGroupSwitches = 0;
+    u64 BufferBytesUploaded = 0;
+    u64 TextureBytesUploaded = 0;
+    u32 CommandBuffersSubmitted = 0;
+
+    FrameStats& operator+=(const FrameStats& other);
+};
+
+// Counters for the frame being recorded plus a ring of finished frames. A
+// frame runs from one EndFrame to the next, so uploads made while loading land
+// in the first frame. Counting is plain increments on the render thread.
+class RenderStats
+{
+public:
+    static constexpr u32 kHistorySize = 240;
+
+    static RenderStats& Instance();
+
+    void CountDraw(u32 indexCount, u32 instanceCount = 1)
+    {
+        ++m_Current.DrawCalls;
+        m_Current.Triangles += static_cast<u64>(indexCount / 3) * instanceCount;
+    }
+    void CountIndirectDraw() { ++m_Current.IndirectDrawCalls; }
+    void CountPipelineSwitch() { ++m_Current.PipelineSwitches; }
+    void CountBindGroupSwitch() { ++m_Current.BindGroupSwitches; }
+    void CountBufferUpload(u64 bytes) { m_Current.BufferBytesUploaded += bytes; }
+    void CountTextureUpload(u64 bytes) { m_Current.TextureBytesUploaded += bytes; }
+    void CountSubmit(u32 commandBufferCount) { m_Current.CommandBuffersSubmitted += commandBufferCount; }
+
+    // Counters recorded so far; render bundles swap these out while recording
+    // so their draws can be replayed into later frames.
+    [[nodiscard]] FrameStats& GetCurrent();
+
+    void EndFrame();
+
+    // Most recent finished frame.
+    [[nodiscard]] const FrameStats& GetLast() const;
+    // Finished frames, oldest first.
+    [[nodiscard]] std::vector<FrameStats> GetHistory() const;
+    [[nodiscard]] FrameStats GetAverage() const;
+    [[nodiscard]] FrameStats GetPeak() const;
+
+private:
+    FrameStats m_Current;
+    std::array<FrameStats, kHistorySize> m_History{};
+    u32 m_Next = 0;
+    u32 m_Count = 0;
+};
+
+} // photon
+
+#endif //PHOTON_RENDERSTATS_H
@@ -3,37 +3,91 @@
 //
 
 #include "Renderer.h"
+#include "CpuProfiler.h"
 #include "Logger.h"
 #include "Reader.h"
 #include "ResourceLoader.h"
+#include "Simulation.h"
+#include "StartupTimeline.h"
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <optional>
 
 #if __EMSCRIPTEN__
 #include <emscripten/bind.h>
 #include <emscripten/html5.h>
 #include <emscripten/val.h>
 
+#else
+#include <dawn/native/DawnNative.h>
 #endif
 
 namespace photon {
 
+#if !defined(__EMSCRIPTEN__)
+static constexpr const char *kGpuProfilePath = "./gpu_profile.csv";
+static constexpr const char *kCpuTracePath = "./cpu_trace.json";
+static constexpr const char *kStartupReportPath = "./startup.json";
+#endif
+
 void Renderer::GetDevice(void (*callback)(wgpu::Device)) {
+  StartupTimeline &timeline = StartupTimeline::Instance();
+  timeline.BeginStage("Create Instance");
+#if defined(__EMSCRIPTEN__)
+  wInstance = wgpu::CreateInstance();
+#else
+  // Dawn persists compiled shaders and pipelines through the platform's
+  // caching interface, so warm starts skip backend compilation.
+  Platform = std::make_unique<CachingPlatform>(kPipelineCachePath);
+  dawn::native::DawnInstanceDescriptor dawnInstanceDescriptor;
+  dawnInstanceDescriptor.platform = Platform.get();
+  wgpu::InstanceDescriptor instanceDescriptor{.nextInChain =
+                                                  &dawnInstanceDescriptor};
+  wInstance = wgpu::CreateInstance(&instanceDescriptor);
+#endif
+  timeline.EndStage();
+
+  // The requests may complete asynchronously, so their stages end in the
+  // callbacks.
+  timeline.BeginStage("Request Adapter");
   wInstance.RequestAdapter(
-      nullptr,
+      &AdapterOptions,
       // TODO(https://bugs.chromium.org/p/dawn/issues/detail?id=1892): Use
       // wgpu::RequestAdapterStatus, wgpu::Adapter, and wgpu::Device.
       [](WGPURequestAdapterStatus status, WGPUAdapter cAdapter,
          const char *message, void *userdata) {
         if (status != WGPURequestAdapterStatus_Success) {
           LogError("Failed to acquire adapter");
-          exit(0);
+          exit(EXIT_FAILURE);
         }
         wgpu::Adapter adapter = wgpu::Adapter::Acquire(cAdapter);
+        StartupTimeline::Instance().EndStage();
+
+        // Timestamp queries feed the GPU profiler; without them it stays off.
+        std::vector<wgpu::FeatureName> features;
+        if (adapter.HasFeature(wgpu::FeatureName::TimestampQuery))
+          features.push_back(wgpu::FeatureName::TimestampQuery);
+
+        wgpu::DeviceDescriptor deviceDescriptor{
+            .requiredFeatureCount = features.size(),
+            .requiredFeatures = features.data()};
+#if !defined(__EMSCRIPTEN__)
+        wgpu::DawnCacheDeviceDescriptor cacheDescriptor{};
+        cacheDescriptor.isolationKey = DiskBlobCache::GetVersionKey();
+        deviceDescriptor.nextInChain = &cacheDescriptor;
+#endif
+
+        StartupTimeline::Instance().BeginStage("Request Device");
         adapter.RequestDevice(
-            nullptr,
+            &deviceDescriptor,
             [](WGPURequestDeviceStatus status, WGPUDevice cDevice,
                const char *message, void *userdata) {
+              StartupTimeline::Instance().EndStage();
               wgpu::Device device = wgpu::Device::Acquire(cDevice);
               device.SetUncapturedErrorCallback(
                   [](WGPUErrorType type, const char *message, void *userdata) {
@@ -72,65 +126,140 @@ EMSCRIPTEN_BINDINGS(renderer) {
       .function("onMouseOver", &Renderer::OnMouseOver)
       .function("onMouseOut", &Renderer::OnMouseOut)
       .function("onSliderChange", &Renderer::OnSliderChange)
-      .function("onScroll", &Renderer::OnScroll);
+      .function("onScroll", &Renderer::OnScroll)
+      .function("setGpuDriven", &Renderer::SetGpuDriven)
+      .function("setDepthPrepass", &Renderer::SetDepthPrepass)
+      .function("setDynamicResolution", &Renderer::SetDynamicResolution)
+      .function("logGpuProfile", &Renderer::LogGpuProfile)
+      .function("logRenderStats", &Renderer::LogRenderStats)
+      .function("logStartupTimeline", &Renderer::LogStartupTimeline)
+      .function("logFramePacing", &Renderer::LogFramePacing);
 
   emscripten::constant("renderer", &Renderer::Instance());
 }
 #endif
 
 void Renderer::OnInputDown(const std::string &key) {
-  if (key == "w")
-    InputRotation.x += 1;
-  if (key == "s")
-    InputRotation.x -= 1;
-  if (key == "a")
-    InputRotation.y += 1;
-  if (key == "d")
-    InputRotation.y -= 1;
+  HandleInput({.Type = EInputEventType::KeyDown, .Name = key});
 }
 
 void Renderer::OnInputUp(const std::string &key) {
-  if (key == "w")
-    InputRotation.x -= 1;
-  if (key == "s")
-    InputRotation.x += 1;
-  if (key == "a")
-    InputRotation.y -= 1;
-  if (key == "d")
-    InputRotation.y += 1;
+  HandleInput({.Type = EInputEventType::KeyUp, .Name = key});
 }
 
 void Renderer::OnMouseDown(const MouseButtonEvent &event) {
-  std::cout << "Mouse Down [" << event.X << "," << event.Y << "]" << std::endl;
+  HandleInput({.Type = EInputEventType::MouseDown,
+               .Button = event.Button,
+               .X = event.X,
+               .Y = event.Y});
 }
 
 void Renderer::OnMouseUp(const MouseButtonEvent &event) {
-  std::cout << "Mouse Up [" << event.Button << "]" << std::endl;
+  HandleInput({.Type = EInputEventType::MouseUp,
+               .Button = event.Button,
+               .X = event.X,
+               .Y = event.Y});
 }
 
 void Renderer::OnMouseOver(const v2i &position) {
-  std::cout << "Pos: [" << position.x << "," << position.y << "]" << std::endl;
+  HandleInput(
+      {.Type = EInputEventType::MouseOver, .X = position.x, .Y = position.y});
 }
 
 void Renderer::OnMouseOut(const v2i &position) {
-  std::cout << "Pos: [" << position.x << "," << position.y << "]" << std::endl;
+  HandleInput(
+      {.Type = EInputEventType::MouseOut, .X = position.x, .Y = position.y});
 }
 
 void Renderer::OnSliderChange(const std::string &name, i32 value) {
-  std::cout << "Slider: " << name << " Value: " << value << std::endl;
-  if (name == "metalnessSlider")
-  {
-    metalic = value / 100.f;
-  }
-  else if (name == "roughnessSlider")
-  {
-    roughness = value / 100.f;
-  }
+  HandleInput({.Type = EInputEventType::Slider,
+               .Name = name,
+               .Value = static_cast<f32>(value)});
 }
 
 void Renderer::OnScroll(const float delta) {
-  Camera.Position += Camera.Front * delta * -0.005f;
+  HandleInput({.Type = EInputEventType::Scroll, .Value = delta});
+}
+
+void Renderer::HandleInput(const InputEvent &event) {
+  if (Input.IsReplaying())
+    return;
+  InputEvent stamped = event;
+  stamped.Frame = FrameIndex;
+  stamped.bLate = bSamplingLateInput;
+  Input.Record(stamped);
+  ApplyInput(stamped);
+}
+
+void Renderer::ApplyInput(const InputEvent &event) {
+  switch (event.Type) {
+  case EInputEventType::KeyDown:
+  case EInputEventType::KeyUp:
+  case EInputEventType::Scroll:
+    Pacing.OnInput(Sim.PushInput(event));
+    break;
+  case EInputEventType::MouseDown:
+  case EInputEventType::MouseUp:
+  case EInputEventType::MouseOver:
+  case EInputEventType::MouseOut:
+    // Nothing reacts to the mouse yet; the events are still recorded.
+    break;
+  case EInputEventType::Slider:
+    for (CMaterial &material : Materials) {
+      if (event.Name == "metalnessSlider") {
+        material.Metallic = event.Value / 100.f;
+        material.bDirty = true;
+      } else if (event.Name == "roughnessSlider") {
+        material.Roughness = event.Value / 100.f;
+        material.bDirty = true;
+      }
+    }
+    // Uploaded by the next Update, which samples at least this tick.
+    Pacing.OnInput(Sim.GetInputTick());
+    break;
+  }
+}
+
+#if !defined(__EMSCRIPTEN__)
+// Routes window input through the same handlers the browser build uses.
+void Renderer::SetupInputCallbacks(GLFWwindow *window) {
+  glfwSetKeyCallback(window, [](GLFWwindow *, i32 key, i32, i32 action, i32) {
+    if (key < GLFW_KEY_A || key > GLFW_KEY_Z || action == GLFW_REPEAT)
+      return;
+    const std::string name(1, static_cast<char>('a' + key - GLFW_KEY_A));
+    if (action == GLFW_PRESS)
+      Instance().OnInputDown(name);
+    else
+      Instance().OnInputUp(name);
+  });
+  glfwSetMouseButtonCallback(
+      window, [](GLFWwindow *window, i32 button, i32 action, i32) {
+        f64 x = 0.0, y = 0.0;
+        glfwGetCursorPos(window, &x, &y);
+        const MouseButtonEvent event{.Button = button,
+                                     .X = static_cast<i32>(x),
+                                     .Y = static_cast<i32>(y)};
+        if (action == GLFW_PRESS)
+          Instance().OnMouseDown(event);
+        else
+          Instance().OnMouseUp(event);
+      });
+  glfwSetCursorEnterCallback(window, [](GLFWwindow *window, i32 entered) {
+    f64 x = 0.0, y = 0.0;
+    glfwGetCursorPos(window, &x, &y);
+    const v2i position(static_cast<i32>(x), static_cast<i32>(y));
+    if (entered)
+      Instance().OnMouseOver(position);
+    else
+      Instance().OnMouseOut(position);
+  });
+  // Wheel notches scroll about 100 units of a browser's deltaY, which grows
+  // downwards.
+  glfwSetScrollCallback(window, [](GLFWwindow *, f64, f64 yOffset) {
+    Instance().OnScroll(static_cast<f32>(yOffset * -100.0));
+  });
 }
+#endif
 
 void Renderer::Start() {
 #if __EMSCRIPTEN__
@@ -192,24 +321,36 @@ void Renderer::Start() {
         });
   });
 #else
-  if (!glfwInit()) {
-    return;
-  }
+  GLFWwindow *window = nullptr;
+  if (!Options.bHeadless) {
+    StartupScope stage("Create Window");
+    if (!glfwInit()) {
+      return;
+    }
 
-  glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-  GLFWwindow *window =
-      glfwCreateWindow(kWidth, kHeight, "WebGPU window", nullptr, nullptr);
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    window =
+        glfwCreateWindow(kWidth, kHeight, "WebGPU window", nullptr, nullptr);
 
-  wSurface = wgpu::glfw::CreateSurfaceForWindow(wInstance, window);
+    wSurface = wgpu::glfw::CreateSurfaceForWindow(wInstance, window);
+    SetupInputCallbacks(window);
+  }
 #endif
 
+  PHOTON_PROFILE_THREAD("Main");
   InitGraphics();
+#if !defined(__EMSCRIPTEN__)
+  if (Options.bSimulationThread)
+    Sim.StartThread();
+#endif
 
 #if defined(__EMSCRIPTEN__)
   auto RenderLoopCallBack = [](void *arg) {
     Renderer *renderer = static_cast<Renderer *>(arg);
-    renderer->Update();
-    renderer->Render();
+    renderer->Frame();
+    // The browser presents once the callback returns.
+    renderer->Pacing.OnPresented(renderer->ViewTick);
+    renderer->MarkFramePresented();
   };
   emscripten_set_main_loop_arg(RenderLoopCallBack, this, -1, true);
 //    emscripten_set_resize_callback(nullptr, this, true, [](int, int, void*
@@ -218,115 +359,427 @@ void Renderer::Start() {
 //        static_cast<Renderer*>(arg)->wSwapChain.Configure(kWidth, kHeight);
 //    });
 #else
-  while (!glfwWindowShouldClose(window)) {
-    glfwPollEvents();
-    Render();
-    wSwapChain.Present();
-    wInstance.ProcessEvents();
+  if (Options.bHeadless) {
+    RunHeadless();
+  } else {
+    while (!glfwWindowShouldClose(window)) {
+      // Poll after the wait so it doesn't add to the input's latency.
+      Pacing.WaitForFrameSlot(wInstance);
+      glfwPollEvents();
+      Frame();
+      {
+        PHOTON_PROFILE_SCOPE("Present");
+        wSwapChain.Present();
+      }
+      Pacing.OnPresented(ViewTick);
+      MarkFramePresented();
+      wInstance.ProcessEvents();
+
+      const bool bContinue =
+          !Options.OnFrameEnd || Options.OnFrameEnd(FrameIndex);
+      if (!bContinue || ++FrameIndex == Options.FrameCount)
+        break;
+    }
   }
+
+  Sim.StopThread();
+  Input.Save();
+  LogFramePacing();
+  if (Profiler.IsEnabled())
+    Profiler.WriteCsv(kGpuProfilePath);
+#if defined(PHOTON_ENABLE_PROFILING)
+  CpuProfiler::WriteChromeTrace(kCpuTracePath);
+#endif
 #endif
 }
 
 void Renderer::Update() {
-  MeshYaw += InputRotation.x;
-  MeshPitch += InputRotation.y;
-  MeshRoll += InputRotation.z;
-
-  v3f pos = v3f(0.f);
-  v3f rot = v3f(0.f);
-  v3f scale = v3f(1.f);
-
-  ShaderUniforms uniforms{};
-  m4 model = m4(1.0f);
-  model = glm::translate(model, pos);
-  model = glm::rotate(model, glm::radians(MeshYaw), v3f(1.0f, 0.0f, 0.0f));
-  model = glm::rotate(model, glm::radians(MeshPitch), v3f(0.0f, 1.0f, 0.0f));
-  model = glm::rotate(model, glm::radians(MeshRoll), v3f(0.0f, 0.0f, 1.0f));
-  model = glm::scale(model, scale * 0.5f);
-  uniforms.m_Model = model;
-  uniforms.m_CameraPosition = Camera.Position;
-  uniforms.m_metallic = metalic;
-  uniforms.m_roughness = roughness;
-  uniforms.m_deltaTime = (f32)glfwGetTime();
-
-  uniforms.m_Projection = glm::perspective(
-      glm::radians(45.0f), (f32)kWidth / (f32)kHeight, 0.1f, 100.0f);
-  uniforms.m_View = glm::lookAt(Camera.Position, v3f(0.0f), Camera.Up);
-  wDevice.GetQueue().WriteBuffer(wUniformBuffer, 0, &uniforms,
-                                 sizeof(ShaderUniforms));
+  PHOTON_PROFILE_FUNCTION();
+  wgpu::Queue queue = wDevice.GetQueue();
+
+  GpuFrameMs = Profiler.GetFrameMs();
+  if (Resolution.Update(GpuFrameMs))
+    ResizeRenderTargets();
+
+  const f64 time = GetTime();
+  const SimulationSnapshot state = Sim.Sample(time);
+  // LateUpdate asks for ticks up to the next frame from this estimate.
+  // Capped so a long frame can't run the simulation further ahead than the
+  // interpolation history reaches.
+  const f64 step = Sim.GetTimestep();
+  FrameInterval = std::clamp(time - LastFrameTime, step,
+                             step * (Simulation::kHistorySize / 2));
+  LastFrameTime = time;
+
+  if (!Objects.empty() && state.MeshRotation != MeshRotation) {
+    MeshRotation = state.MeshRotation;
+    v3f pos = v3f(0.f);
+    v3f scale = v3f(1.f);
+
+    m4 model = m4(1.0f);
+    model = glm::translate(model, pos);
+    model = glm::rotate(model, glm::radians(MeshRotation.x),
+                        v3f(1.0f, 0.0f, 0.0f));
+    model = glm::rotate(model, glm::radians(MeshRotation.y),
+                        v3f(0.0f, 1.0f, 0.0f));
+    model = glm::rotate(model, glm::radians(MeshRotation.z),
+                        v3f(0.0f, 0.0f, 1.0f));
+    model = glm::scale(model, scale * 0.5f);
+    Objects[0].Transform = model;
+    MarkObjectDirty(0);
+  }
+
+  // The early view decides CPU culling, shadow cascades and atlas tiles;
+  // LateUpdate samples it again for the uniforms.
+  EarlyFrame = SampleView(state);
+  const FrameUniforms &frame = EarlyFrame;
+
+  for (CMaterial &material : Materials) {
+    if (!material.bDirty)
+      continue;
+    MaterialUniforms uniforms{.m_metallic = material.Metallic,
+                              .m_roughness = material.Roughness};
+    queue.WriteBuffer(material.uniformBuffer, 0, &uniforms,
+                      sizeof(MaterialUniforms));
+    Stats.CountBufferUpload(sizeof(MaterialUniforms));
+    material.bDirty = false;
+  }
+
+  UploadDirtyObjects();
+
+  // The four lights orbit the origin a quarter turn apart.
+  for (u32 i = 0; i < 4 && i < Lights.size(); ++i) {
+    const f32 angle = frame.m_deltaTime + glm::half_pi<f32>() * i;
+    Lights[i].Position.x = std::cos(angle);
+    Lights[i].Position.z = std::sin(angle);
+  }
+  // After the objects so geometry changes reach the atlas scheduler, and
+  // before LateUpdate's upload so lights carry their shadow tiles.
+  Atlas.Update(Lights, Camera, Frustum::FromViewProjection(ViewProjection));
+  Shadows.Update(Camera, frame.m_View, SunDirection, SunColor);
+}
+
+FrameUniforms Renderer::SampleView(const SimulationSnapshot &state) {
+  FrameUniforms frame{};
+  frame.m_Projection = glm::perspective(glm::radians(Camera.Fov), Camera.Aspect,
+                                       Camera.Near, Camera.Far);
+  Camera.Position = state.CameraPosition;
+  Camera.Target = state.CameraTarget;
+  frame.m_View = glm::lookAt(Camera.Position, Camera.Target, Camera.Up);
+  ViewProjection = frame.m_Projection * frame.m_View;
+  frame.m_SkyboxMVPi =
+      glm::inverse(frame.m_Projection * glm::mat4(glm::mat3(frame.m_View)));
+  frame.m_CameraPosition = Camera.Position;
+  frame.m_deltaTime = (f32)state.Time;
+  ViewTick = state.Tick;
+  return frame;
+}
+
+void Renderer::LateUpdate() {
+  PHOTON_PROFILE_FUNCTION();
+#if !defined(__EMSCRIPTEN__)
+  if (!Options.bHeadless) {
+    bSamplingLateInput = true;
+    glfwPollEvents();
+    bSamplingLateInput = false;
+  }
+#endif
+  for (const InputEvent &event : ReplayEvents) {
+    if (event.bLate)
+      ApplyInput(event);
+  }
+
+  // Queue writes land before the next submit, so passes encoded with the
+  // early view still read these. Shadow decisions stay with the early view.
+  // Input polled here reaches the simulation at its next unrequested tick,
+  // which this view shows when the clock has moved past it.
+  const v3f earlyPosition = Camera.Position;
+  const v3f earlyTarget = Camera.Target;
+  const m4 earlyViewProjection = ViewProjection;
+  const u64 earlyTick = ViewTick;
+  FrameUniforms frame = SampleView(Sim.Sample(GetTime()));
+  const Frustum frustum = Frustum::FromViewProjection(ViewProjection);
+
+  if (bGpuDriven) {
+    // Instance culling and the depth pyramid run once submitted, so both
+    // phases test the view the depth was rendered with.
+    Scene.SetView(frustum, ViewProjection, Camera.Position);
+  } else if (ViewProjection != earlyViewProjection) {
+    // The CPU path already chose what to draw. Should the late view show an
+    // object the early one culled, it would pop in at the edges, so such a
+    // frame keeps the early view.
+    const std::vector<u32> &visible = Culler.Cull(frustum);
+    if (!std::includes(EncodedVisible.begin(), EncodedVisible.end(),
+                       visible.begin(), visible.end())) {
+      Camera.Position = earlyPosition;
+      Camera.Target = earlyTarget;
+      ViewProjection = earlyViewProjection;
+      ViewTick = earlyTick;
+      frame = EarlyFrame;
+    }
+  }
+
+  wDevice.GetQueue().WriteBuffer(wFrameUniformBuffer, 0, &frame,
+                                 sizeof(FrameUniforms));
+  Stats.CountBufferUpload(sizeof(FrameUniforms));
+  Lighting.Update(Lights, frame.m_View, frame.m_Projection, Camera.Near,
+                  Camera.Far);
+
+  // This frame's input is in, so a simulation thread can compute the ticks
+  // before the next frame while this one is submitted and presented. The
+  // tick the next frame samples stays unrequested, so its early input still
+  // lands in it.
+  Sim.RequestAdvance(LastFrameTime + FrameInterval - Sim.GetTimestep());
 }
 
 void Renderer::InitGraphics() {
+  PHOTON_PROFILE_FUNCTION();
+  StartupScope stage("Init Graphics");
+  StartupTimeline &timeline = StartupTimeline::Instance();
+
+  timeline.BeginStage("Render Targets");
   SetupCamera();
+  // Replays tick at the step they were recorded with.
+  Sim.Init(Options.Scene, Camera, Input.GetTimestep());
   SetupSwapChain();
   SetupMeshVertexBuffers();
   SetupDepthStencil();
-  LoadTextures("brick", ETextureImportType::jpg);
-  SetupMeshUniformBuffer();
+  Resolution.Init(kWidth, kHeight);
+  SetupRenderTargets();
   SetupSampler();
+  SetupUniformBuffers();
+  timeline.EndStage();
+
+  timeline.BeginStage("Subsystems");
+  Profiler.Init(wDevice);
+  Pacing.Init(Options.MaxFramesInFlight);
+  Lighting.Init(wDevice, Resolution.GetRenderWidth(),
+                Resolution.GetRenderHeight());
+  SetupLights();
+  Shadows.Init(wDevice);
+  Atlas.Init(wDevice, Shadows.GetCascadeBindGroupLayout());
+  SetupBindGroupLayouts();
+  Scene.Init(wDevice);
+  HiZ.Init(wDevice, wDepthTextureView, Resolution.GetRenderWidth(),
+           Resolution.GetRenderHeight());
+  Scene.SetDepthPyramid(HiZ);
+  SetupPipelineLayouts();
+  timeline.EndStage();
+
+  // Pipelines build asynchronously; this covers shader module creation and
+  // starting the builds. kPipelinesReady marks when the last one lands.
+  timeline.BeginStage("Request Pipelines");
+  Pipelines.Init(wDevice);
+  SetupMeshPipeline();
+  SetupSkyboxPipeline();
+  SetupMeshInstancedPipeline();
+  SetupDepthPrepassPipelines();
+  SetupShadowPipeline();
+  SetupUpscale();
+  timeline.EndStage();
+
+  timeline.BeginStage("Load Skybox");
+  LoadSkybox(Options.Scene.Skybox, Options.Scene.SkyboxType);
+  SetupFrameBindGroup();
+  SetupObjectBindGroup();
+  timeline.EndStage();
+
+  LoadScene();
+}
 
-  SetupMeshBindGroupLayout();
-  SetupMeshBindGroup();
-
-  SetupSkyboxBindGroupLayout();
-  SetupSkyboxBindGroup();
+void Renderer::LoadScene() {
+  PHOTON_PROFILE_FUNCTION();
+  StartupScope stage("Load Scene");
+  const SceneDescription &scene = Options.Scene;
 
-  SetupMeshPipeline();
+  const u32 firstMaterial = static_cast<u32>(Materials.size());
+  {
+    StartupScope texturesStage("Load Materials");
+    for (const SceneMaterial &material : scene.Materials)
+      LoadMaterial(material.Name, material.Type);
+  }
 
-  SetupSkyboxPipeline();
+  const u32 firstMesh = static_cast<u32>(Meshes.size());
+  {
+    StartupScope meshesStage("Load Meshes");
+    for (const std::string &mesh : scene.Meshes) {
+      const EModelImportType type = mesh.ends_with(".gltf")
+                                        ? EModelImportType::gltf
+                                        : EModelImportType::glb;
+      Meshes.push_back(ResourceLoader::LoadMesh(mesh.c_str(), wDevice, type));
+    }
+  }
 
-  Mesh = ResourceLoader::LoadMesh("sphere.glb", wDevice, EModelImportType::glb);
+  const u32 instanceCount = scene.InstanceCount;
+  ReserveObjects(static_cast<u32>(Objects.size()) + instanceCount);
+
+  // A square grid on the XZ plane centred on the origin, cycling through the
+  // scene's meshes and materials.
+  const u32 side =
+      static_cast<u32>(std::ceil(std::sqrt(static_cast<f32>(instanceCount))));
+  const f32 extent = static_cast<f32>(side - 1) * scene.InstanceSpacing;
+  for (u32 i = 0; i < instanceCount; ++i) {
+    const v3f position =
+        v3f(static_cast<f32>(i % side), 0.f, static_cast<f32>(i / side)) *
+            scene.InstanceSpacing -
+        v3f(extent * 0.5f, 0.f, extent * 0.5f);
+    m4 transform = glm::translate(m4(1.0f), position);
+    transform = glm::scale(transform, v3f(scene.InstanceScale));
+    AddObject(
+        {.MeshIndex = firstMesh + i % static_cast<u32>(scene.Meshes.size()),
+         .MaterialIndex =
+             firstMaterial + i % static_cast<u32>(scene.Materials.size()),
+         .Transform = transform,
+         .bStatic = scene.bStaticInstances});
+  }
 }
 
 void Renderer::SetupSwapChain() {
+  PHOTON_PROFILE_FUNCTION();
+  if (Options.bHeadless) {
+    wgpu::TextureDescriptor descriptor{
+        .label = "Headless Output",
+        .usage = wgpu::TextureUsage::RenderAttachment |
+                 wgpu::TextureUsage::CopySrc,
+        .size = {kWidth, kHeight, 1},
+        .format = wgpu::TextureFormat::BGRA8Unorm};
+    wOutputTexture = wDevice.CreateTexture(&descriptor);
+    wOutputTextureView = wOutputTexture.CreateView();
+    Readback.Init(wDevice);
+    return;
+  }
+
   wgpu::SwapChainDescriptor scDesc{.usage =
                                        wgpu::TextureUsage::RenderAttachment,
                                    .format = wgpu::TextureFormat::BGRA8Unorm,
                                    .width = kWidth,
                                    .height = kHeight,
-                                   .presentMode = wgpu::PresentMode::Fifo};
+                                   .presentMode = Options.PresentMode};
   wSwapChain = wDevice.CreateSwapChain(wSurface, &scDesc);
 }
 
+void Renderer::SetupPipelineLayouts() {
+  PHOTON_PROFILE_FUNCTION();
+  std::array<wgpu::BindGroupLayout, kBindGroupCount> bindGroupLayouts = {
+      wFrameBindGroupLayout, wMaterialBindGroupLayout, wObjectBindGroupLayout};
+
+  wgpu::PipelineLayoutDescriptor meshLayoutDescriptor{
+      .bindGroupLayoutCount = bindGroupLayouts.size(),
+      .bindGroupLayouts = bindGroupLayouts.data()};
+  wMeshPipelineLayout = wDevice.CreatePipelineLayout(&meshLayoutDescriptor);
+
+  bindGroupLayouts[kObjectBindGroup] = Scene.GetDrawBindGroupLayout();
+  wgpu::PipelineLayoutDescriptor gpuDrivenLayoutDescriptor{
+      .bindGroupLayoutCount = bindGroupLayouts.size(),
+      .bindGroupLayouts = bindGroupLayouts.data()};
+  wGpuDrivenPipelineLayout =
+      wDevice.CreatePipelineLayout(&gpuDrivenLayoutDescriptor);
+
+  std::array<wgpu::BindGroupLayout, 2> shadowBindGroupLayouts = {
+      Shadows.GetCascadeBindGroupLayout(), wObjectBindGroupLayout};
+  wgpu::PipelineLayoutDescriptor shadowLayoutDescriptor{
+      .bindGroupLayoutCount = shadowBindGroupLayouts.size(),
+      .bindGroupLayouts = shadowBindGroupLayouts.data()};
+  wShadowPipelineLayout = wDevice.CreatePipelineLayout(&shadowLayoutDescriptor);
+
+  wgpu::PipelineLayoutDescriptor skyboxLayoutDescriptor{
+      .bindGroupLayoutCount = 1, .bindGroupLayouts = &wFrameBindGroupLayout};
+  wSkyboxPipelineLayout = wDevice.CreatePipelineLayout(&skyboxLayoutDescriptor);
+}
+
 void Renderer::SetupMeshPipeline() {
-  wgpu::ShaderModuleWGSLDescriptor wgslDesc{};
-  wgslDesc.code = Reader::ReadTextFile("shaders/pbr_mat.wgsl");
+  PHOTON_PROFILE_FUNCTION();
+  RenderPipelineDesc desc{
+      .Label = "Mesh",
+      .ShaderPath = "shaders/pbr_mat.wgsl",
+      .VertexEntryPoint = "vs_main",
+      .FragmentEntryPoint = "fs_main",
+      .VertexBuffers = wVertexBufferLayouts,
+      .ColorFormat = wgpu::TextureFormat::BGRA8Unorm,
+      .DepthStencil = wDepthStencilState,
+      .Layout = wMeshPipelineLayout,
+  };
+  MeshPipeline = Pipelines.Request(desc);
 
-  wgpu::ShaderModuleDescriptor shaderModuleDescriptor{.nextInChain = &wgslDesc};
-  shaderModuleDescriptor.label = "PBR Material Shader Module";
-  wgpu::ShaderModule shaderModule =
-      wDevice.CreateShaderModule(&shaderModuleDescriptor);
+  desc.Label = "Mesh (Depth Equal)";
+  desc.DepthStencil = wDepthEqualState;
+  MeshDepthEqualPipeline = Pipelines.Request(desc);
+}
 
-  wgpu::ColorTargetState colorTargetState{.format =
-                                              wgpu::TextureFormat::BGRA8Unorm};
+void Renderer::SetupMeshInstancedPipeline() {
+  PHOTON_PROFILE_FUNCTION();
+  RenderPipelineDesc desc{
+      .Label = "Mesh Instanced",
+      .ShaderPath = "shaders/pbr_mat.wgsl",
+      .VertexEntryPoint = "vs_instanced",
+      .FragmentEntryPoint = "fs_main",
+      .VertexBuffers = wVertexBufferLayouts,
+      .ColorFormat = wgpu::TextureFormat::BGRA8Unorm,
+      .DepthStencil = wDepthStencilState,
+      .Layout = wGpuDrivenPipelineLayout,
+  };
+  MeshInstancedPipeline = Pipelines.Request(desc);
 
-  wgpu::FragmentState fragmentState{
-      .module = shaderModule, .targetCount = 1, .targets = &colorTargetState};
+  desc.Label = "Mesh Instanced (Depth Equal)";
+  desc.DepthStencil = wDepthEqualState;
+  MeshInstancedDepthEqualPipeline = Pipelines.Request(desc);
+}
 
-  wgpu::PipelineLayoutDescriptor pipelineLayoutDescriptor{
-      .bindGroupLayoutCount = 1, .bindGroupLayouts = &wBindGroupLayout};
+void Renderer::SetupDepthPrepassPipelines() {
+  PHOTON_PROFILE_FUNCTION();
+  // Position only: the prepass needs no other attribute and no fragment
+  // stage.
+  RenderPipelineDesc desc{
+      .Label = "Depth Prepass",
+      .ShaderPath = "shaders/pbr_mat.wgsl",
+      .VertexEntryPoint = "vs_depth",
+      .VertexBuffers = {wVertexBufferLayouts[0]},
+      .ColorFormat = wgpu::TextureFormat::Undefined,
+      .DepthStencil = wDepthStencilState,
+      .Layout = wMeshPipelineLayout,
+  };
+  DepthPrepassPipeline = Pipelines.Request(desc);
 
-  wgpu::PipelineLayout pipelineLayout =
-      wDevice.CreatePipelineLayout(&pipelineLayoutDescriptor);
+  desc.Label = "Depth Prepass Instanced";
+  desc.VertexEntryPoint = "vs_depth_instanced";
+  desc.Layout = wGpuDrivenPipelineLayout;
+  DepthPrepassInstancedPipeline = Pipelines.Request(desc);
+}
 
-  wgpu::RenderPipelineDescriptor descriptor{
-      .label = "Mesh",
-      .layout = pipelineLayout,
-      .vertex = {.module = shaderModule},
-      .depthStencil = &wDepthStencilState,
-      .fragment = &fragmentState,
-  };
+void Renderer::SetupShadowPipeline() {
+  PHOTON_PROFILE_FUNCTION();
+  // Shadow casters only need the position stream.
+  ShadowPipeline = Pipelines.Request({
+      .Label = "Shadow Casters",
+      .ShaderPath = "shaders/shadow_depth.wgsl",
+      .VertexEntryPoint = "vs_main",
+      .VertexBuffers = {wVertexBufferLayouts[0]},
+      .ColorFormat = wgpu::TextureFormat::Undefined,
+      .DepthStencil = Shadows.GetDepthStencilState(),
+      .Layout = wShadowPipelineLayout,
+  });
+}
 
-  descriptor.vertex.bufferCount =
-      static_cast<uint32_t>(wVertexBufferLayouts.size());
-  descriptor.vertex.buffers = wVertexBufferLayouts.data();
+PipelineHandle
+Renderer::GetMeshPipelineHandle(const CMaterial &material) const {
+  return bDepthPrepassActive ? material.depthEqualPipeline : material.pipeline;
+}
 
-  wRenderPipeline = wDevice.CreateRenderPipeline(&descriptor);
+wgpu::RenderPipeline
+Renderer::GetMeshPipeline(const CMaterial &material) const {
+  // Draw with the default mesh pipeline while a material's own pipeline is
+  // still compiling; if that is not ready either the draw is skipped. Its
+  // LessEqual test stays correct after a prepass.
+  if (wgpu::RenderPipeline pipeline =
+          Pipelines.Get(GetMeshPipelineHandle(material)))
+    return pipeline;
+  return Pipelines.Get(MeshPipeline);
 }
 
 void Renderer::Render() {
+  PHOTON_PROFILE_FUNCTION();
   wgpu::RenderPassColorAttachment attachment{
-      .view = wSwapChain.GetCurrentTextureView(),
+      .view = wSceneColorTextureView,
       .loadOp = wgpu::LoadOp::Clear,
       .storeOp = wgpu::StoreOp::Store};
 
@@ -346,20 +799,156 @@ void Renderer::Render() {
                                         .depthStencilAttachment =
                                             &depthStencilAttachment};
 
+  wgpu::RenderPassDescriptor depthPrepass{.label = "Depth Prepass",
+                                          .colorAttachmentCount = 0,
+                                          .depthStencilAttachment =
+                                              &depthStencilAttachment};
+
+  const Frustum frustum = Frustum::FromViewProjection(ViewProjection);
+
+  // Until the prepass pipeline is ready meshes shade with a regular depth
+  // test.
+  bDepthPrepassActive =
+      bDepthPrepass && Pipelines.IsReady(bGpuDriven
+                                             ? DepthPrepassInstancedPipeline
+                                             : DepthPrepassPipeline);
+
+  Profiler.BeginFrame();
   wgpu::CommandEncoder encoder = wDevice.CreateCommandEncoder();
+  Lighting.Assign(encoder, Profiler.ComputePass("Light Clustering"));
+  RenderShadows(encoder);
+
+  if (bGpuDriven) {
+    if (bGpuSceneDirty) {
+      Scene.Build(Objects, Meshes);
+      bGpuSceneDirty = false;
+    }
+
+    for (u32 phase = 0; phase < GpuScene::kPhaseCount; ++phase) {
+      // Phase 1 re-tests everything against the depth of last frame's
+      // visible set and draws what became visible on top.
+      if (phase > 0)
+        HiZ.Build(encoder, Profiler.ComputePass("Depth Pyramid"));
+      Scene.Cull(encoder, phase, Profiler.ComputePass("Instance Culling"));
+
+      if (bDepthPrepassActive) {
+        depthPrepass.timestampWrites = Profiler.RenderPass("Depth Prepass");
+        wgpu::RenderPassEncoder pass = encoder.BeginRenderPass(&depthPrepass);
+        PassState = {};
+        DrawGpuScene(pass, phase, true);
+        pass.End();
+        depthStencilAttachment.depthLoadOp = wgpu::LoadOp::Load;
+      }
+
+      renderpass.timestampWrites = Profiler.RenderPass("Main Pass");
+      wgpu::RenderPassEncoder pass = encoder.BeginRenderPass(&renderpass);
+      PassState = {};
+      DrawGpuScene(pass, phase, false);
+      if (phase == GpuScene::kPhaseCount - 1)
+        DrawSkybox(pass);
+      pass.End();
+
+      attachment.loadOp = wgpu::LoadOp::Load;
+      depthStencilAttachment.depthLoadOp = wgpu::LoadOp::Load;
+    }
+
+    SubmitFrame(encoder);
+    return;
+  }
+
+  if (bStaticBundleDirty || bStaticBundlePrepass != bDepthPrepassActive)
+    RecordStaticBundle();
+  const bool bStaticBundled = static_cast<bool>(wStaticBundle);
+
+  // Bundled static objects are left to the GPU's clipper; everything else is
+  // frustum culled. Until the bundle can be recorded, static objects are
+  // drawn like dynamic ones.
+  const std::vector<u32> &visible = Culler.Cull(frustum);
+
+  // Everything the passes below draw, ascending, for LateUpdate's view check.
+  EncodedVisible.clear();
+  for (u32 i : visible) {
+    if (!Objects[i].bStatic || !bStaticBundled)
+      EncodedVisible.push_back(i);
+  }
+  if (bStaticBundled) {
+    const auto culledEnd = static_cast<std::ptrdiff_t>(EncodedVisible.size());
+    EncodedVisible.insert(EncodedVisible.end(), BundledObjects.begin(),
+                          BundledObjects.end());
+    std::inplace_merge(EncodedVisible.begin(),
+                       EncodedVisible.begin() + culledEnd,
+                       EncodedVisible.end());
+  }
+
+  if (bDepthPrepassActive) {
+    depthPrepass.timestampWrites = Profiler.RenderPass("Depth Prepass");
+    wgpu::RenderPassEncoder pass = encoder.BeginRenderPass(&depthPrepass);
+    PassState = {};
+    if (bStaticBundled) {
+      pass.ExecuteBundles(1, &wStaticDepthBundle);
+      Stats.GetCurrent() += StaticDepthBundleStats;
+      PassState = {};
+    }
+    for (u32 i : visible) {
+      if (!Objects[i].bStatic || !bStaticBundled)
+        DrawMeshDepth(pass, i);
+    }
+    pass.End();
+    depthStencilAttachment.depthLoadOp = wgpu::LoadOp::Load;
+  }
+
+  renderpass.timestampWrites = Profiler.RenderPass("Main Pass");
   wgpu::RenderPassEncoder pass = encoder.BeginRenderPass(&renderpass);
+  PassState = {};
+
+  if (bStaticBundled) {
+    pass.ExecuteBundles(1, &wStaticBundle);
+    Stats.GetCurrent() += StaticBundleStats;
+    // Executing a bundle resets the pass state.
+    PassState = {};
+  }
 
+  for (u32 i : visible) {
+    if (!Objects[i].bStatic || !bStaticBundled)
+      DrawMesh(pass, i);
+  }
+
+  // Last, so the depth test rejects every pixel a mesh already covered.
   DrawSkybox(pass);
-  DrawMesh(pass);
 
   pass.End();
+  SubmitFrame(encoder);
+}
+
+void Renderer::SubmitFrame(wgpu::CommandEncoder &encoder) {
+  PHOTON_PROFILE_FUNCTION();
+  Upscale(encoder);
+  Profiler.EndFrame(encoder);
   wgpu::CommandBuffer commands = encoder.Finish();
+  // Last, so the view reflects input that arrived while encoding.
+  LateUpdate();
   wDevice.GetQueue().Submit(1, &commands);
+  Pacing.OnSubmitted(wDevice.GetQueue());
+  Stats.CountSubmit(1);
+  Stats.EndFrame();
+  Profiler.AfterSubmit();
+}
+
+wgpu::TextureView Renderer::GetOutputView() {
+  return Options.bHeadless ? wOutputTextureView : wSwapChain.GetCurrentTextureView();
+}
+
+f64 Renderer::GetTime() const {
+  // Headless runs, recordings and replays step time per frame so every run
+  // renders the same frames.
+  if (Options.bHeadless || Input.IsRecording() || Input.IsReplaying())
+    return static_cast<f64>(FrameIndex) * Input.GetTimestep();
+  return glfwGetTime();
 }
 
 bool Renderer::Go() {
+  StartupTimeline::Instance().Reset();
   Renderer &instance = Instance();
-  instance.wInstance = wgpu::CreateInstance();
   instance.GetDevice([](wgpu::Device dev) {
     Renderer &instance = Instance();
     instance.wDevice = dev;
@@ -369,102 +958,343 @@ bool Renderer::Go() {
   return EXIT_SUCCESS;
 }
 
-void Renderer::SetupMeshBindGroupLayout() {
-  wBindGroupLayoutEntries.resize(7, {});
+#if !defined(__EMSCRIPTEN__)
+int Renderer::Run(const RunOptions &options) {
+  // Headless runs have no window to close.
+  constexpr u32 kDefaultHeadlessFrames = 300;
+
+  StartupTimeline::Instance().Reset();
+  Renderer &instance = Instance();
+  instance.Options = options;
+  if (!options.ReplayPath.empty()) {
+    if (!instance.Input.LoadReplay(options.ReplayPath))
+      return EXIT_FAILURE;
+    const std::string &recordedScene = instance.Input.GetSceneName();
+    if (recordedScene != options.Scene.Name)
+      LogWarning("Replaying input recorded on scene %s in scene %s",
+                 recordedScene.c_str(), options.Scene.Name.c_str());
+    if (options.FrameCount == 0)
+      instance.Options.FrameCount =
+          static_cast<u32>(instance.Input.GetFrameCount());
+  } else if (!options.RecordPath.empty()) {
+    instance.Input.StartRecording(options.RecordPath, options.Scene.Name);
+  }
+  if (options.bHeadless && instance.Options.FrameCount == 0)
+    instance.Options.FrameCount = kDefaultHeadlessFrames;
+  // Following GPU time would change the render size mid-run and differ
+  // between runs of the same replay or headless capture.
+  instance.Resolution.bEnabled = options.DynamicResolution.value_or(
+      !options.bHeadless && options.ReplayPath.empty());
+  instance.kWidth = options.Width;
+  instance.kHeight = options.Height;
+  instance.AdapterOptions.backendType = options.Backend;
+  instance.AdapterOptions.forceFallbackAdapter = options.bForceFallbackAdapter;
+
+  instance.GetDevice([](wgpu::Device dev) {
+    Renderer &instance = Instance();
+    instance.wDevice = dev;
+    instance.Start();
+  });
+
+  return instance.wDevice ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void Renderer::RunHeadless() {
+  PHOTON_PROFILE_FUNCTION();
+  const bool bCapture = !Options.CapturePrefix.empty();
+  for (FrameIndex = 0; FrameIndex < Options.FrameCount; ++FrameIndex) {
+    Pacing.WaitForFrameSlot(wInstance);
+    Frame();
+    // No present without a surface; the submitted frame stands in for it.
+    Pacing.OnPresented(ViewTick);
+    MarkFramePresented();
+
+    const bool bLastFrame = FrameIndex + 1 == Options.FrameCount;
+    const bool bCaptureDue = Options.CaptureInterval > 0 &&
+                             FrameIndex % Options.CaptureInterval == 0;
+    if (bCapture && (bLastFrame || bCaptureDue))
+      Readback.Capture(wOutputTexture, kWidth, kHeight,
+                       Options.CapturePrefix + std::to_string(FrameIndex) +
+                           ".png");
+    wInstance.ProcessEvents();
+
+    if (Options.OnFrameEnd && !Options.OnFrameEnd(FrameIndex))
+      break;
+  }
+
+  // Let the last frames and their readbacks finish before tearing down.
+  bool bIdle = false;
+  wDevice.GetQueue().OnSubmittedWorkDone(
+      [](WGPUQueueWorkDoneStatus, void *userdata) {
+        *static_cast<bool *>(userdata) = true;
+      },
+      &bIdle);
+  while (!bIdle || Readback.HasPending())
+    wInstance.ProcessEvents();
+  LogInfo("Rendered %llu headless frames", FrameIndex);
+}
+#endif
+
+void Renderer::Frame() {
+  std::optional<StartupScope> firstFrameStage;
+  if (!StartupTimeline::Instance().HasMark(StartupTimeline::kFirstPresent))
+    firstFrameStage.emplace("First Frame");
+
+  const auto start = std::chrono::steady_clock::now();
+  ReplayEvents = Input.BeginFrame(FrameIndex);
+  for (const InputEvent &event : ReplayEvents) {
+    if (!event.bLate)
+      ApplyInput(event);
+  }
+  Update();
+  Render();
+  CpuFrameMs = std::chrono::duration<f32, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+}
+
+void Renderer::MarkFramePresented() {
+  StartupTimeline &timeline = StartupTimeline::Instance();
+  if (timeline.HasMark(StartupTimeline::kPipelinesReady))
+    return;
+
+  timeline.Mark(StartupTimeline::kFirstPresent);
+  // Checked once per frame, so this lands on the first frame drawn with
+  // every pipeline.
+  if (Pipelines.PendingCount() > 0)
+    return;
+  timeline.Mark(StartupTimeline::kPipelinesReady);
 
-  wBindGroupLayoutEntries[0].binding = 0;
-  wBindGroupLayoutEntries[0].buffer.hasDynamicOffset = false;
-  wBindGroupLayoutEntries[0].visibility =
+  LogStartupTimeline();
+#if !defined(__EMSCRIPTEN__)
+  timeline.WriteJson(kStartupReportPath);
+#endif
+}
+
+void Renderer::SetupBindGroupLayouts() {
+  PHOTON_PROFILE_FUNCTION();
+  // Frame: camera matrices, time, shared sampler and the environment map.
+  wFrameBindGroupLayoutEntries[0].binding = 0;
+  wFrameBindGroupLayoutEntries[0].buffer.hasDynamicOffset = false;
+  wFrameBindGroupLayoutEntries[0].visibility =
       wgpu::ShaderStage::Vertex | wgpu::ShaderStage::Fragment;
-  wBindGroupLayoutEntries[0].buffer.type = wgpu::BufferBindingType::Uniform;
-  wBindGroupLayoutEntries[0].buffer.minBindingSize = sizeof(ShaderUniforms);
+  wFrameBindGroupLayoutEntries[0].buffer.type =
+      wgpu::BufferBindingType::Uniform;
+  wFrameBindGroupLayoutEntries[0].buffer.minBindingSize =
+      sizeof(FrameUniforms);
 
-  wBindGroupLayoutEntries[1].binding = 1;
-  wBindGroupLayoutEntries[1].visibility = wgpu::ShaderStage::Fragment;
-  wBindGroupLayoutEntries[1].sampler.type = wgpu::SamplerBindingType::Filtering;
+  wFrameBindGroupLayoutEntries[1].binding = 1;
+  wFrameBindGroupLayoutEntries[1].visibility = wgpu::ShaderStage::Fragment;
+  wFrameBindGroupLayoutEntries[1].sampler.type =
+      wgpu::SamplerBindingType::Filtering;
 
-  wBindGroupLayoutEntries[2].binding = 2;
-  wBindGroupLayoutEntries[2].visibility = wgpu::ShaderStage::Fragment;
-  wBindGroupLayoutEntries[2].texture.sampleType =
+  wFrameBindGroupLayoutEntries[2].binding = 2;
+  wFrameBindGroupLayoutEntries[2].visibility = wgpu::ShaderStage::Fragment;
+  wFrameBindGroupLayoutEntries[2].texture.sampleType =
       wgpu::TextureSampleType::Float;
-  wBindGroupLayoutEntries[2].texture.viewDimension =
+  wFrameBindGroupLayoutEntries[2].texture.viewDimension =
+      wgpu::TextureViewDimension::Cube;
+  wFrameBindGroupLayoutEntries[2].texture.multisampled = false;
+
+  // Clustered lights: light list, per-cluster light indices and the cluster
+  // grid parameters.
+  wFrameBindGroupLayoutEntries[3].binding = 3;
+  wFrameBindGroupLayoutEntries[3].visibility = wgpu::ShaderStage::Fragment;
+  wFrameBindGroupLayoutEntries[3].buffer.type =
+      wgpu::BufferBindingType::ReadOnlyStorage;
+
+  wFrameBindGroupLayoutEntries[4].binding = 4;
+  wFrameBindGroupLayoutEntries[4].visibility = wgpu::ShaderStage::Fragment;
+  wFrameBindGroupLayoutEntries[4].buffer.type =
+      wgpu::BufferBindingType::ReadOnlyStorage;
+
+  wFrameBindGroupLayoutEntries[5].binding = 5;
+  wFrameBindGroupLayoutEntries[5].visibility = wgpu::ShaderStage::Fragment;
+  wFrameBindGroupLayoutEntries[5].buffer.type =
+      wgpu::BufferBindingType::Uniform;
+  wFrameBindGroupLayoutEntries[5].buffer.minBindingSize =
+      sizeof(GpuClusterUniforms);
+
+  // Directional light: cascaded shadow map, its comparison sampler and the
+  // cascade matrices.
+  wFrameBindGroupLayoutEntries[6].binding = 6;
+  wFrameBindGroupLayoutEntries[6].visibility = wgpu::ShaderStage::Fragment;
+  wFrameBindGroupLayoutEntries[6].texture.sampleType =
+      wgpu::TextureSampleType::Depth;
+  wFrameBindGroupLayoutEntries[6].texture.viewDimension =
+      wgpu::TextureViewDimension::e2DArray;
+  wFrameBindGroupLayoutEntries[6].texture.multisampled = false;
+
+  wFrameBindGroupLayoutEntries[7].binding = 7;
+  wFrameBindGroupLayoutEntries[7].visibility = wgpu::ShaderStage::Fragment;
+  wFrameBindGroupLayoutEntries[7].sampler.type =
+      wgpu::SamplerBindingType::Comparison;
+
+  wFrameBindGroupLayoutEntries[8].binding = 8;
+  wFrameBindGroupLayoutEntries[8].visibility = wgpu::ShaderStage::Fragment;
+  wFrameBindGroupLayoutEntries[8].buffer.type =
+      wgpu::BufferBindingType::Uniform;
+  wFrameBindGroupLayoutEntries[8].buffer.minBindingSize =
+      sizeof(GpuShadowUniforms);
+
+  // Point and spot light shadow atlas and its tiles; shares the comparison
+  // sampler at binding 7.
+  wFrameBindGroupLayoutEntries[9].binding = 9;
+  wFrameBindGroupLayoutEntries[9].visibility = wgpu::ShaderStage::Fragment;
+  wFrameBindGroupLayoutEntries[9].texture.sampleType =
+      wgpu::TextureSampleType::Depth;
+  wFrameBindGroupLayoutEntries[9].texture.viewDimension =
       wgpu::TextureViewDimension::e2D;
-  wBindGroupLayoutEntries[2].texture.multisampled = false;
+  wFrameBindGroupLayoutEntries[9].texture.multisampled = false;
+
+  wFrameBindGroupLayoutEntries[10].binding = 10;
+  wFrameBindGroupLayoutEntries[10].visibility = wgpu::ShaderStage::Fragment;
+  wFrameBindGroupLayoutEntries[10].buffer.type =
+      wgpu::BufferBindingType::ReadOnlyStorage;
+
+  wgpu::BindGroupLayoutDescriptor frameLayoutDescriptor{
+      .entryCount = wFrameBindGroupLayoutEntries.size(),
+      .entries = wFrameBindGroupLayoutEntries.data()};
+  wFrameBindGroupLayout = wDevice.CreateBindGroupLayout(&frameLayoutDescriptor);
+
+  // Material: parameters and the four PBR textures.
+  wMaterialBindGroupLayoutEntries[0].binding = 0;
+  wMaterialBindGroupLayoutEntries[0].buffer.hasDynamicOffset = false;
+  wMaterialBindGroupLayoutEntries[0].visibility =
+      wgpu::ShaderStage::Vertex | wgpu::ShaderStage::Fragment;
+  wMaterialBindGroupLayoutEntries[0].buffer.type =
+      wgpu::BufferBindingType::Uniform;
+  wMaterialBindGroupLayoutEntries[0].buffer.minBindingSize =
+      sizeof(MaterialUniforms);
+
+  for (u32 i = 1; i < wMaterialBindGroupLayoutEntries.size(); ++i) {
+    wMaterialBindGroupLayoutEntries[i].binding = i;
+    wMaterialBindGroupLayoutEntries[i].visibility = wgpu::ShaderStage::Fragment;
+    wMaterialBindGroupLayoutEntries[i].texture.sampleType =
+        wgpu::TextureSampleType::Float;
+    wMaterialBindGroupLayoutEntries[i].texture.viewDimension =
+        wgpu::TextureViewDimension::e2D;
+    wMaterialBindGroupLayoutEntries[i].texture.multisampled = false;
+  }
 
-  wBindGroupLayoutEntries[3].binding = 3;
-  wBindGroupLayoutEntries[3].visibility = wgpu::ShaderStage::Fragment;
-  wBindGroupLayoutEntries[3].texture.sampleType =
-      wgpu::TextureSampleType::Float;
-  wBindGroupLayoutEntries[3].texture.viewDimension =
-      wgpu::TextureViewDimension::e2D;
-  wBindGroupLayoutEntries[3].texture.multisampled = false;
+  wgpu::BindGroupLayoutDescriptor materialLayoutDescriptor{
+      .entryCount = wMaterialBindGroupLayoutEntries.size(),
+      .entries = wMaterialBindGroupLayoutEntries.data()};
+  wMaterialBindGroupLayout =
+      wDevice.CreateBindGroupLayout(&materialLayoutDescriptor);
+
+  // Object: model matrix, one slot per object selected by dynamic offset.
+  wObjectBindGroupLayoutEntries[0].binding = 0;
+  wObjectBindGroupLayoutEntries[0].buffer.hasDynamicOffset = true;
+  wObjectBindGroupLayoutEntries[0].visibility = wgpu::ShaderStage::Vertex;
+  wObjectBindGroupLayoutEntries[0].buffer.type =
+      wgpu::BufferBindingType::Uniform;
+  wObjectBindGroupLayoutEntries[0].buffer.minBindingSize =
+      sizeof(ObjectUniforms);
+
+  wgpu::BindGroupLayoutDescriptor objectLayoutDescriptor{
+      .entryCount = wObjectBindGroupLayoutEntries.size(),
+      .entries = wObjectBindGroupLayoutEntries.data()};
+  wObjectBindGroupLayout =
+      wDevice.CreateBindGroupLayout(&objectLayoutDescriptor);
+}
 
-  wBindGroupLayoutEntries[4].binding = 4;
-  wBindGroupLayoutEntries[4].visibility = wgpu::ShaderStage::Fragment;
-  wBindGroupLayoutEntries[4].texture.sampleType =
-      wgpu::TextureSampleType::Float;
-  wBindGroupLayoutEntries[4].texture.viewDimension =
-      wgpu::TextureViewDimension::e2D;
-  wBindGroupLayoutEntries[4].texture.multisampled = false;
+void Renderer::SetupFrameBindGroup() {
+  PHOTON_PROFILE_FUNCTION();
+  std::array<wgpu::BindGroupEntry, 11> entries{};
 
-  wBindGroupLayoutEntries[5].binding = 5;
-  wBindGroupLayoutEntries[5].visibility = wgpu::ShaderStage::Fragment;
-  wBindGroupLayoutEntries[5].texture.sampleType =
-      wgpu::TextureSampleType::Float;
-  wBindGroupLayoutEntries[5].texture.viewDimension =
-      wgpu::TextureViewDimension::e2D;
-  wBindGroupLayoutEntries[5].texture.multisampled = false;
+  entries[0].binding = 0;
+  entries[0].buffer = wFrameUniformBuffer;
+  entries[0].offset = 0;
+  entries[0].size = sizeof(FrameUniforms);
 
-  wBindGroupLayoutEntries[6].binding = 6;
-  wBindGroupLayoutEntries[6].visibility = wgpu::ShaderStage::Fragment;
-  wBindGroupLayoutEntries[6].texture.sampleType =
-      wgpu::TextureSampleType::Float;
-  wBindGroupLayoutEntries[6].texture.viewDimension =
-      wgpu::TextureViewDimension::Cube;
-  wBindGroupLayoutEntries[6].texture.multisampled = false;
+  entries[1].binding = 1;
+  entries[1].sampler = wSampler;
+
+  entries[2].binding = 2;
+  entries[2].textureView = wSkyboxTextureView;
+
+  entries[3].binding = 3;
+  entries[3].buffer = Lighting.GetLightBuffer();
+  entries[3].size = Lighting.GetLightBuffer().GetSize();
+
+  entries[4].binding = 4;
+  entries[4].buffer = Lighting.GetClusterBuffer();
+  entries[4].size = Lighting.GetClusterBuffer().GetSize();
 
-  wgpu::BindGroupLayoutDescriptor bindGroupLayoutDescriptor{
-      .entryCount = static_cast<uint32_t>(wBindGroupLayoutEntries.size()),
-      .entries = wBindGroupLayoutEntries.data()};
+  entries[5].binding = 5;
+  entries[5].buffer = Lighting.GetUniformBuffer();
+  entries[5].size = sizeof(GpuClusterUniforms);
 
-  wBindGroupLayout = wDevice.CreateBindGroupLayout(&bindGroupLayoutDescriptor);
+  entries[6].binding = 6;
+  entries[6].textureView = Shadows.GetShadowMapView();
+
+  entries[7].binding = 7;
+  entries[7].sampler = Shadows.GetSampler();
+
+  entries[8].binding = 8;
+  entries[8].buffer = Shadows.GetUniformBuffer();
+  entries[8].size = sizeof(GpuShadowUniforms);
+
+  entries[9].binding = 9;
+  entries[9].textureView = Atlas.GetTextureView();
+
+  entries[10].binding = 10;
+  entries[10].buffer = Atlas.GetTileBuffer();
+  entries[10].size = Atlas.GetTileBuffer().GetSize();
+
+  wgpu::BindGroupDescriptor bindGroupDescriptor{
+      .layout = wFrameBindGroupLayout,
+      .entryCount = entries.size(),
+      .entries = entries.data()};
+
+  wFrameBindGroup = wDevice.CreateBindGroup(&bindGroupDescriptor);
 }
 
-void Renderer::SetupMeshBindGroup() {
-  wBindGroupEntries.resize(7, {});
+void Renderer::SetupMaterialBindGroup(CMaterial &material) {
+  PHOTON_PROFILE_FUNCTION();
+  std::array<wgpu::BindGroupEntry, 5> entries{};
 
-  wBindGroupEntries[0].binding = 0;
-  wBindGroupEntries[0].buffer = wUniformBuffer;
-  wBindGroupEntries[0].offset = 0;
-  wBindGroupEntries[0].size = sizeof(ShaderUniforms);
+  entries[0].binding = 0;
+  entries[0].buffer = material.uniformBuffer;
+  entries[0].offset = 0;
+  entries[0].size = sizeof(MaterialUniforms);
 
-  wBindGroupEntries[1].binding = 1;
-  wBindGroupEntries[1].sampler = wSampler;
+  entries[1].binding = 1;
+  entries[1].textureView = material.albedoTextureView;
 
-  wBindGroupEntries[2].binding = 2;
-  wBindGroupEntries[2].textureView = wAlbedoTextureView;
+  entries[2].binding = 2;
+  entries[2].textureView = material.normalTextureView;
 
-  wBindGroupEntries[3].binding = 3;
-  wBindGroupEntries[3].textureView = wNormalTextureView;
+  entries[3].binding = 3;
+  entries[3].textureView = material.metallicTextureView;
 
-  wBindGroupEntries[4].binding = 4;
-  wBindGroupEntries[4].textureView = wMetallicTextureView;
+  entries[4].binding = 4;
+  entries[4].textureView = material.roughnessTextureView;
 
-  wBindGroupEntries[5].binding = 5;
-  wBindGroupEntries[5].textureView = wRoughnessTextureView;
+  wgpu::BindGroupDescriptor bindGroupDescriptor{
+      .layout = wMaterialBindGroupLayout,
+      .entryCount = entries.size(),
+      .entries = entries.data()};
+
+  material.bindGroup = wDevice.CreateBindGroup(&bindGroupDescriptor);
+}
 
-  wBindGroupEntries[6].binding = 6;
-  wBindGroupEntries[6].textureView = wSkyboxTextureView;
+void Renderer::SetupObjectBindGroup() {
+  PHOTON_PROFILE_FUNCTION();
+  wgpu::BindGroupEntry entry{.binding = 0,
+                             .buffer = wObjectUniformBuffer,
+                             .offset = 0,
+                             .size = sizeof(ObjectUniforms)};
 
   wgpu::BindGroupDescriptor bindGroupDescriptor{
-      .layout = wBindGroupLayout,
-      .entryCount = static_cast<uint32_t>(wBindGroupEntries.size()),
-      .entries = wBindGroupEntries.data()};
+      .layout = wObjectBindGroupLayout, .entryCount = 1, .entries = &entry};
 
-  wBindGroup = wDevice.CreateBindGroup(&bindGroupDescriptor);
+  wObjectBindGroup = wDevice.CreateBindGroup(&bindGroupDescriptor);
 }
 
 void Renderer::SetupSampler() {
+  PHOTON_PROFILE_FUNCTION();
   wgpu::SamplerDescriptor samplerDescriptor{
       .addressModeU = wgpu::AddressMode::ClampToEdge,
       .addressModeV = wgpu::AddressMode::ClampToEdge,
@@ -481,26 +1311,27 @@ void Renderer::SetupSampler() {
   wSampler = wDevice.CreateSampler(&samplerDescriptor);
 }
 
-void Renderer::SetupMeshUniformBuffer() {
+void Renderer::SetupUniformBuffers() {
+  PHOTON_PROFILE_FUNCTION();
   wgpu::BufferDescriptor bufferDescriptor{.usage = wgpu::BufferUsage::Uniform |
                                                    wgpu::BufferUsage::CopyDst,
-                                          .size = sizeof(ShaderUniforms),
+                                          .size = sizeof(FrameUniforms),
                                           .mappedAtCreation = false};
 
-  wUniformBuffer = wDevice.CreateBuffer(&bufferDescriptor);
-  ShaderUniforms uniforms{};
-  wDevice.GetQueue().WriteBuffer(wUniformBuffer, 0, &uniforms,
-                                 sizeof(ShaderUniforms));
+  wFrameUniformBuffer = wDevice.CreateBuffer(&bufferDescriptor);
+  FrameUniforms uniforms{};
+  wDevice.GetQueue().WriteBuffer(wFrameUniformBuffer, 0, &uniforms,
+                                 sizeof(FrameUniforms));
+  Stats.CountBufferUpload(sizeof(FrameUniforms));
 
-  bufferDescriptor.size = sizeof(SkyboxMapUniforms);
-  wSkyboxUniformBuffer = wDevice.CreateBuffer(&bufferDescriptor);
-  SkyboxMapUniforms cubeMapUniforms{};
-  wDevice.GetQueue().WriteBuffer(wSkyboxUniformBuffer, 0, &cubeMapUniforms,
-                                 sizeof(SkyboxMapUniforms));
+  ObjectCapacity = kInitialObjectCapacity;
+  bufferDescriptor.size = ObjectCapacity * kObjectUniformStride;
+  wObjectUniformBuffer = wDevice.CreateBuffer(&bufferDescriptor);
 }
 
-void Renderer::LoadTextures(const std::string &name,
-                            const ETextureImportType type) {
+u32 Renderer::LoadMaterial(const std::string &name,
+                           const ETextureImportType type) {
+  PHOTON_PROFILE_FUNCTION();
   std::string suffix = "";
 
   switch (type) {
@@ -514,52 +1345,103 @@ void Renderer::LoadTextures(const std::string &name,
     break;
   }
 
-  if (wAlbedoTexture = ResourceLoader::LoadTexture(
-          (name + "_c" + suffix).c_str(), wDevice, type, &wAlbedoTextureView);
-      !wAlbedoTexture) {
+  CMaterial material{};
+  material.Name = name;
+
+  if (material.albedoTexture = ResourceLoader::LoadTexture(
+          (name + "_c" + suffix).c_str(), wDevice, type,
+          &material.albedoTextureView);
+      !material.albedoTexture) {
     LogError("Could not load albedo texture!");
   }
 
-  if (wNormalTexture = ResourceLoader::LoadTexture(
-          (name + "_n" + suffix).c_str(), wDevice, type, &wNormalTextureView);
-      !wNormalTexture) {
+  if (material.normalTexture = ResourceLoader::LoadTexture(
+          (name + "_n" + suffix).c_str(), wDevice, type,
+          &material.normalTextureView);
+      !material.normalTexture) {
     LogError("Could not load normal texture!");
   }
 
-  if (wRoughnessTexture =
-          ResourceLoader::LoadTexture((name + "_r" + suffix).c_str(), wDevice,
-                                      type, &wRoughnessTextureView);
-      !wRoughnessTexture) {
+  if (material.roughnessTexture = ResourceLoader::LoadTexture(
+          (name + "_r" + suffix).c_str(), wDevice, type,
+          &material.roughnessTextureView);
+      !material.roughnessTexture) {
     LogError("Could not load roughness texture!");
   }
 
-  if (wMetallicTexture = ResourceLoader::LoadTexture(
-          (name + "_m" + suffix).c_str(), wDevice, type, &wMetallicTextureView);
-      !wMetallicTexture) {
+  if (material.metallicTexture = ResourceLoader::LoadTexture(
+          (name + "_m" + suffix).c_str(), wDevice, type,
+          &material.metallicTextureView);
+      !material.metallicTexture) {
     LogError("Could not load metallic texture!");
   }
 
-  if (wSkyboxTexture = ResourceLoader::LoadCubeMap(
-          "golden_bay", wDevice, ETextureImportType::png, &wSkyboxTextureView);
+  wgpu::BufferDescriptor bufferDescriptor{.label = material.Name.c_str(),
+                                          .usage = wgpu::BufferUsage::Uniform |
+                                                   wgpu::BufferUsage::CopyDst,
+                                          .size = sizeof(MaterialUniforms),
+                                          .mappedAtCreation = false};
+  material.uniformBuffer = wDevice.CreateBuffer(&bufferDescriptor);
+  material.pipeline = MeshPipeline;
+  material.depthEqualPipeline = MeshDepthEqualPipeline;
+
+  SetupMaterialBindGroup(material);
+
+  Materials.push_back(material);
+  return static_cast<u32>(Materials.size() - 1);
+}
+
+void Renderer::LoadSkybox(const std::string &name,
+                          const ETextureImportType type) {
+  PHOTON_PROFILE_FUNCTION();
+  if (wSkyboxTexture = ResourceLoader::LoadCubeMap(name.c_str(), wDevice, type,
+                                                   &wSkyboxTextureView);
       !wSkyboxTexture) {
     LogError("Could not load cubemap texture!");
   }
 }
 
 void Renderer::SetupDepthStencil() {
+  PHOTON_PROFILE_FUNCTION();
   wDepthStencilState = wgpu::DepthStencilState{
-      .format = wgpu::TextureFormat::Depth16Unorm,
+      .format = wgpu::TextureFormat::Depth32Float,
       .depthWriteEnabled = true,
       .depthCompare = wgpu::CompareFunction::LessEqual,
       .stencilReadMask = 0,
       .stencilWriteMask = 0,
   };
 
+  wDepthEqualState = wDepthStencilState;
+  wDepthEqualState.depthWriteEnabled = false;
+  wDepthEqualState.depthCompare = wgpu::CompareFunction::Equal;
+}
+
+void Renderer::SetupRenderTargets() {
+  PHOTON_PROFILE_FUNCTION();
+  const u32 width = Resolution.GetRenderWidth();
+  const u32 height = Resolution.GetRenderHeight();
+
+  // Same format as the swap chain so every pipeline can target either.
+  wgpu::TextureDescriptor colorTextureDescriptor{
+      .label = "Scene Color",
+      .usage = wgpu::TextureUsage::RenderAttachment |
+               wgpu::TextureUsage::TextureBinding,
+      .dimension = wgpu::TextureDimension::e2D,
+      .size = {width, height, 1},
+      .format = wgpu::TextureFormat::BGRA8Unorm,
+      .mipLevelCount = 1,
+      .sampleCount = 1,
+  };
+  wSceneColorTexture = wDevice.CreateTexture(&colorTextureDescriptor);
+  wSceneColorTextureView = wSceneColorTexture.CreateView();
+
   wgpu::TextureDescriptor depthTextureDescriptor{
-      .usage = wgpu::TextureUsage::RenderAttachment,
+      // Sampled by the depth pyramid build.
+      .usage = wgpu::TextureUsage::RenderAttachment |
+               wgpu::TextureUsage::TextureBinding,
       .dimension = wgpu::TextureDimension::e2D,
-      .size = {kWidth, kHeight, 1},
-      .format = wgpu::TextureFormat::Depth16Unorm,
+      .size = {width, height, 1},
+      .format = wgpu::TextureFormat::Depth32Float,
       .mipLevelCount = 1,
       .sampleCount = 1,
       .viewFormatCount = 1,
@@ -580,7 +1462,122 @@ void Renderer::SetupDepthStencil() {
   wDepthTextureView = wDepthTexture.CreateView(&depthTextureViewDescriptor);
 }
 
+void Renderer::ResizeRenderTargets() {
+  PHOTON_PROFILE_FUNCTION();
+  SetupRenderTargets();
+
+  const u32 width = Resolution.GetRenderWidth();
+  const u32 height = Resolution.GetRenderHeight();
+  HiZ.Init(wDevice, wDepthTextureView, width, height);
+  Lighting.Resize(width, height);
+  SetupUpscaleBindGroup();
+  // The cull bind group still references the old pyramid.
+  bGpuSceneDirty = true;
+}
+
+void Renderer::SetupUpscale() {
+  PHOTON_PROFILE_FUNCTION();
+  std::array<wgpu::BindGroupLayoutEntry, 3> layoutEntries{};
+  layoutEntries[0].binding = 0;
+  layoutEntries[0].visibility = wgpu::ShaderStage::Fragment;
+  layoutEntries[0].texture.sampleType = wgpu::TextureSampleType::Float;
+  layoutEntries[0].texture.viewDimension = wgpu::TextureViewDimension::e2D;
+  layoutEntries[0].texture.multisampled = false;
+
+  layoutEntries[1].binding = 1;
+  layoutEntries[1].visibility = wgpu::ShaderStage::Fragment;
+  layoutEntries[1].sampler.type = wgpu::SamplerBindingType::Filtering;
+
+  layoutEntries[2].binding = 2;
+  layoutEntries[2].visibility = wgpu::ShaderStage::Fragment;
+  layoutEntries[2].buffer.type = wgpu::BufferBindingType::Uniform;
+  layoutEntries[2].buffer.minBindingSize = sizeof(UpscaleUniforms);
+
+  wgpu::BindGroupLayoutDescriptor layoutDescriptor{
+      .entryCount = layoutEntries.size(), .entries = layoutEntries.data()};
+  wUpscaleBindGroupLayout = wDevice.CreateBindGroupLayout(&layoutDescriptor);
+
+  wgpu::PipelineLayoutDescriptor pipelineLayoutDescriptor{
+      .bindGroupLayoutCount = 1, .bindGroupLayouts = &wUpscaleBindGroupLayout};
+  wUpscalePipelineLayout =
+      wDevice.CreatePipelineLayout(&pipelineLayoutDescriptor);
+
+  wgpu::BufferDescriptor bufferDescriptor{.label = "Upscale Uniforms",
+                                          .usage = wgpu::BufferUsage::Uniform |
+                                                   wgpu::BufferUsage::CopyDst,
+                                          .size = sizeof(UpscaleUniforms),
+                                          .mappedAtCreation = false};
+  wUpscaleUniformBuffer = wDevice.CreateBuffer(&bufferDescriptor);
+
+  // A fragment pass rather than compute: writing the BGRA8 swap chain as a
+  // storage texture needs an optional feature.
+  UpscalePipeline = Pipelines.Request({
+      .Label = "Upscale",
+      .ShaderPath = "shaders/upscale.wgsl",
+      .VertexEntryPoint = "vs_main",
+      .FragmentEntryPoint = "fs_main",
+      .ColorFormat = wgpu::TextureFormat::BGRA8Unorm,
+      .Layout = wUpscalePipelineLayout,
+  });
+
+  SetupUpscaleBindGroup();
+}
+
+void Renderer::SetupUpscaleBindGroup() {
+  PHOTON_PROFILE_FUNCTION();
+  std::array<wgpu::BindGroupEntry, 3> entries{};
+  entries[0].binding = 0;
+  entries[0].textureView = wSceneColorTextureView;
+
+  entries[1].binding = 1;
+  entries[1].sampler = wSampler;
+
+  entries[2].binding = 2;
+  entries[2].buffer = wUpscaleUniformBuffer;
+  entries[2].size = sizeof(UpscaleUniforms);
+
+  wgpu::BindGroupDescriptor bindGroupDescriptor{
+      .layout = wUpscaleBindGroupLayout,
+      .entryCount = entries.size(),
+      .entries = entries.data()};
+  wUpscaleBindGroup = wDevice.CreateBindGroup(&bindGroupDescriptor);
+
+  const UpscaleUniforms uniforms{
+      .m_SourceSize = v2f(static_cast<f32>(Resolution.GetRenderWidth()),
+                          static_cast<f32>(Resolution.GetRenderHeight())),
+      .m_Sharpness = Sharpness};
+  wDevice.GetQueue().WriteBuffer(wUpscaleUniformBuffer, 0, &uniforms,
+                                 sizeof(UpscaleUniforms));
+  Stats.CountBufferUpload(sizeof(UpscaleUniforms));
+}
+
+void Renderer::Upscale(wgpu::CommandEncoder &encoder) {
+  PHOTON_PROFILE_FUNCTION();
+  wgpu::RenderPassColorAttachment attachment{
+      .view = GetOutputView(),
+      .loadOp = wgpu::LoadOp::Clear,
+      .storeOp = wgpu::StoreOp::Store};
+  wgpu::RenderPassDescriptor descriptor{
+      .label = "Upscale",
+      .colorAttachmentCount = 1,
+      .colorAttachments = &attachment,
+      .timestampWrites = Profiler.RenderPass("Upscale")};
+  wgpu::RenderPassEncoder pass = encoder.BeginRenderPass(&descriptor);
+
+  // Until the pipeline is ready the frame is just cleared.
+  if (wgpu::RenderPipeline pipeline = Pipelines.Get(UpscalePipeline)) {
+    pass.SetPipeline(pipeline);
+    pass.SetBindGroup(0, wUpscaleBindGroup);
+    pass.Draw(3);
+    Stats.CountPipelineSwitch();
+    Stats.CountBindGroupSwitch();
+    Stats.CountDraw(3);
+  }
+  pass.End();
+}
+
 void Renderer::SetupMeshVertexBuffers() {
+  PHOTON_PROFILE_FUNCTION();
   wVertexAttributes.resize(6, {});
 
   wVertexAttributes[0].shaderLocation = 0;
@@ -661,152 +1658,489 @@ void Renderer::SetupMeshVertexBuffers() {
   wSkyboxVertexBufferLayout.stepMode = wgpu::VertexStepMode::Vertex;
 }
 
-void Renderer::DrawMesh(wgpu::RenderPassEncoder &renderPass) {
-  renderPass.SetPipeline(wRenderPipeline);
-  renderPass.SetBindGroup(0, wBindGroup, 0, nullptr);
-
-  auto &positionBuffer = Mesh.positionBuffer;
-  auto &normalBuffer = Mesh.normalBuffer;
-  auto &tangentBuffer = Mesh.tangentBuffer;
-  auto &bitangentBuffer = Mesh.bitangentBuffer;
-  auto &uvBuffer = Mesh.uvBuffer;
-  auto &colorBuffer = Mesh.colorBuffer;
-  auto &indexBuffer = Mesh.indexBuffer;
-
-  auto &pointData = Mesh.pointData;
-  auto &normalData = Mesh.normalData;
-  auto &tangentData = Mesh.tangentData;
-  auto &bitangentData = Mesh.bitangentData;
-  auto &colorData = Mesh.colorData;
-  auto &uvData = Mesh.uvData;
-
-  auto &indexData = Mesh.indexData;
-  auto &indexCount = Mesh.indexCount;
-
-  renderPass.SetVertexBuffer(0, positionBuffer, 0,
-                             pointData.size() * sizeof(f32));
-  renderPass.SetVertexBuffer(1, normalBuffer, 0,
-                             normalData.size() * sizeof(f32));
-  renderPass.SetVertexBuffer(2, tangentBuffer, 0,
-                             tangentData.size() * sizeof(f32));
-  renderPass.SetVertexBuffer(3, bitangentBuffer, 0,
-                             bitangentData.size() * sizeof(f32));
-  renderPass.SetVertexBuffer(4, colorBuffer, 0, colorData.size() * sizeof(f32));
-  renderPass.SetVertexBuffer(5, uvBuffer, 0, uvData.size() * sizeof(f32));
-  renderPass.SetIndexBuffer(indexBuffer, wgpu::IndexFormat::Uint16, 0,
-                            indexData.size() * sizeof(u16));
-  renderPass.DrawIndexed(indexCount, 1, 0, 0, 0);
+template <typename Encoder>
+void Renderer::SetPipeline(Encoder &encoder,
+                           const wgpu::RenderPipeline &pipeline) {
+  if (PassState.SetPipeline(encoder, pipeline))
+    Stats.CountPipelineSwitch();
 }
 
-void Renderer::SetupCamera() {
-  Camera = CCamera();
-  Camera.Position = v3f(0.0f, 0.0f, 3.0f);
-  Camera.Front = v3f(0.0f, 0.0f, -1.0f);
-  Camera.Up = v3f(0.0f, 1.0f, 0.0f);
-  Camera.Right = v3f(1.0f, 0.0f, 0.0f);
+template <typename Encoder>
+void Renderer::SetBindGroup(Encoder &encoder, u32 groupIndex,
+                            const wgpu::BindGroup &group, u32 dynamicOffset) {
+  if (PassState.SetBindGroup(encoder, groupIndex, group, dynamicOffset))
+    Stats.CountBindGroupSwitch();
 }
 
-void Renderer::SetupSkyboxPipeline() {
-  wgpu::ShaderModuleWGSLDescriptor wgslDesc{};
-  wgslDesc.code = Reader::ReadTextFile("shaders/cubemap.wgsl");
+template <typename Encoder>
+void Renderer::DrawMesh(Encoder &renderPass, u32 objectIndex) {
+  const RenderObject &object = Objects[objectIndex];
+  const CMaterial &material = Materials[object.MaterialIndex];
 
-  wgpu::ShaderModuleDescriptor shaderModuleDescriptor{.nextInChain = &wgslDesc};
-  shaderModuleDescriptor.label = "CubeMap Shader Module";
-  wgpu::ShaderModule shaderModule =
-      wDevice.CreateShaderModule(&shaderModuleDescriptor);
+  wgpu::RenderPipeline pipeline = GetMeshPipeline(material);
+  if (!pipeline)
+    return;
 
-  wgpu::ColorTargetState colorTargetState{.format =
-                                              wgpu::TextureFormat::BGRA8Unorm};
+  EncodeMeshDraw(renderPass, PassState, Stats, pipeline, wFrameBindGroup,
+                 material.bindGroup, wObjectBindGroup, objectIndex,
+                 Meshes[object.MeshIndex]);
+}
 
-  wgpu::FragmentState fragmentState{
-      .module = shaderModule, .targetCount = 1, .targets = &colorTargetState};
+template <typename Encoder>
+void Renderer::DrawMeshDepth(Encoder &renderPass, u32 objectIndex) {
+  const RenderObject &object = Objects[objectIndex];
+  const CMesh &mesh = Meshes[object.MeshIndex];
 
-  wgpu::PipelineLayoutDescriptor pipelineLayoutDescriptor{
-      .bindGroupLayoutCount = 1, .bindGroupLayouts = &wSkyboxBindGroupLayout};
+  wgpu::RenderPipeline pipeline = Pipelines.Get(DepthPrepassPipeline);
+  if (!pipeline)
+    return;
 
-  wgpu::PipelineLayout pipelineLayout =
-      wDevice.CreatePipelineLayout(&pipelineLayoutDescriptor);
+  // Shares the mesh pipeline layout, so the material group is bound as well.
+  SetPipeline(renderPass, pipeline);
+  SetBindGroup(renderPass, kFrameBindGroup, wFrameBindGroup);
+  SetBindGroup(renderPass, kMaterialBindGroup,
+               Materials[object.MaterialIndex].bindGroup);
+  SetBindGroup(renderPass, kObjectBindGroup, wObjectBindGroup,
+               objectIndex * kObjectUniformStride);
+
+  renderPass.SetVertexBuffer(0, mesh.positionBuffer, 0,
+                             mesh.pointData.size() * sizeof(f32));
+  renderPass.SetIndexBuffer(mesh.indexBuffer, wgpu::IndexFormat::Uint16, 0,
+                            mesh.indexData.size() * sizeof(u16));
+  renderPass.DrawIndexed(mesh.indexCount, 1, 0, 0, 0);
+  Stats.CountDraw(mesh.indexCount);
+}
 
-  wgpu::RenderPipelineDescriptor descriptor{
-      .label = "CubeMap",
-      .layout = pipelineLayout,
-      .vertex = {.module = shaderModule},
-      .depthStencil = &wDepthStencilState,
-      .fragment = &fragmentState,
-  };
+u32 Renderer::AddObject(const RenderObject &object) {
+  Objects.push_back(object);
+  if (object.bStatic) {
+    bStaticBundleDirty = true;
+    Shadows.InvalidateCache();
+  }
+  bGpuSceneDirty = true;
+
+  const u32 objectIndex = static_cast<u32>(Objects.size() - 1);
+  ReserveObjects(static_cast<u32>(Objects.size()));
+  Culler.Resize(static_cast<u32>(Objects.size()));
+  UpdateObjectBounds(objectIndex);
+  MarkObjectDirty(objectIndex);
+  return objectIndex;
+}
 
-  //    descriptor.vertex.bufferCount = 1;
-  //    descriptor.vertex.buffers = &wCubeMapVertexBufferLayout;
+void Renderer::MarkObjectDirty(u32 objectIndex) {
+  Objects[objectIndex].bDirty = true;
+  if (DirtyObjectsBegin == DirtyObjectsEnd) {
+    DirtyObjectsBegin = objectIndex;
+    DirtyObjectsEnd = objectIndex + 1;
+    return;
+  }
+  DirtyObjectsBegin = std::min(DirtyObjectsBegin, objectIndex);
+  DirtyObjectsEnd = std::max(DirtyObjectsEnd, objectIndex + 1);
+}
 
-  wCubeMapPipeline = wDevice.CreateRenderPipeline(&descriptor);
+void Renderer::ReserveObjects(u32 count) {
+  if (count <= ObjectCapacity)
+    return;
+
+  PHOTON_PROFILE_FUNCTION();
+  ObjectCapacity = std::max(count, ObjectCapacity * 2);
+  wgpu::BufferDescriptor descriptor{
+      .label = "Object Uniforms",
+      .usage = wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst,
+      .size = static_cast<u64>(ObjectCapacity) * kObjectUniformStride};
+  wObjectUniformBuffer = wDevice.CreateBuffer(&descriptor);
+  SetupObjectBindGroup();
+
+  // The new buffer starts empty, and the static bundle binds the old one.
+  DirtyObjectsBegin = 0;
+  DirtyObjectsEnd = static_cast<u32>(Objects.size());
+  bStaticBundleDirty = true;
 }
 
-void Renderer::SetupSkyboxBindGroupLayout() {
-  wSkyboxBindGroupEntryLayouts[0].binding = 0;
-  wSkyboxBindGroupEntryLayouts[0].buffer.hasDynamicOffset = false;
-  wSkyboxBindGroupEntryLayouts[0].visibility =
-      wgpu::ShaderStage::Vertex | wgpu::ShaderStage::Fragment;
-  wSkyboxBindGroupEntryLayouts[0].buffer.type =
-      wgpu::BufferBindingType::Uniform;
-  wSkyboxBindGroupEntryLayouts[0].buffer.minBindingSize = sizeof(SkyboxMapUniforms);
+void Renderer::UploadDirtyObjects() {
+  if (DirtyObjectsBegin == DirtyObjectsEnd)
+    return;
 
-  wSkyboxBindGroupEntryLayouts[1].binding = 1;
-  wSkyboxBindGroupEntryLayouts[1].visibility = wgpu::ShaderStage::Fragment;
-  wSkyboxBindGroupEntryLayouts[1].sampler.type =
-      wgpu::SamplerBindingType::Filtering;
+  PHOTON_PROFILE_FUNCTION();
+  const u32 first = DirtyObjectsBegin;
+  const u32 count = DirtyObjectsEnd - DirtyObjectsBegin;
+  DirtyObjectsBegin = DirtyObjectsEnd = 0;
+
+  // The last slot only needs its uniforms, not the padding to the stride.
+  const size_t size =
+      static_cast<size_t>(count - 1) * kObjectUniformStride +
+      sizeof(ObjectUniforms);
+  ObjectUploadData.resize(size);
+  for (u32 i = first; i < first + count; ++i) {
+    RenderObject &object = Objects[i];
+    const ObjectUniforms uniforms{.m_Model = object.Transform};
+    memcpy(ObjectUploadData.data() +
+               static_cast<size_t>(i - first) * kObjectUniformStride,
+           &uniforms, sizeof(ObjectUniforms));
+
+    if (!object.bDirty)
+      continue;
+    UpdateObjectBounds(i);
+    if (object.bStatic)
+      Shadows.InvalidateCache();
+    object.bDirty = false;
+  }
 
-  wSkyboxBindGroupEntryLayouts[2].binding = 2;
-  wSkyboxBindGroupEntryLayouts[2].visibility = wgpu::ShaderStage::Fragment;
-  wSkyboxBindGroupEntryLayouts[2].texture.sampleType =
-      wgpu::TextureSampleType::Float;
-  wSkyboxBindGroupEntryLayouts[2].texture.viewDimension =
-      wgpu::TextureViewDimension::Cube;
-  wSkyboxBindGroupEntryLayouts[2].texture.multisampled = false;
+  wDevice.GetQueue().WriteBuffer(wObjectUniformBuffer,
+                                 first * kObjectUniformStride,
+                                 ObjectUploadData.data(), size);
+  Stats.CountBufferUpload(size);
+
+  // A pending rebuild uploads every instance anyway.
+  if (bGpuDriven && !bGpuSceneDirty)
+    Scene.UpdateInstances(first, count, Objects, Meshes);
+}
 
-  wgpu::BindGroupLayoutDescriptor bindGroupLayoutDescriptor{
-      .entryCount = wSkyboxBindGroupEntryLayouts.size(),
-      .entries = wSkyboxBindGroupEntryLayouts.data()};
+void Renderer::UpdateObjectBounds(u32 objectIndex) {
+  const RenderObject &object = Objects[objectIndex];
+  const CMesh &mesh = Meshes[object.MeshIndex];
 
-  wSkyboxBindGroupLayout =
-      wDevice.CreateBindGroupLayout(&bindGroupLayoutDescriptor);
+  const v4f sphere = TransformBoundingSphere(
+      object.Transform, mesh.boundsCenter, mesh.boundsRadius);
+  // Atlas tiles of lights near either the old or the new bounds are stale.
+  Atlas.InvalidateSphere(Culler.GetSphere(objectIndex));
+  Atlas.InvalidateSphere(sphere);
+  Culler.SetSphere(objectIndex, v3f(sphere), sphere.w);
 }
 
-void Renderer::SetupSkyboxBindGroup() {
-  wSkyboxBindGroupEntries[0].binding = 0;
-  wSkyboxBindGroupEntries[0].buffer = wSkyboxUniformBuffer;
-  wSkyboxBindGroupEntries[0].offset = 0;
-  wSkyboxBindGroupEntries[0].size = sizeof(SkyboxMapUniforms);
+void Renderer::RecordStaticBundle() {
+  PHOTON_PROFILE_FUNCTION();
+  wStaticBundle = nullptr;
+  wStaticDepthBundle = nullptr;
+  BundledObjects.clear();
+
+  // Wait for the exact pipelines rather than baking fallbacks into the bundle.
+  bool bHasStatic = false;
+  for (const RenderObject &object : Objects) {
+    if (!object.bStatic)
+      continue;
+    if (!Pipelines.IsReady(
+            GetMeshPipelineHandle(Materials[object.MaterialIndex])))
+      return;
+    bHasStatic = true;
+  }
+
+  bStaticBundleDirty = false;
+  bStaticBundlePrepass = bDepthPrepassActive;
+  if (!bHasStatic)
+    return;
 
-  wSkyboxBindGroupEntries[1].binding = 1;
-  wSkyboxBindGroupEntries[1].sampler = wSampler;
+  wgpu::TextureFormat colorFormat = wgpu::TextureFormat::BGRA8Unorm;
+  wgpu::RenderBundleEncoderDescriptor descriptor{
+      .label = "Static Geometry",
+      .colorFormatCount = 1,
+      .colorFormats = &colorFormat,
+      .depthStencilFormat = wDepthStencilState.format,
+  };
+  wgpu::RenderBundleEncoder encoder =
+      wDevice.CreateRenderBundleEncoder(&descriptor);
+
+  // Count the bundle's commands on their own; they are added to each frame
+  // that executes it.
+  const FrameStats frameStats = Stats.GetCurrent();
+  Stats.GetCurrent() = {};
+  PassState = {};
+  for (u32 i = 0; i < Objects.size(); ++i) {
+    if (!Objects[i].bStatic)
+      continue;
+    DrawMesh(encoder, i);
+    BundledObjects.push_back(i);
+  }
+  PassState = {};
+  StaticBundleStats = Stats.GetCurrent();
 
-  wSkyboxBindGroupEntries[2].binding = 2;
-  wSkyboxBindGroupEntries[2].textureView = wSkyboxTextureView;
+  wStaticBundle = encoder.Finish();
 
-  wgpu::BindGroupDescriptor bindGroupDescriptor{
-      .layout = wSkyboxBindGroupLayout,
-      .entryCount = wSkyboxBindGroupEntries.size(),
-      .entries = wSkyboxBindGroupEntries.data()};
+  if (!bDepthPrepassActive) {
+    Stats.GetCurrent() = frameStats;
+    return;
+  }
+
+  wgpu::RenderBundleEncoderDescriptor depthDescriptor{
+      .label = "Static Geometry Depth",
+      .colorFormatCount = 0,
+      .depthStencilFormat = wDepthStencilState.format,
+  };
+  wgpu::RenderBundleEncoder depthEncoder =
+      wDevice.CreateRenderBundleEncoder(&depthDescriptor);
+
+  Stats.GetCurrent() = {};
+  PassState = {};
+  for (u32 i = 0; i < Objects.size(); ++i) {
+    if (Objects[i].bStatic)
+      DrawMeshDepth(depthEncoder, i);
+  }
+  PassState = {};
+  StaticDepthBundleStats = Stats.GetCurrent();
+  Stats.GetCurrent() = frameStats;
+
+  wStaticDepthBundle = depthEncoder.Finish();
+}
+
+void Renderer::SetupCamera() {
+  PHOTON_PROFILE_FUNCTION();
+  Camera = CCamera();
+  Camera.Position = v3f(0.0f, 0.0f, 3.0f);
+  Camera.Target = v3f(0.0f);
+  Camera.Front = v3f(0.0f, 0.0f, -1.0f);
+  Camera.Up = v3f(0.0f, 1.0f, 0.0f);
+  Camera.Right = v3f(1.0f, 0.0f, 0.0f);
+  Camera.Fov = Options.Scene.CameraFov;
+  Camera.Aspect = (f32)kWidth / (f32)kHeight;
+  Camera.Near = 0.1f;
+  Camera.Far = 100.0f;
+}
+
+void Renderer::SetupLights() {
+  PHOTON_PROFILE_FUNCTION();
+  Lights = {
+      {.Position = v3f(1.0f, 1.0f, 0.0f), .Color = v3f(1.0f, 0.0f, 0.0f)},
+      {.Position = v3f(0.0f, 1.0f, 1.0f), .Color = v3f(0.0f, 1.0f, 0.0f)},
+      {.Position = v3f(-1.0f, 0.0f, 0.0f), .Color = v3f(0.0f, 0.0f, 1.0f)},
+      {.Position = v3f(0.0f, -1.0f, -1.0f), .Color = v3f(1.0f, 1.0f, 0.0f)},
+      {.Position = v3f(0.0f, 3.0f, 0.0f),
+       .Color = v3f(1.0f),
+       .Intensity = 4.0f,
+       .Direction = v3f(0.0f, -1.0f, 0.0f),
+       .SpotCosine = 0.82f},
+  };
+}
 
-  wSkyboxBindGroup = wDevice.CreateBindGroup(&bindGroupDescriptor);
+void Renderer::SetupSkyboxPipeline() {
+  PHOTON_PROFILE_FUNCTION();
+  SkyboxPipeline = Pipelines.Request({
+      .Label = "CubeMap",
+      .ShaderPath = "shaders/cubemap.wgsl",
+      .ColorFormat = wgpu::TextureFormat::BGRA8Unorm,
+      .DepthStencil = wDepthStencilState,
+      .Layout = wSkyboxPipelineLayout,
+  });
 }
 
 void Renderer::DrawSkybox(wgpu::RenderPassEncoder &renderPass) {
-  renderPass.SetBindGroup(0, wSkyboxBindGroup, 0, nullptr);
-  renderPass.SetPipeline(wCubeMapPipeline);
+  wgpu::RenderPipeline pipeline = Pipelines.Get(SkyboxPipeline);
+  if (!pipeline)
+    return;
+
+  SetPipeline(renderPass, pipeline);
+  SetBindGroup(renderPass, kFrameBindGroup, wFrameBindGroup);
 
   // Camera.Position = v3f(cos(glfwGetTime() * .2f) * 4.f, 0.0f,
   //                       -sin(glfwGetTime() * .2f) * 4.f);
 
-  SkyboxMapUniforms uniforms{};
-  m4 projection = glm::perspective(glm::radians(45.0f),
-                                   (f32)kWidth / (f32)kHeight, 0.1f, 100.0f);
-  m4 view = glm::lookAt(Camera.Position, v3f(0.0f), Camera.Up);
-  uniforms.m_MVPi = glm::inverse(projection * glm::mat4(glm::mat3(view)));
-
-  wDevice.GetQueue().WriteBuffer(wSkyboxUniformBuffer, 0, &uniforms,
-                                 sizeof(SkyboxMapUniforms));
   renderPass.Draw(3);
+  Stats.CountDraw(3);
+}
+
+void Renderer::RenderShadows(wgpu::CommandEncoder &encoder) {
+  PHOTON_PROFILE_FUNCTION();
+  wgpu::RenderPipeline pipeline = Pipelines.Get(ShadowPipeline);
+  if (!pipeline)
+    return;
+
+  for (u32 cascade = 0; cascade < CascadedShadows::kCascadeCount; ++cascade) {
+    if (!Shadows.NeedsRender(cascade))
+      continue;
+
+    wgpu::RenderPassDepthStencilAttachment depthAttachment{};
+    depthAttachment.view = Shadows.GetCascadeView(cascade);
+    depthAttachment.depthClearValue = 1.0f;
+    depthAttachment.depthLoadOp = wgpu::LoadOp::Clear;
+    depthAttachment.depthStoreOp = wgpu::StoreOp::Store;
+    depthAttachment.stencilLoadOp = wgpu::LoadOp::Undefined;
+    depthAttachment.stencilStoreOp = wgpu::StoreOp::Undefined;
+    depthAttachment.stencilReadOnly = true;
+
+    wgpu::RenderPassDescriptor descriptor{
+        .label = "Shadow Cascade",
+        .colorAttachmentCount = 0,
+        .depthStencilAttachment = &depthAttachment,
+        .timestampWrites = Profiler.RenderPass("Shadow Cascades")};
+    wgpu::RenderPassEncoder pass = encoder.BeginRenderPass(&descriptor);
+    pass.SetPipeline(pipeline);
+
+    const u32 cascadeOffset = cascade * CascadedShadows::kCascadeUniformStride;
+    pass.SetBindGroup(0, Shadows.GetCascadeBindGroup(), 1, &cascadeOffset);
+    Stats.CountPipelineSwitch();
+    Stats.CountBindGroupSwitch();
+
+    // Cached cascades only hold static casters.
+    DrawShadowCasters(pass, Shadows.GetViewProjection(cascade),
+                      Shadows.IsCached(cascade));
+
+    pass.End();
+    Shadows.MarkRendered(cascade);
+  }
+
+  const std::vector<u32> &tiles = Atlas.GetScheduledTiles();
+  if (tiles.empty())
+    return;
+
+  // Unscheduled tiles keep their contents, so the atlas is loaded and each
+  // scheduled tile is cleared on its own.
+  wgpu::RenderPassDepthStencilAttachment atlasAttachment{};
+  atlasAttachment.view = Atlas.GetTextureView();
+  atlasAttachment.depthLoadOp = wgpu::LoadOp::Load;
+  atlasAttachment.depthStoreOp = wgpu::StoreOp::Store;
+  atlasAttachment.stencilLoadOp = wgpu::LoadOp::Undefined;
+  atlasAttachment.stencilStoreOp = wgpu::StoreOp::Undefined;
+  atlasAttachment.stencilReadOnly = true;
+
+  wgpu::RenderPassDescriptor atlasDescriptor{
+      .label = "Shadow Atlas",
+      .colorAttachmentCount = 0,
+      .depthStencilAttachment = &atlasAttachment,
+      .timestampWrites = Profiler.RenderPass("Shadow Atlas")};
+  wgpu::RenderPassEncoder pass = encoder.BeginRenderPass(&atlasDescriptor);
+  for (u32 tile : tiles) {
+    Atlas.BeginTile(pass, tile);
+    pass.SetPipeline(pipeline);
+    Stats.CountPipelineSwitch();
+    DrawShadowCasters(pass, Atlas.GetViewProjection(tile), false);
+  }
+  pass.End();
+  Atlas.MarkRendered();
+}
+
+void Renderer::DrawShadowCasters(wgpu::RenderPassEncoder &renderPass,
+                                 const m4 &viewProjection, bool bStaticOnly) {
+  const std::vector<u32> &casters =
+      Culler.Cull(Frustum::FromViewProjection(viewProjection));
+  for (u32 i : casters) {
+    const RenderObject &object = Objects[i];
+    if (bStaticOnly && !object.bStatic)
+      continue;
+
+    const CMesh &mesh = Meshes[object.MeshIndex];
+    const u32 objectOffset = i * kObjectUniformStride;
+    renderPass.SetBindGroup(1, wObjectBindGroup, 1, &objectOffset);
+    renderPass.SetVertexBuffer(0, mesh.positionBuffer, 0,
+                               mesh.pointData.size() * sizeof(f32));
+    renderPass.SetIndexBuffer(mesh.indexBuffer, wgpu::IndexFormat::Uint16, 0,
+                              mesh.indexData.size() * sizeof(u16));
+    renderPass.DrawIndexed(mesh.indexCount, 1, 0, 0, 0);
+    Stats.CountBindGroupSwitch();
+    Stats.CountDraw(mesh.indexCount);
+  }
+}
+
+void Renderer::DrawGpuScene(wgpu::RenderPassEncoder &renderPass, u32 phase,
+                            bool bDepthOnly) {
+  wgpu::RenderPipeline pipeline;
+  if (bDepthOnly)
+    pipeline = Pipelines.Get(DepthPrepassInstancedPipeline);
+  else if (bDepthPrepassActive)
+    pipeline = Pipelines.Get(MeshInstancedDepthEqualPipeline);
+  if (!pipeline && !bDepthOnly)
+    pipeline = Pipelines.Get(MeshInstancedPipeline);
+  if (!pipeline || Scene.GetInstanceCount() == 0)
+    return;
+
+  // Dawn exposes no multi-draw-indirect, so each mesh/material/LOD batch is
+  // one indirect draw. firstInstance stays 0 (indirect-first-instance is
+  // optional); the batch's slice of the visible list is picked through the
+  // draw group's dynamic offset instead.
+  SetPipeline(renderPass, pipeline);
+  SetBindGroup(renderPass, kFrameBindGroup, wFrameBindGroup);
+
+  const std::vector<GpuDrawBatch> &batches = Scene.GetBatches();
+  for (u32 i = 0; i < batches.size(); ++i) {
+    const GpuDrawBatch &batch = batches[i];
+    const CMesh &mesh = Meshes[batch.MeshIndex];
+    const u32 draw = Scene.GetDrawIndex(phase, i);
+
+    SetBindGroup(renderPass, kMaterialBindGroup,
+                 Materials[batch.MaterialIndex].bindGroup);
+    SetBindGroup(renderPass, kObjectBindGroup, Scene.GetDrawBindGroup(),
+                 draw * GpuScene::kDrawUniformStride);
+
+    renderPass.SetVertexBuffer(0, mesh.positionBuffer, 0,
+                               mesh.pointData.size() * sizeof(f32));
+    if (!bDepthOnly) {
+      renderPass.SetVertexBuffer(1, mesh.normalBuffer, 0,
+                                 mesh.normalData.size() * sizeof(f32));
+      renderPass.SetVertexBuffer(2, mesh.tangentBuffer, 0,
+                                 mesh.tangentData.size() * sizeof(f32));
+      renderPass.SetVertexBuffer(3, mesh.bitangentBuffer, 0,
+                                 mesh.bitangentData.size() * sizeof(f32));
+      renderPass.SetVertexBuffer(4, mesh.colorBuffer, 0,
+                                 mesh.colorData.size() * sizeof(f32));
+      renderPass.SetVertexBuffer(5, mesh.uvBuffer, 0,
+                                 mesh.uvData.size() * sizeof(f32));
+    }
+    renderPass.SetIndexBuffer(mesh.indexBuffer, wgpu::IndexFormat::Uint16, 0,
+                              mesh.indexData.size() * sizeof(u16));
+    renderPass.DrawIndexedIndirect(Scene.GetDrawCommandBuffer(),
+                                   draw * sizeof(GpuDrawCommand));
+    Stats.CountIndirectDraw();
+  }
+}
+
+void Renderer::SetDepthPrepass(bool bEnabled) { bDepthPrepass = bEnabled; }
+
+void Renderer::SetDynamicResolution(bool bEnabled) {
+  Resolution.bEnabled = bEnabled;
+}
+
+void Renderer::LogGpuProfile() {
+  if (!Profiler.IsEnabled()) {
+    LogWarning("GPU profiling is not available on this device");
+    return;
+  }
+  for (const GpuScopeStats &scope : Profiler.GetStats())
+    LogInfo("%-18s avg %6.3f ms  p50 %6.3f  p95 %6.3f  p99 %6.3f  max %6.3f",
+            scope.Name.c_str(), scope.AverageMs, scope.P50Ms, scope.P95Ms,
+            scope.P99Ms, scope.MaxMs);
+}
+
+void Renderer::LogStartupTimeline() {
+  StartupTimeline::Instance().LogReport();
+}
+
+void Renderer::LogFramePacing() {
+  const FramePacingStats stats = Pacing.GetStats();
+  if (stats.SampleCount == 0)
+    return;
+  LogInfo("Frame interval avg %6.3f ms  p50 %6.3f  p95 %6.3f  p99 %6.3f  "
+          "max %6.3f  jitter %6.3f  hitches %u/%u",
+          stats.AverageIntervalMs, stats.P50IntervalMs, stats.P95IntervalMs,
+          stats.P99IntervalMs, stats.MaxIntervalMs, stats.JitterMs,
+          stats.HitchCount, stats.SampleCount);
+  LogInfo("GPU latency avg %6.3f ms  p95 %6.3f  throttled %6.3f ms/frame  "
+          "%.2f of %u frames in flight",
+          stats.AverageLatencyMs, stats.P95LatencyMs, stats.AverageThrottleMs,
+          stats.AverageFramesInFlight, Pacing.GetMaxFramesInFlight());
+  if (stats.InputSampleCount > 0)
+    LogInfo("Input to present avg %6.3f ms  p95 %6.3f  over %u frames",
+            stats.AverageInputLatencyMs, stats.P95InputLatencyMs,
+            stats.InputSampleCount);
+}
+
+void Renderer::LogRenderStats() {
+  auto log = [](const char *label, const FrameStats &stats) {
+    LogInfo("%-7s draws %u (+%u indirect)  triangles %llu  pipelines %u  "
+            "bind groups %u  uploads %llu B buffer / %llu B texture  "
+            "submits %u",
+            label, stats.DrawCalls, stats.IndirectDrawCalls, stats.Triangles,
+            stats.PipelineSwitches, stats.BindGroupSwitches,
+            stats.BufferBytesUploaded, stats.TextureBytesUploaded,
+            stats.CommandBuffersSubmitted);
+  };
+  log("Last", Stats.GetLast());
+  log("Average", Stats.GetAverage());
+  log("Peak", Stats.GetPeak());
+}
+
+void Renderer::SetGpuDriven(bool bEnabled) {
+  if (bGpuDriven == bEnabled)
+    return;
+  bGpuDriven = bEnabled;
+  bGpuSceneDirty = true;
 }
 
 } // namespace photon
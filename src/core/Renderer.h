@@ -6,10 +6,30 @@
 #define PHOTON_RENDERER_H
 
 #include "CCamera.h"
+#include "CMaterial.h"
 #include "CMesh.h"
+#include "CascadedShadows.h"
+#include "ClusteredLighting.h"
+#include "DepthPyramid.h"
+#include "DiskBlobCache.h"
+#include "DynamicResolution.h"
+#include "FrameCapture.h"
+#include "FramePacer.h"
+#include "FrustumCuller.h"
+#include "GpuProfiler.h"
+#include "GpuScene.h"
+#include "InputRecorder.h"
+#include "PipelineCache.h"
+#include "RenderObject.h"
+#include "RenderStats.h"
 #include "ResourceLoader.h"
+#include "SceneDescription.h"
+#include "ShadowAtlas.h"
+#include "Simulation.h"
 
 
+#include <functional>
+#include <optional>
 #include <webgpu/webgpu_cpp.h>
 #if defined(__EMSCRIPTEN__)
 #include <emscripten/emscripten.h>
@@ -19,19 +39,158 @@
 
 namespace photon {
 
-struct ShaderUniforms {
-  m4 m_Model;
+// Bind group 0: written once per frame, shared by every pipeline in the pass.
+struct FrameUniforms {
   m4 m_View;
   m4 m_Projection;
+  m4 m_SkyboxMVPi;
   v3f m_CameraPosition;
   f32 m_deltaTime = 0.0f;
+};
+
+// Bind group 1: written only when a material parameter changes.
+struct MaterialUniforms {
   f32 m_metallic = 0.0f;
   f32 m_roughness = 0.0f;
   f32 pad[2];
 };
 
-struct SkyboxMapUniforms {
-  m4 m_MVPi;
+// Bind group 2: one slot per object in a shared buffer, selected with a
+// dynamic offset.
+struct ObjectUniforms {
+  m4 m_Model;
+};
+
+// Upscale pass: the scene target it reads and how much to sharpen.
+struct UpscaleUniforms {
+  v2f m_SourceSize;
+  f32 m_Sharpness = 0.5f;
+  f32 pad;
+};
+
+constexpr u32 kFrameBindGroup = 0;
+constexpr u32 kMaterialBindGroup = 1;
+constexpr u32 kObjectBindGroup = 2;
+constexpr u32 kBindGroupCount = 3;
+
+// Dawn's blob cache on native; deleting it forces a cold start.
+constexpr const char *kPipelineCachePath = "./cache/";
+
+// Object slots the uniform buffer starts with; it doubles when full.
+constexpr u32 kInitialObjectCapacity = 64;
+constexpr u32 kObjectUniformStride = 256;
+
+// Tracks what is currently bound on a pass or bundle encoder so redundant
+// SetPipeline and SetBindGroup calls can be skipped between draws.
+struct RenderPassState {
+  WGPURenderPipeline Pipeline = nullptr;
+  std::array<WGPUBindGroup, kBindGroupCount> BindGroups{};
+  std::array<u32, kBindGroupCount> DynamicOffsets{};
+
+  // Each returns whether it issued the call.
+  template <typename Encoder>
+  bool SetPipeline(Encoder &encoder, const wgpu::RenderPipeline &pipeline) {
+    if (Pipeline == pipeline.Get())
+      return false;
+
+    encoder.SetPipeline(pipeline);
+    Pipeline = pipeline.Get();
+    return true;
+  }
+
+  template <typename Encoder>
+  bool SetBindGroup(Encoder &encoder, u32 groupIndex,
+                    const wgpu::BindGroup &group, u32 dynamicOffset = 0) {
+    if (BindGroups[groupIndex] == group.Get() &&
+        DynamicOffsets[groupIndex] == dynamicOffset)
+      return false;
+
+    // Only the object group (or GpuScene's draw group in its slot) is laid
+    // out with a dynamic offset.
+    if (groupIndex == kObjectBindGroup)
+      encoder.SetBindGroup(groupIndex, group, 1, &dynamicOffset);
+    else
+      encoder.SetBindGroup(groupIndex, group);
+
+    BindGroups[groupIndex] = group.Get();
+    DynamicOffsets[groupIndex] = dynamicOffset;
+    return true;
+  }
+};
+
+// Commands of one shaded mesh draw, as Renderer::DrawMesh records them. Free
+// so the encoding benchmark measures this code rather than a copy of it.
+template <typename Encoder>
+void EncodeMeshDraw(Encoder &encoder, RenderPassState &state,
+                    RenderStats &stats, const wgpu::RenderPipeline &pipeline,
+                    const wgpu::BindGroup &frameGroup,
+                    const wgpu::BindGroup &materialGroup,
+                    const wgpu::BindGroup &objectGroup, u32 objectIndex,
+                    const CMesh &mesh) {
+  if (state.SetPipeline(encoder, pipeline))
+    stats.CountPipelineSwitch();
+  if (state.SetBindGroup(encoder, kFrameBindGroup, frameGroup))
+    stats.CountBindGroupSwitch();
+  if (state.SetBindGroup(encoder, kMaterialBindGroup, materialGroup))
+    stats.CountBindGroupSwitch();
+  if (state.SetBindGroup(encoder, kObjectBindGroup, objectGroup,
+                         objectIndex * kObjectUniformStride))
+    stats.CountBindGroupSwitch();
+
+  encoder.SetVertexBuffer(0, mesh.positionBuffer, 0,
+                          mesh.pointData.size() * sizeof(f32));
+  encoder.SetVertexBuffer(1, mesh.normalBuffer, 0,
+                          mesh.normalData.size() * sizeof(f32));
+  encoder.SetVertexBuffer(2, mesh.tangentBuffer, 0,
+                          mesh.tangentData.size() * sizeof(f32));
+  encoder.SetVertexBuffer(3, mesh.bitangentBuffer, 0,
+                          mesh.bitangentData.size() * sizeof(f32));
+  encoder.SetVertexBuffer(4, mesh.colorBuffer, 0,
+                          mesh.colorData.size() * sizeof(f32));
+  encoder.SetVertexBuffer(5, mesh.uvBuffer, 0,
+                          mesh.uvData.size() * sizeof(f32));
+  encoder.SetIndexBuffer(mesh.indexBuffer, wgpu::IndexFormat::Uint16, 0,
+                         mesh.indexData.size() * sizeof(u16));
+  encoder.DrawIndexed(mesh.indexCount, 1, 0, 0, 0);
+  stats.CountDraw(mesh.indexCount);
+}
+
+// How a native run is set up: window or not, adapter, scene and when to stop.
+struct RunOptions {
+  // Runs without a window or surface, e.g. on GPU-less CI machines. Frames
+  // are rendered into an offscreen texture at a fixed time step.
+  bool bHeadless = false;
+  // Frames to render; 0 runs until the window closes, or 300 frames headless.
+  u32 FrameCount = 0;
+  u32 Width = 1920;
+  u32 Height = 1080;
+  // Null records and validates commands without executing them. The fallback
+  // adapter is Dawn's software Vulkan (SwiftShader) when it was built in.
+  wgpu::BackendType Backend = wgpu::BackendType::Undefined;
+  bool bForceFallbackAdapter = false;
+  // Mailbox and Immediate fall back to the next supported mode, down to Fifo.
+  wgpu::PresentMode PresentMode = wgpu::PresentMode::Fifo;
+  // Submitted frames the GPU may still be working on before the next frame
+  // waits; 0 removes the limit.
+  u32 MaxFramesInFlight = 2;
+  // Frames are written to <CapturePrefix><frame>.png; empty disables capture.
+  std::string CapturePrefix;
+  // Capture every N frames; 0 captures only the last one.
+  u32 CaptureInterval = 0;
+  // Ticks the simulation on a thread of its own, overlapping encoding.
+  bool bSimulationThread = false;
+  // Lets the render size follow measured GPU time. Unset, it is on for
+  // windowed runs only: headless runs and replays render at the full size so
+  // their frames compare between runs.
+  std::optional<bool> DynamicResolution;
+  // Input is recorded to RecordPath, or taken from the recording at
+  // ReplayPath instead of the window; either runs on a fixed time step.
+  std::string RecordPath;
+  std::string ReplayPath;
+
+  SceneDescription Scene;
+  // Called after every frame with its index; returning false ends the run.
+  std::function<bool(u64)> OnFrameEnd;
 };
 
 struct MouseButtonEvent {
@@ -48,105 +207,257 @@ class Renderer {
   u32 kHeight = 1080;
 #endif
 
-  f32 metalic = 0.f;
-  f32 roughness = 0.f;
-
 private:
+#if !defined(__EMSCRIPTEN__)
+  std::unique_ptr<CachingPlatform> Platform;
+#endif
+
   wgpu::Instance wInstance;
   wgpu::Device wDevice;
   wgpu::Surface wSurface;
   wgpu::SwapChain wSwapChain;
-  wgpu::RenderPipeline wRenderPipeline;
-
-  wgpu::RenderPipeline wCubeMapPipeline;
+  wgpu::RequestAdapterOptions AdapterOptions;
+
+  RunOptions Options;
+  // Headless frames stand in for the swap chain's texture.
+  wgpu::Texture wOutputTexture;
+  wgpu::TextureView wOutputTextureView;
+  FrameCapture Readback;
+  u64 FrameIndex = 0;
+  // Update and Render of the last frame, including command submission.
+  f32 CpuFrameMs = 0.f;
+  PipelineCache Pipelines;
+  PipelineHandle MeshPipeline = 0;
+  PipelineHandle MeshDepthEqualPipeline = 0;
+  PipelineHandle SkyboxPipeline = 0;
+  PipelineHandle MeshInstancedPipeline = 0;
+  PipelineHandle MeshInstancedDepthEqualPipeline = 0;
+  PipelineHandle DepthPrepassPipeline = 0;
+  PipelineHandle DepthPrepassInstancedPipeline = 0;
+  PipelineHandle ShadowPipeline = 0;
+  PipelineHandle UpscalePipeline = 0;
+
+  wgpu::PipelineLayout wMeshPipelineLayout;
+  wgpu::PipelineLayout wGpuDrivenPipelineLayout;
+  wgpu::PipelineLayout wShadowPipelineLayout;
+  wgpu::PipelineLayout wSkyboxPipelineLayout;
+  wgpu::PipelineLayout wUpscalePipelineLayout;
 
   std::vector<wgpu::VertexBufferLayout> wVertexBufferLayouts;
   std::vector<wgpu::VertexAttribute> wVertexAttributes;
 
-  std::vector<wgpu::BindGroupLayoutEntry> wBindGroupLayoutEntries;
-  wgpu::BindGroupLayout wBindGroupLayout;
-  wgpu::BindGroup wBindGroup;
-  std::vector<wgpu::BindGroupEntry> wBindGroupEntries;
+  std::array<wgpu::BindGroupLayoutEntry, 11> wFrameBindGroupLayoutEntries;
+  wgpu::BindGroupLayout wFrameBindGroupLayout;
+  wgpu::BindGroup wFrameBindGroup;
+
+  std::array<wgpu::BindGroupLayoutEntry, 5> wMaterialBindGroupLayoutEntries;
+  wgpu::BindGroupLayout wMaterialBindGroupLayout;
+
+  std::array<wgpu::BindGroupLayoutEntry, 1> wObjectBindGroupLayoutEntries;
+  wgpu::BindGroupLayout wObjectBindGroupLayout;
+  wgpu::BindGroup wObjectBindGroup;
 
-  wgpu::Buffer wUniformBuffer;
-  wgpu::Buffer wSkyboxUniformBuffer;
+  wgpu::Buffer wFrameUniformBuffer;
+  wgpu::Buffer wObjectUniformBuffer;
+  u32 ObjectCapacity = 0;
 
   wgpu::DepthStencilState wDepthStencilState;
+  // Shading after a depth prepass: only the frontmost surface passes.
+  wgpu::DepthStencilState wDepthEqualState;
   wgpu::Texture wDepthTexture;
   wgpu::TextureView wDepthTextureView;
+  DepthPyramid HiZ;
+
+  // The scene renders into wSceneColorTexture at the size picked by
+  // Resolution; the upscale pass fills the swap chain from it.
+  DynamicResolution Resolution;
+  wgpu::Texture wSceneColorTexture;
+  wgpu::TextureView wSceneColorTextureView;
+  wgpu::BindGroupLayout wUpscaleBindGroupLayout;
+  wgpu::BindGroup wUpscaleBindGroup;
+  wgpu::Buffer wUpscaleUniformBuffer;
+  f32 Sharpness = 0.5f;
+  // Last measured GPU frame time; the controller ignores frames without one.
+  f32 GpuFrameMs = 0.f;
+
+  // Per-pass GPU timings, when the device supports timestamp queries.
+  GpuProfiler Profiler;
+  FramePacer Pacing;
+  RenderStats &Stats = RenderStats::Instance();
 
   wgpu::Sampler wSampler;
 
-  wgpu::Texture wAlbedoTexture;
-  wgpu::TextureView wAlbedoTextureView;
-
-  wgpu::Texture wNormalTexture;
-  wgpu::TextureView wNormalTextureView;
-
-  wgpu::Texture wRoughnessTexture;
-  wgpu::TextureView wRoughnessTextureView;
-
-  wgpu::Texture wMetallicTexture;
-  wgpu::TextureView wMetallicTextureView;
-
   wgpu::Texture wSkyboxTexture;
   wgpu::TextureView wSkyboxTextureView;
 
-  wgpu::BindGroupLayout wSkyboxBindGroupLayout;
-  wgpu::BindGroup wSkyboxBindGroup;
-  std::array<wgpu::BindGroupEntry, 3> wSkyboxBindGroupEntries;
-  std::array<wgpu::BindGroupLayoutEntry, 3> wSkyboxBindGroupEntryLayouts;
-
   wgpu::VertexAttribute wSkyboxVertexAttribute;
   wgpu::VertexBufferLayout wSkyboxVertexBufferLayout;
 
-  CMesh Mesh;
+  std::vector<CMesh> Meshes;
+  std::vector<CMaterial> Materials;
+  std::vector<RenderObject> Objects;
+  // Slots written since the last upload, as one range so Update sends a
+  // single write instead of visiting every object.
+  u32 DirtyObjectsBegin = 0;
+  u32 DirtyObjectsEnd = 0;
+  std::vector<u8> ObjectUploadData;
   CCamera Camera;
-
-  f32 MeshYaw = 0.f;
-  f32 MeshPitch = 0.f;
-  f32 MeshRoll = 0.f;
-
-  v3i InputRotation{};
+  m4 ViewProjection = m4(1.0f);
+  // Uniforms of the view Update sampled, which encoding decisions follow.
+  FrameUniforms EarlyFrame{};
+
+  FrustumCuller Culler;
+  // What the CPU path's main passes drew this frame, ascending.
+  std::vector<u32> EncodedVisible;
+
+  ClusteredLighting Lighting;
+  std::vector<GpuLight> Lights;
+
+  CascadedShadows Shadows;
+  v3f SunDirection = glm::normalize(v3f(-0.4f, -1.0f, -0.3f));
+  v3f SunColor = v3f(1.5f);
+  ShadowAtlas Atlas;
+
+  RenderPassState PassState;
+
+  wgpu::RenderBundle wStaticBundle;
+  wgpu::RenderBundle wStaticDepthBundle;
+  // Commands recorded into each bundle, added to every frame that runs it.
+  FrameStats StaticBundleStats;
+  FrameStats StaticDepthBundleStats;
+  // Objects the bundles draw, ascending.
+  std::vector<u32> BundledObjects;
+  bool bStaticBundleDirty = true;
+  bool bStaticBundlePrepass = false;
+
+  // Lay down depth with a position-only pass first so the PBR shader runs
+  // once per visible pixel. Active once the prepass pipeline is ready.
+  bool bDepthPrepass = true;
+  bool bDepthPrepassActive = false;
+
+  // When enabled, culling, LOD selection and draw arguments come from a
+  // compute pass over GpuScene instead of the CPU culler.
+  GpuScene Scene;
+  bool bGpuDriven = false;
+  bool bGpuSceneDirty = true;
+
+  Simulation Sim;
+  // Rotation of Objects[0] as last uploaded.
+  v3f MeshRotation = v3f(0.f);
+  // Time Update last sampled, and how far the next frame is expected after.
+  f64 LastFrameTime = 0.0;
+  f64 FrameInterval = 0.0;
+  // Newest simulation tick the uploaded view shows.
+  u64 ViewTick = 0;
+
+  InputRecorder Input;
+  // This frame's replayed events; late ones are applied by LateUpdate.
+  std::span<const InputEvent> ReplayEvents;
+  // Set while LateUpdate polls, so recorded events replay in the same phase.
+  bool bSamplingLateInput = false;
 
 public:
   static Renderer &Instance();
   static bool Go();
+#if !defined(__EMSCRIPTEN__)
+  // Runs as configured by options and returns an exit code.
+  static int Run(const RunOptions &options);
+#endif
+
+  [[nodiscard]] f32 GetCpuFrameMs() const { return CpuFrameMs; }
+  [[nodiscard]] const GpuProfiler &GetGpuProfiler() const { return Profiler; }
+  [[nodiscard]] const FramePacer &GetFramePacer() const { return Pacing; }
+  [[nodiscard]] f32 GetResolutionScale() const { return Resolution.GetScale(); }
 
   Renderer() = default;
   ~Renderer() = default;
 
 private:
   void Start();
+  void RunHeadless();
+  // Update and Render, timed into CpuFrameMs.
+  void Frame();
+  // Startup milestones; the timeline is reported once pipelines are ready.
+  void MarkFramePresented();
+  void LoadScene();
+  f64 GetTime() const;
 
   void GetDevice(void (*callback)(wgpu::Device));
 
   void InitGraphics();
 
   void SetupSwapChain();
+  wgpu::TextureView GetOutputView();
 
   void SetupMeshVertexBuffers();
 
   void SetupDepthStencil();
-  void LoadTextures(const std::string &name, ETextureImportType type);
-  void SetupMeshUniformBuffer();
+  void SetupRenderTargets();
+  void ResizeRenderTargets();
+  u32 LoadMaterial(const std::string &name, ETextureImportType type);
+  void LoadSkybox(const std::string &name, ETextureImportType type);
+  void SetupUniformBuffers();
   void SetupSampler();
-  void SetupMeshBindGroupLayout();
-  void SetupMeshBindGroup();
-
-  void SetupSkyboxBindGroupLayout();
-  void SetupSkyboxBindGroup();
+  void SetupBindGroupLayouts();
+  void SetupFrameBindGroup();
+  void SetupMaterialBindGroup(CMaterial &material);
+  void SetupObjectBindGroup();
 
+  void SetupPipelineLayouts();
   void SetupMeshPipeline();
   void SetupSkyboxPipeline();
-
-  void DrawMesh(wgpu::RenderPassEncoder &renderPass);
+  void SetupMeshInstancedPipeline();
+  void SetupDepthPrepassPipelines();
+  void SetupShadowPipeline();
+  void SetupUpscale();
+  void SetupUpscaleBindGroup();
+  PipelineHandle GetMeshPipelineHandle(const CMaterial &material) const;
+  wgpu::RenderPipeline GetMeshPipeline(const CMaterial &material) const;
+
+  template <typename Encoder>
+  void SetPipeline(Encoder &encoder, const wgpu::RenderPipeline &pipeline);
+  template <typename Encoder>
+  void SetBindGroup(Encoder &encoder, u32 groupIndex,
+                    const wgpu::BindGroup &group, u32 dynamicOffset = 0);
+
+  template <typename Encoder> void DrawMesh(Encoder &encoder, u32 objectIndex);
+  template <typename Encoder>
+  void DrawMeshDepth(Encoder &encoder, u32 objectIndex);
   void DrawSkybox(wgpu::RenderPassEncoder &renderPass);
-
+  void RenderShadows(wgpu::CommandEncoder &encoder);
+  void Upscale(wgpu::CommandEncoder &encoder);
+  void SubmitFrame(wgpu::CommandEncoder &encoder);
+  void DrawShadowCasters(wgpu::RenderPassEncoder &renderPass,
+                         const m4 &viewProjection, bool bStaticOnly);
+  void DrawGpuScene(wgpu::RenderPassEncoder &renderPass, u32 phase,
+                    bool bDepthOnly);
+
+  u32 AddObject(const RenderObject &object);
+  void MarkObjectDirty(u32 objectIndex);
+  // Grows the object uniform buffer to hold at least count objects.
+  void ReserveObjects(u32 count);
+  void UploadDirtyObjects();
+  void UpdateObjectBounds(u32 objectIndex);
+  void RecordStaticBundle();
+
+  // Simulation and everything encoding depends on, with an early view.
   void Update();
   void Render();
+  // Samples input again and uploads the view-dependent uniforms right
+  // before the frame is submitted.
+  void LateUpdate();
+  // Camera and uniforms for a simulation state; also sets ViewProjection.
+  FrameUniforms SampleView(const SimulationSnapshot &state);
 
   void SetupCamera();
+  void SetupLights();
+
+  // Live input is recorded, or dropped while a replay supplies it.
+  void HandleInput(const InputEvent &event);
+  void ApplyInput(const InputEvent &event);
+#if !defined(__EMSCRIPTEN__)
+  void SetupInputCallbacks(GLFWwindow *window);
+#endif
 
 public:
   void OnInputDown(const std::string &key);
@@ -157,6 +468,14 @@ public:
   void OnMouseOut(const v2i &position);
   void OnSliderChange(const std::string &name, i32 value);
   void OnScroll(const float delta);
+
+  void SetGpuDriven(bool bEnabled);
+  void SetDepthPrepass(bool bEnabled);
+  void SetDynamicResolution(bool bEnabled);
+  void LogGpuProfile();
+  void LogRenderStats();
+  void LogStartupTimeline();
+  void LogFramePacing();
 };
 
 } // namespace photon
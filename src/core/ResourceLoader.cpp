@@ -4,7 +4,10 @@
 
 #include "ResourceLoader.h"
 #include "stb_image.h"
+#include "CpuProfiler.h"
 #include "Logger.h"
+#include "RenderStats.h"
+#include <algorithm>
 #include <bit>
 #include <vector>
 #include <tiny_gltf.h>
@@ -22,10 +25,20 @@ namespace photon
 
 CMesh ResourceLoader::LoadMesh(const char *path, const wgpu::Device& device, EModelImportType modelType)
 {
+    PHOTON_PROFILE_FUNCTION();
     CMesh meshComponent;
 
+    // A mesh that failed to load still gets its (empty) buffers.
+    LoadMeshData(path, modelType, meshComponent);
+    UploadMesh(meshComponent, device);
+
+    return meshComponent;
+}
+
+bool ResourceLoader::ParseGltf(const char* path, EModelImportType modelType, tinygltf::Model& outModel)
+{
+    PHOTON_PROFILE_FUNCTION();
     tinygltf::TinyGLTF loader;
-    tinygltf::Model model;
     std::string err;
     std::string warn;
 
@@ -33,14 +46,14 @@ CMesh ResourceLoader::LoadMesh(const char *path, const wgpu::Device& device, EMo
     switch (modelType)
     {
         case EModelImportType::glb:
-            ret = loader.LoadBinaryFromFile(&model, &err, &warn, RESOURCE_PATH + "models/" + std::string(path));
+            ret = loader.LoadBinaryFromFile(&outModel, &err, &warn, RESOURCE_PATH + "models/" + std::string(path));
             break;
         case EModelImportType::gltf:
-            ret = loader.LoadASCIIFromFile(&model, &err, &warn, path);
+            ret = loader.LoadASCIIFromFile(&outModel, &err, &warn, path);
             break;
         default:
             LogError("Unknown model type\n");
-            return meshComponent;
+            return false;
     }
 
     if (!warn.empty())
@@ -52,6 +65,12 @@ CMesh ResourceLoader::LoadMesh(const char *path, const wgpu::Device& device, EMo
     if (!ret)
         LogError("Failed to parse glTF\n");
 
+    return ret;
+}
+
+void ResourceLoader::CopyAccessors(const tinygltf::Model& model, CMesh& meshComponent)
+{
+    PHOTON_PROFILE_FUNCTION();
     for (const auto& mesh : model.meshes)
     {
         for (const auto& primitive : mesh.primitives)
@@ -123,6 +142,39 @@ CMesh ResourceLoader::LoadMesh(const char *path, const wgpu::Device& device, EMo
         }
     }
 
+    meshComponent.lods = {{0, static_cast<u32>(meshComponent.indexCount)}};
+}
+
+void ResourceLoader::ComputeBounds(CMesh& meshComponent)
+{
+    PHOTON_PROFILE_FUNCTION();
+    const std::vector<f32>& points = meshComponent.pointData;
+    if (!points.empty())
+    {
+        v3f boundsMin(points[0], points[1], points[2]);
+        v3f boundsMax = boundsMin;
+        for (u32 i = 0; i < points.size(); i += 3)
+        {
+            const v3f point(points[i + 0], points[i + 1], points[i + 2]);
+            boundsMin = glm::min(boundsMin, point);
+            boundsMax = glm::max(boundsMax, point);
+        }
+
+        meshComponent.boundsMin = boundsMin;
+        meshComponent.boundsMax = boundsMax;
+        meshComponent.boundsCenter = (boundsMin + boundsMax) * 0.5f;
+        for (u32 i = 0; i < points.size(); i += 3)
+        {
+            const v3f point(points[i + 0], points[i + 1], points[i + 2]);
+            meshComponent.boundsRadius = std::max(meshComponent.boundsRadius,
+                                                  glm::length(point - meshComponent.boundsCenter));
+        }
+    }
+}
+
+void ResourceLoader::GenerateTangents(CMesh& meshComponent)
+{
+    PHOTON_PROFILE_FUNCTION();
     std::vector<f32>& tangents = meshComponent.tangentData;
     tangents.resize(meshComponent.pointData.size());
 
@@ -177,7 +229,23 @@ CMesh ResourceLoader::LoadMesh(const char *path, const wgpu::Device& device, EMo
         bitangents[meshComponent.indexData[i + 2] * 3 + 1] = bitangent.y;
         bitangents[meshComponent.indexData[i + 2] * 3 + 2] = bitangent.z;
     }
+}
+
+bool ResourceLoader::LoadMeshData(const char* path, EModelImportType modelType, CMesh& outMesh)
+{
+    tinygltf::Model model;
+    if (!ParseGltf(path, modelType, model))
+        return false;
 
+    CopyAccessors(model, outMesh);
+    ComputeBounds(outMesh);
+    GenerateTangents(outMesh);
+    return true;
+}
+
+void ResourceLoader::UploadMesh(CMesh& meshComponent, const wgpu::Device& device)
+{
+    PHOTON_PROFILE_FUNCTION();
     wgpu::BufferDescriptor bufferDesc;
     bufferDesc.label = "Position Buffer";
     bufferDesc.size = (meshComponent.pointData.size() * sizeof(f32) + 3) & ~3;
@@ -217,18 +285,52 @@ CMesh ResourceLoader::LoadMesh(const char *path, const wgpu::Device& device, EMo
     meshComponent.indexBuffer = device.CreateBuffer(&bufferDesc);
     device.GetQueue().WriteBuffer(meshComponent.indexBuffer, 0, meshComponent.indexData.data(), bufferDesc.size);
 
-    return meshComponent;
+    RenderStats::Instance().CountBufferUpload(
+            meshComponent.positionBuffer.GetSize() + meshComponent.normalBuffer.GetSize() +
+            meshComponent.tangentBuffer.GetSize() + meshComponent.bitangentBuffer.GetSize() +
+            meshComponent.colorBuffer.GetSize() + meshComponent.uvBuffer.GetSize() +
+            meshComponent.indexBuffer.GetSize());
+}
+
+MipLevel ResourceLoader::NextMipLevel(const MipLevel& level)
+{
+    MipLevel next;
+    next.Width = std::max(level.Width / 2, 1u);
+    next.Height = std::max(level.Height / 2, 1u);
+    next.Pixels.resize(4 * static_cast<size_t>(next.Width) * next.Height);
+
+    // A 1-pixel-wide level repeats its only column instead of reading past it.
+    const u32 stepX = level.Width > 1 ? 1 : 0;
+    const u32 stepY = level.Height > 1 ? 1 : 0;
+    for (u32 i = 0; i < next.Width; ++i)
+    {
+        for (u32 j = 0; j < next.Height; ++j)
+        {
+            u8* p = &next.Pixels[4 * (j * next.Width + i)];
+            // Get the corresponding 4 pixels from the previous level
+            const u8* p00 = &level.Pixels[4 * ((2 * j * stepY) * level.Width + (2 * i * stepX))];
+            const u8* p01 = &level.Pixels[4 * ((2 * j * stepY) * level.Width + (2 * i * stepX + stepX))];
+            const u8* p10 = &level.Pixels[4 * ((2 * j * stepY + stepY) * level.Width + (2 * i * stepX))];
+            const u8* p11 = &level.Pixels[4 * ((2 * j * stepY + stepY) * level.Width + (2 * i * stepX + stepX))];
+            // Average
+            p[0] = static_cast<u8>((p00[0] + p01[0] + p10[0] + p11[0]) / 4);
+            p[1] = static_cast<u8>((p00[1] + p01[1] + p10[1] + p11[1]) / 4);
+            p[2] = static_cast<u8>((p00[2] + p01[2] + p10[2] + p11[2]) / 4);
+            p[3] = static_cast<u8>((p00[3] + p01[3] + p10[3] + p11[3]) / 4);
+        }
+    }
+    return next;
 }
 
-template<typename component_t>
 static void WriteMipMaps(
         wgpu::Device device,
         wgpu::Texture texture,
         wgpu::Extent3D textureSize,
         uint32_t mipLevelCount,
-        const component_t* pixelData,
+        const u8* pixelData,
         wgpu::Origin3D origin = { 0, 0, 0 })
 {
+    PHOTON_PROFILE_FUNCTION();
     wgpu::Queue queue = device.GetQueue();
 
     // Arguments telling which part of the texture we upload to
@@ -241,51 +343,29 @@ static void WriteMipMaps(
     wgpu::TextureDataLayout source;
     source.offset = 0;
 
-    // Create image data
-    wgpu::Extent3D mipLevelSize = textureSize;
-    std::vector<component_t> previousLevelPixels;
-    wgpu::Extent3D previousMipLevelSize;
-    for (uint32_t level = 0; level < mipLevelCount; ++level) {
-        std::vector<component_t> pixels(4 * mipLevelSize.width * mipLevelSize.height);
-        if (level == 0) {
-            // We cannot really avoid this copy since we need this
-            // in previousLevelPixels at the next iteration
-            memcpy(pixels.data(), pixelData, pixels.size() * sizeof(component_t));
-        }
-        else {
-            // Create mip level data
-            for (uint32_t i = 0; i < mipLevelSize.width; ++i) {
-                for (uint32_t j = 0; j < mipLevelSize.height; ++j) {
-                    component_t* p = &pixels[4 * (j * mipLevelSize.width + i)];
-                    // Get the corresponding 4 pixels from the previous level
-                    component_t* p00 = &previousLevelPixels[4 * ((2 * j + 0) * previousMipLevelSize.width + (2 * i + 0))];
-                    component_t* p01 = &previousLevelPixels[4 * ((2 * j + 0) * previousMipLevelSize.width + (2 * i + 1))];
-                    component_t* p10 = &previousLevelPixels[4 * ((2 * j + 1) * previousMipLevelSize.width + (2 * i + 0))];
-                    component_t* p11 = &previousLevelPixels[4 * ((2 * j + 1) * previousMipLevelSize.width + (2 * i + 1))];
-                    // Average
-                    p[0] = (p00[0] + p01[0] + p10[0] + p11[0]) / (component_t)4;
-                    p[1] = (p00[1] + p01[1] + p10[1] + p11[1]) / (component_t)4;
-                    p[2] = (p00[2] + p01[2] + p10[2] + p11[2]) / (component_t)4;
-                    p[3] = (p00[3] + p01[3] + p10[3] + p11[3]) / (component_t)4;
-                }
-            }
-        }
+    // We cannot really avoid copying level 0 since the next level is built
+    // from it
+    MipLevel level;
+    level.Width = textureSize.width;
+    level.Height = textureSize.height;
+    level.Pixels.assign(pixelData, pixelData + 4 * static_cast<size_t>(level.Width) * level.Height);
+    for (uint32_t mip = 0; mip < mipLevelCount; ++mip) {
+        if (mip > 0)
+            level = ResourceLoader::NextMipLevel(level);
 
         // Upload data to the GPU texture
-        destination.mipLevel = level;
-        source.bytesPerRow = 4 * mipLevelSize.width * sizeof(component_t);
-        source.rowsPerImage = mipLevelSize.height;
-        queue.WriteTexture(&destination, pixels.data(), pixels.size() * sizeof(component_t), &source, &mipLevelSize);
-
-        previousLevelPixels = std::move(pixels);
-        previousMipLevelSize = mipLevelSize;
-        mipLevelSize.width /= 2;
-        mipLevelSize.height /= 2;
+        wgpu::Extent3D mipLevelSize = { level.Width, level.Height, 1 };
+        destination.mipLevel = mip;
+        source.bytesPerRow = 4 * level.Width;
+        source.rowsPerImage = level.Height;
+        queue.WriteTexture(&destination, level.Pixels.data(), level.Pixels.size(), &source, &mipLevelSize);
+        RenderStats::Instance().CountTextureUpload(level.Pixels.size());
     }
 }
 
 wgpu::Texture ResourceLoader::LoadTexture(const char *path, wgpu::Device &device, ETextureImportType importType, wgpu::TextureView *pTextureView)
 {
+    PHOTON_PROFILE_FUNCTION();
     i32 width, height, channels;
     unsigned char* pixels = stbi_load((RESOURCE_PATH + "textures/" + std::string(path)).c_str(), &width, &height, &channels, STBI_rgb_alpha);
 
@@ -344,6 +424,7 @@ m3 ResourceLoader::CalculateTangent(const v3f &p1, const v3f &p2, const v3f &p3,
 wgpu::Texture ResourceLoader::LoadCubeMap(const char* path, wgpu::Device &device, ETextureImportType importType,
                                           wgpu::TextureView *pTextureView)
 {
+    PHOTON_PROFILE_FUNCTION();
     const char* extension = nullptr;
     switch (importType)
     {
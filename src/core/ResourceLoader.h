@@ -8,6 +8,12 @@
 #include "PhotonCore.h"
 #include "CMesh.h"
 #include <webgpu/webgpu_cpp.h>
+#include <vector>
+
+namespace tinygltf
+{
+class Model;
+}
 
 namespace photon
 {
@@ -33,6 +39,14 @@ enum class ETextureImportType
     unknown
 };
 
+// One tightly packed RGBA8 level of a mip chain.
+struct MipLevel
+{
+    std::vector<u8> Pixels;
+    u32 Width = 0;
+    u32 Height = 0;
+};
+
 class ResourceLoader
 {
 public:
@@ -42,6 +56,18 @@ public:
     static wgpu::Texture LoadCubeMap(const char* path, wgpu::Device& device, ETextureImportType importType,
                                      wgpu::TextureView* pTextureView = nullptr);
 
+    // The CPU stages of LoadMesh, in order; UploadMesh is the only one that
+    // needs a device. LoadMeshData runs all the others.
+    static bool ParseGltf(const char* path, EModelImportType modelType, tinygltf::Model& outModel);
+    static void CopyAccessors(const tinygltf::Model& model, CMesh& mesh);
+    static void ComputeBounds(CMesh& mesh);
+    static void GenerateTangents(CMesh& mesh);
+    static bool LoadMeshData(const char* path, EModelImportType modelType, CMesh& outMesh);
+    static void UploadMesh(CMesh& mesh, const wgpu::Device& device);
+
+    // Box-filters a level down to the next one, half its size.
+    static MipLevel NextMipLevel(const MipLevel& level);
+
     static u32 BitWidth(u32 m);
 private:
     static m3 CalculateTangent(const v3f& p1, const v3f& p2, const v3f& p3, const v2f& uv1, const v2f& uv2, const v2f& uv3);
@@ -0,0 +1,151 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "SceneDescription.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <json.hpp>
+
+namespace photon
+{
+
+using json = nlohmann::json;
+
+static ETextureImportType ParseTextureType(const std::string& type)
+{
+    if (type == "png")
+    {
+        return ETextureImportType::png;
+    }
+    if (type == "jpg")
+    {
+        return ETextureImportType::jpg;
+    }
+    LogWarning("Unsupported texture type %s", type.c_str());
+    return ETextureImportType::unknown;
+}
+
+static v3f ParseVec3(const json& value, const v3f& fallback)
+{
+    if (!value.is_array() || value.size() != 3)
+    {
+        return fallback;
+    }
+    return v3f(value[0].get<f32>(), value[1].get<f32>(), value[2].get<f32>());
+}
+
+bool SceneDescription::LoadFromFile(const std::string& path, SceneDescription& outScene)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        LogError("Could not open scene %s", path.c_str());
+        return false;
+    }
+
+    const json root = json::parse(file, nullptr, false);
+    if (root.is_discarded() || !root.is_object())
+    {
+        LogError("Scene %s is not valid JSON", path.c_str());
+        return false;
+    }
+
+    try
+    {
+        SceneDescription scene;
+        scene.Name = root.value("name", scene.Name);
+
+        if (const auto environment = root.find("environment"); environment != root.end())
+        {
+            scene.Skybox = environment->value("skybox", scene.Skybox);
+            scene.SkyboxType = ParseTextureType(environment->value("format", std::string("png")));
+        }
+
+        if (const auto materials = root.find("materials"); materials != root.end())
+        {
+            scene.Materials.clear();
+            for (const json& material : *materials)
+            {
+                scene.Materials.push_back({.Name = material.at("name").get<std::string>(),
+                                           .Type = ParseTextureType(material.value("format", std::string("jpg")))});
+            }
+        }
+
+        if (const auto meshes = root.find("meshes"); meshes != root.end())
+        {
+            scene.Meshes = meshes->get<std::vector<std::string>>();
+        }
+
+        if (const auto instances = root.find("instances"); instances != root.end())
+        {
+            scene.InstanceCount = instances->value("count", scene.InstanceCount);
+            scene.InstanceSpacing = instances->value("spacing", scene.InstanceSpacing);
+            scene.InstanceScale = instances->value("scale", scene.InstanceScale);
+            scene.bStaticInstances = instances->value("static", scene.bStaticInstances);
+        }
+
+        if (const auto camera = root.find("camera"); camera != root.end())
+        {
+            scene.CameraFov = camera->value("fov", scene.CameraFov);
+            scene.bLoopCameraPath = camera->value("loop", scene.bLoopCameraPath);
+            for (const json& key : camera->value("path", json::array()))
+            {
+                scene.CameraPath.push_back({.Time = key.value("time", 0.f),
+                                            .Position = ParseVec3(key.value("position", json()), v3f(0.f, 0.f, 3.f)),
+                                            .Target = ParseVec3(key.value("target", json()), v3f(0.f))});
+            }
+            std::stable_sort(scene.CameraPath.begin(), scene.CameraPath.end(),
+                             [](const CameraKey& a, const CameraKey& b) { return a.Time < b.Time; });
+        }
+
+        if (scene.Materials.empty() || scene.Meshes.empty())
+        {
+            LogError("Scene %s needs at least one material and one mesh", path.c_str());
+            return false;
+        }
+
+        outScene = std::move(scene);
+    }
+    catch (const json::exception& exception)
+    {
+        LogError("Scene %s: %s", path.c_str(), exception.what());
+        return false;
+    }
+    return true;
+}
+
+void SceneDescription::SampleCamera(f32 time, v3f& outPosition, v3f& outTarget) const
+{
+    if (CameraPath.empty())
+    {
+        return;
+    }
+
+    const f32 start = CameraPath.front().Time;
+    const f32 duration = CameraPath.back().Time - start;
+    if (bLoopCameraPath && duration > 0.f)
+    {
+        time = start + std::fmod(std::max(time - start, 0.f), duration);
+    }
+
+    // First key after time; clamps before the first and after the last key.
+    const auto next = std::upper_bound(CameraPath.begin(), CameraPath.end(), time,
+                                       [](f32 t, const CameraKey& key) { return t < key.Time; });
+    if (next == CameraPath.begin() || next == CameraPath.end())
+    {
+        const CameraKey& key = next == CameraPath.begin() ? CameraPath.front() : CameraPath.back();
+        outPosition = key.Position;
+        outTarget = key.Target;
+        return;
+    }
+
+    const CameraKey& from = *(next - 1);
+    const f32 alpha = (time - from.Time) / (next->Time - from.Time);
+    outPosition = glm::mix(from.Position, next->Position, alpha);
+    outTarget = glm::mix(from.Target, next->Target, alpha);
+}
+
+} // photon
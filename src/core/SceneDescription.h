@@ -0,0 +1,59 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_SCENEDESCRIPTION_H
+#define PHOTON_SCENEDESCRIPTION_H
+
+#include "PhotonCore.h"
+#include "ResourceLoader.h"
+#include <string>
+#include <vector>
+
+namespace photon
+{
+
+struct SceneMaterial
+{
+    std::string Name;
+    ETextureImportType Type = ETextureImportType::jpg;
+};
+
+struct CameraKey
+{
+    f32 Time = 0.f;
+    v3f Position = v3f(0.f, 0.f, 3.f);
+    v3f Target = v3f(0.f);
+};
+
+// What the renderer loads at startup: environment, materials, meshes and a
+// grid of instances cycling through them, plus an optional camera path. The
+// defaults are the interactive demo scene; benchmarks load theirs from JSON.
+struct SceneDescription
+{
+    std::string Name = "default";
+    std::string Skybox = "golden_bay";
+    ETextureImportType SkyboxType = ETextureImportType::png;
+    std::vector<SceneMaterial> Materials{{.Name = "brick", .Type = ETextureImportType::jpg}};
+    // Files in res/models.
+    std::vector<std::string> Meshes{"sphere.glb"};
+
+    u32 InstanceCount = 1;
+    f32 InstanceSpacing = 1.5f;
+    f32 InstanceScale = 0.5f;
+    bool bStaticInstances = false;
+
+    f32 CameraFov = 45.f;
+    // Sorted by time and interpolated linearly; empty leaves the camera alone.
+    std::vector<CameraKey> CameraPath;
+    bool bLoopCameraPath = true;
+
+    // Keys missing from the file keep their defaults.
+    static bool LoadFromFile(const std::string& path, SceneDescription& outScene);
+
+    void SampleCamera(f32 time, v3f& outPosition, v3f& outTarget) const;
+};
+
+} // photon
+
+#endif //PHOTON_SCENEDESCRIPTION_H
@@ -0,0 +1,472 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "ShadowAtlas.h"
+#include "CpuProfiler.h"
+#include "Reader.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace photon
+{
+
+static constexpr f32 kNearPlane = 0.05f;
+// Slightly wider than 90 degrees so filtering at face edges stays in the tile.
+static constexpr f32 kPointFaceFov = 95.f;
+// Tiles only change size once importance leaves this band around a level.
+static constexpr f32 kHysteresis = 1.25f;
+
+// +X, -X, +Y, -Y, +Z, -Z; must match the face selection in pbr_mat.wgsl.
+static const v3f kFaceDirections[ShadowAtlas::kTilesPerLight] = {
+    {1.f, 0.f, 0.f}, {-1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}, {0.f, -1.f, 0.f}, {0.f, 0.f, 1.f}, {0.f, 0.f, -1.f},
+};
+static const v3f kFaceUps[ShadowAtlas::kTilesPerLight] = {
+    {0.f, -1.f, 0.f}, {0.f, -1.f, 0.f}, {0.f, 0.f, 1.f}, {0.f, 0.f, -1.f}, {0.f, -1.f, 0.f}, {0.f, -1.f, 0.f},
+};
+
+static bool IsSphereVisible(const Frustum& frustum, const v3f& center, f32 radius)
+{
+    for (const v4f& plane : frustum.Planes)
+    {
+        if (glm::dot(v3f(plane), center) + plane.w < -radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static u32 FaceCountFor(const GpuLight& light)
+{
+    return light.SpotCosine >= ShadowAtlas::kMinSpotCosine ? 1 : ShadowAtlas::kTilesPerLight;
+}
+
+void ShadowAtlas::Init(const wgpu::Device& device, const wgpu::BindGroupLayout& casterLayout)
+{
+    PHOTON_PROFILE_FUNCTION();
+    m_Device = device;
+
+    wgpu::TextureDescriptor textureDescriptor{
+        .label = "Shadow Atlas",
+        .usage = wgpu::TextureUsage::RenderAttachment | wgpu::TextureUsage::TextureBinding,
+        .dimension = wgpu::TextureDimension::e2D,
+        .size = {kAtlasSize, kAtlasSize, 1},
+        .format = wgpu::TextureFormat::Depth32Float,
+        .mipLevelCount = 1,
+        .sampleCount = 1,
+    };
+    m_Texture = m_Device.CreateTexture(&textureDescriptor);
+    m_TextureView = m_Texture.CreateView();
+
+    wgpu::BufferDescriptor bufferDescriptor{.label = "Shadow Atlas Tiles",
+                                            .usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst,
+                                            .size = kMaxTiles * sizeof(GpuShadowTile),
+                                            .mappedAtCreation = false};
+    m_TileBuffer = m_Device.CreateBuffer(&bufferDescriptor);
+
+    bufferDescriptor.label = "Shadow Atlas Casters";
+    bufferDescriptor.usage = wgpu::BufferUsage::Uniform | wgpu::BufferUsage::CopyDst;
+    bufferDescriptor.size = kMaxTiles * kTileUniformStride;
+    m_CasterBuffer = m_Device.CreateBuffer(&bufferDescriptor);
+
+    wgpu::BindGroupEntry entry{.binding = 0, .buffer = m_CasterBuffer, .offset = 0, .size = sizeof(m4)};
+    wgpu::BindGroupDescriptor bindGroupDescriptor{.layout = casterLayout, .entryCount = 1, .entries = &entry};
+    m_CasterBindGroup = m_Device.CreateBindGroup(&bindGroupDescriptor);
+
+    // Render passes cannot clear part of an attachment, so tiles are cleared
+    // by a triangle on the far plane.
+    wgpu::ShaderModuleWGSLDescriptor wgslDesc{};
+    wgslDesc.code = Reader::ReadTextFile("shaders/shadow_depth.wgsl");
+
+    wgpu::ShaderModuleDescriptor shaderModuleDescriptor{.nextInChain = &wgslDesc};
+    shaderModuleDescriptor.label = "Shadow Atlas Shader Module";
+    wgpu::ShaderModule shaderModule = m_Device.CreateShaderModule(&shaderModuleDescriptor);
+
+    wgpu::DepthStencilState depthStencilState{
+        .format = wgpu::TextureFormat::Depth32Float,
+        .depthWriteEnabled = true,
+        .depthCompare = wgpu::CompareFunction::Always,
+        .stencilReadMask = 0,
+        .stencilWriteMask = 0,
+    };
+
+    wgpu::PipelineLayoutDescriptor pipelineLayoutDescriptor{.bindGroupLayoutCount = 0};
+    wgpu::RenderPipelineDescriptor pipelineDescriptor{
+        .label = "Shadow Atlas Clear",
+        .layout = m_Device.CreatePipelineLayout(&pipelineLayoutDescriptor),
+        .vertex = {.module = shaderModule, .entryPoint = "vs_clear"},
+        .depthStencil = &depthStencilState,
+        .fragment = nullptr,
+    };
+    m_ClearPipeline = m_Device.CreateRenderPipeline(&pipelineDescriptor);
+
+    const u32 rootsPerSide = kAtlasSize / kMaxTileSize;
+    for (u32 y = 0; y < rootsPerSide; ++y)
+    {
+        for (u32 x = 0; x < rootsPerSide; ++x)
+        {
+            m_FreeTiles[0].emplace_back(x * kMaxTileSize, y * kMaxTileSize);
+        }
+    }
+
+    for (u32 slot = kMaxShadowedLights; slot > 0; --slot)
+    {
+        m_FreeSlots.push_back(slot - 1);
+    }
+}
+
+void ShadowAtlas::Update(std::vector<GpuLight>& lights, const CCamera& camera, const Frustum& frustum)
+{
+    m_ScheduledTiles.clear();
+    m_ScheduledLights.clear();
+    ++m_Frame;
+
+    for (size_t i = lights.size(); i < m_Lights.size(); ++i)
+    {
+        Free(m_Lights[i]);
+    }
+    m_Lights.resize(lights.size());
+
+    // Importance is the light's range as a fraction of the view height.
+    const f32 tanHalfFov = std::tan(glm::radians(camera.Fov) * 0.5f);
+    std::vector<std::pair<f32, u32>> candidates;
+    for (u32 i = 0; i < lights.size(); ++i)
+    {
+        const GpuLight& light = lights[i];
+        if (!IsSphereVisible(frustum, light.Position, light.Radius))
+        {
+            continue;
+        }
+        const f32 distance = glm::length(light.Position - camera.Position);
+        const f32 importance = distance <= light.Radius ? 1.f : std::min(1.f, light.Radius / (distance * tanHalfFov));
+        candidates.emplace_back(importance, i);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    if (candidates.size() > kMaxShadowedLights)
+    {
+        candidates.resize(kMaxShadowedLights);
+    }
+
+    std::vector<u32> levels(lights.size(), kLevelCount);
+    for (const auto& [importance, i] : candidates)
+    {
+        const LightState& state = m_Lights[i];
+        levels[i] = LevelFor(importance);
+        if (state.bAllocated && state.Level >= LevelFor(importance * kHysteresis) &&
+            state.Level <= LevelFor(importance / kHysteresis))
+        {
+            levels[i] = state.Level;
+        }
+    }
+
+    // Free before allocating so dropped and resized lights make room.
+    for (u32 i = 0; i < lights.size(); ++i)
+    {
+        LightState& state = m_Lights[i];
+        if (state.bAllocated && (levels[i] != state.Level || FaceCountFor(lights[i]) != state.FaceCount))
+        {
+            Free(state);
+        }
+    }
+
+    // Most important first, falling back to smaller tiles when space runs out.
+    for (const auto& [importance, i] : candidates)
+    {
+        LightState& state = m_Lights[i];
+        for (u32 level = levels[i]; !state.bAllocated && level < kLevelCount; ++level)
+        {
+            Allocate(state, level, FaceCountFor(lights[i]));
+        }
+    }
+
+    // (priority, last render, importance rank): moving lights, then fresh
+    // tiles, then tiles invalidated by geometry.
+    std::vector<std::tuple<u32, u64, u32>> pending;
+    for (u32 rank = 0; rank < candidates.size(); ++rank)
+    {
+        const u32 i = candidates[rank].second;
+        const GpuLight& light = lights[i];
+        const LightState& state = m_Lights[i];
+        if (!state.bAllocated)
+        {
+            continue;
+        }
+
+        const bool bMoved = light.Position != state.Position || light.Direction != state.Direction ||
+                            light.Radius != state.Radius || light.SpotCosine != state.SpotCosine;
+        if (state.bValid && bMoved)
+        {
+            pending.emplace_back(0, state.RenderedFrame, rank);
+        }
+        else if (!state.bValid)
+        {
+            pending.emplace_back(1, 0, rank);
+        }
+        else if (state.bGeometryDirty)
+        {
+            pending.emplace_back(2, state.RenderedFrame, rank);
+        }
+    }
+    std::sort(pending.begin(), pending.end());
+
+    u32 tileCount = 0;
+    for (const auto& [priority, renderedFrame, rank] : pending)
+    {
+        const u32 i = candidates[rank].second;
+        LightState& state = m_Lights[i];
+        if (!m_ScheduledLights.empty() && tileCount + state.FaceCount > UpdateBudget)
+        {
+            continue;
+        }
+        tileCount += state.FaceCount;
+        ScheduleLight(lights[i], state);
+        m_ScheduledLights.push_back(i);
+    }
+
+    // Lights without a finished render stay unshadowed rather than sampling
+    // whatever the tile held before.
+    for (u32 i = 0; i < lights.size(); ++i)
+    {
+        const LightState& state = m_Lights[i];
+        const bool bShadowed = state.bAllocated && state.bValid;
+        lights[i].ShadowTile = bShadowed ? static_cast<i32>(state.Slot * kTilesPerLight) : -1;
+        lights[i].ShadowFaces = bShadowed ? state.FaceCount : 0;
+    }
+}
+
+void ShadowAtlas::InvalidateSphere(const v4f& sphere)
+{
+    for (LightState& state : m_Lights)
+    {
+        if (state.bAllocated && glm::length(state.Position - v3f(sphere)) <= state.Radius + sphere.w)
+        {
+            state.bGeometryDirty = true;
+        }
+    }
+}
+
+const std::vector<u32>& ShadowAtlas::GetScheduledTiles() const
+{
+    return m_ScheduledTiles;
+}
+
+const m4& ShadowAtlas::GetViewProjection(u32 tile) const
+{
+    return m_ViewProjections[tile];
+}
+
+void ShadowAtlas::BeginTile(wgpu::RenderPassEncoder& pass, u32 tile) const
+{
+    const v2i origin = m_TileOrigins[tile];
+    const u32 size = m_TileSizes[tile];
+    pass.SetViewport(static_cast<f32>(origin.x), static_cast<f32>(origin.y), static_cast<f32>(size),
+                     static_cast<f32>(size), 0.f, 1.f);
+    pass.SetScissorRect(origin.x, origin.y, size, size);
+
+    pass.SetPipeline(m_ClearPipeline);
+    pass.Draw(3);
+
+    const u32 offset = tile * kTileUniformStride;
+    pass.SetBindGroup(0, m_CasterBindGroup, 1, &offset);
+
+    RenderStats& stats = RenderStats::Instance();
+    stats.CountPipelineSwitch();
+    stats.CountDraw(3);
+    stats.CountBindGroupSwitch();
+}
+
+void ShadowAtlas::MarkRendered()
+{
+    for (u32 i : m_ScheduledLights)
+    {
+        m_Lights[i].bValid = true;
+        m_Lights[i].bGeometryDirty = false;
+    }
+    m_ScheduledLights.clear();
+    m_ScheduledTiles.clear();
+}
+
+const wgpu::TextureView& ShadowAtlas::GetTextureView() const
+{
+    return m_TextureView;
+}
+
+const wgpu::Buffer& ShadowAtlas::GetTileBuffer() const
+{
+    return m_TileBuffer;
+}
+
+u32 ShadowAtlas::TileSize(u32 level)
+{
+    return kMaxTileSize >> level;
+}
+
+u32 ShadowAtlas::LevelFor(f32 importance)
+{
+    if (importance >= 1.f)
+    {
+        return 0;
+    }
+    if (importance <= 0.f)
+    {
+        return kLevelCount - 1;
+    }
+    const f32 level = std::floor(-std::log2(importance));
+    return std::min(static_cast<u32>(level), kLevelCount - 1);
+}
+
+std::optional<v2i> ShadowAtlas::AllocateTile(u32 level)
+{
+    std::vector<v2i>& freeTiles = m_FreeTiles[level];
+    if (!freeTiles.empty())
+    {
+        const v2i origin = freeTiles.back();
+        freeTiles.pop_back();
+        return origin;
+    }
+    if (level == 0)
+    {
+        return std::nullopt;
+    }
+
+    // Split a tile of the next size up and keep three quarters free.
+    const std::optional<v2i> parent = AllocateTile(level - 1);
+    if (!parent)
+    {
+        return std::nullopt;
+    }
+    const i32 size = static_cast<i32>(TileSize(level));
+    freeTiles.push_back(*parent + v2i(size, 0));
+    freeTiles.push_back(*parent + v2i(0, size));
+    freeTiles.push_back(*parent + v2i(size, size));
+    return parent;
+}
+
+void ShadowAtlas::FreeTile(u32 level, const v2i& origin)
+{
+    std::vector<v2i>& freeTiles = m_FreeTiles[level];
+    if (level > 0)
+    {
+        // Merge with the three buddies when they are all free.
+        const i32 size = static_cast<i32>(TileSize(level));
+        const v2i parent = (origin / (size * 2)) * (size * 2);
+        const std::array<v2i, 4> quarters = {parent, parent + v2i(size, 0), parent + v2i(0, size),
+                                             parent + v2i(size, size)};
+
+        u32 freeBuddies = 0;
+        for (const v2i& quarter : quarters)
+        {
+            if (quarter != origin && std::find(freeTiles.begin(), freeTiles.end(), quarter) != freeTiles.end())
+            {
+                ++freeBuddies;
+            }
+        }
+        if (freeBuddies == 3)
+        {
+            std::erase_if(freeTiles, [&](const v2i& tile) {
+                return std::find(quarters.begin(), quarters.end(), tile) != quarters.end();
+            });
+            FreeTile(level - 1, parent);
+            return;
+        }
+    }
+    freeTiles.push_back(origin);
+}
+
+bool ShadowAtlas::Allocate(LightState& state, u32 level, u32 faceCount)
+{
+    if (m_FreeSlots.empty())
+    {
+        return false;
+    }
+
+    for (u32 face = 0; face < faceCount; ++face)
+    {
+        const std::optional<v2i> origin = AllocateTile(level);
+        if (!origin)
+        {
+            for (u32 allocated = 0; allocated < face; ++allocated)
+            {
+                FreeTile(level, state.Origins[allocated]);
+            }
+            return false;
+        }
+        state.Origins[face] = *origin;
+    }
+
+    state.bAllocated = true;
+    state.bValid = false;
+    state.bGeometryDirty = false;
+    state.Slot = m_FreeSlots.back();
+    state.Level = level;
+    state.FaceCount = faceCount;
+    m_FreeSlots.pop_back();
+    return true;
+}
+
+void ShadowAtlas::Free(LightState& state)
+{
+    if (!state.bAllocated)
+    {
+        return;
+    }
+    for (u32 face = 0; face < state.FaceCount; ++face)
+    {
+        FreeTile(state.Level, state.Origins[face]);
+    }
+    m_FreeSlots.push_back(state.Slot);
+    state.bAllocated = false;
+    state.bValid = false;
+}
+
+void ShadowAtlas::ScheduleLight(const GpuLight& light, LightState& state)
+{
+    state.Position = light.Position;
+    state.Direction = light.Direction;
+    state.Radius = light.Radius;
+    state.SpotCosine = light.SpotCosine;
+    state.RenderedFrame = m_Frame;
+
+    const u32 size = TileSize(state.Level);
+    const f32 far = std::max(light.Radius, kNearPlane * 2.f);
+    wgpu::Queue queue = m_Device.GetQueue();
+    for (u32 face = 0; face < state.FaceCount; ++face)
+    {
+        m4 view;
+        m4 projection;
+        if (state.FaceCount == 1)
+        {
+            const v3f direction = glm::normalize(light.Direction);
+            const v3f up = std::abs(direction.y) > 0.99f ? v3f(0.f, 0.f, 1.f) : v3f(0.f, 1.f, 0.f);
+            view = glm::lookAt(light.Position, light.Position + direction, up);
+            projection = glm::perspectiveRH_ZO(2.f * std::acos(light.SpotCosine), 1.f, kNearPlane, far);
+        }
+        else
+        {
+            view = glm::lookAt(light.Position, light.Position + kFaceDirections[face], kFaceUps[face]);
+            projection = glm::perspectiveRH_ZO(glm::radians(kPointFaceFov), 1.f, kNearPlane, far);
+        }
+
+        const u32 tile = state.Slot * kTilesPerLight + face;
+        m_ViewProjections[tile] = projection * view;
+        m_TileOrigins[tile] = state.Origins[face];
+        m_TileSizes[tile] = size;
+
+        const GpuShadowTile gpuTile{
+            .ViewProjection = m_ViewProjections[tile],
+            .Rect = v4f(v2f(state.Origins[face]) / static_cast<f32>(kAtlasSize),
+                        v2f(static_cast<f32>(size) / kAtlasSize)),
+        };
+        queue.WriteBuffer(m_TileBuffer, tile * sizeof(GpuShadowTile), &gpuTile, sizeof(GpuShadowTile));
+        RenderStats::Instance().CountBufferUpload(sizeof(GpuShadowTile));
+        queue.WriteBuffer(m_CasterBuffer, tile * kTileUniformStride, &m_ViewProjections[tile], sizeof(m4));
+        RenderStats::Instance().CountBufferUpload(sizeof(m4));
+        m_ScheduledTiles.push_back(tile);
+    }
+}
+
+} // photon
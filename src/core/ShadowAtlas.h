@@ -0,0 +1,131 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_SHADOWATLAS_H
+#define PHOTON_SHADOWATLAS_H
+
+#include "CCamera.h"
+#include "ClusteredLighting.h"
+#include "FrustumCuller.h"
+#include <webgpu/webgpu_cpp.h>
+#include <array>
+#include <optional>
+#include <vector>
+
+namespace photon
+{
+
+// Mirrors `ShadowTile` in pbr_mat.wgsl.
+struct GpuShadowTile
+{
+    m4 ViewProjection;
+    // Atlas UV offset (xy) and scale (zw).
+    v4f Rect;
+};
+
+// Shadows for point and spot lights, packed into one depth texture. Each
+// shadowed light owns one square tile per face (six for point lights, one for
+// spot lights), sized by how much of the screen the light covers and handed
+// out by a buddy allocator.
+//
+// Re-rendering is budgeted: each frame at most UpdateBudget tiles are drawn,
+// moving lights first (least recently rendered first, so they take turns),
+// then lights with fresh tiles, then static lights whose tiles were
+// invalidated by geometry changing nearby. Everything else keeps its previous
+// contents along with the matrices they were rendered with.
+class ShadowAtlas
+{
+public:
+    static constexpr u32 kAtlasSize = 4096;
+    static constexpr u32 kMaxTileSize = 1024;
+    // Tile sizes from kMaxTileSize down to kMaxTileSize >> (kLevelCount - 1).
+    static constexpr u32 kLevelCount = 4;
+    static constexpr u32 kMaxShadowedLights = 32;
+    static constexpr u32 kTilesPerLight = 6;
+    static constexpr u32 kMaxTiles = kMaxShadowedLights * kTilesPerLight;
+    static constexpr u32 kTileUniformStride = 256;
+    // Spot lights wider than this (cosine of the half-angle) use six faces.
+    static constexpr f32 kMinSpotCosine = 0.5f;
+
+    // casterLayout is group 0 of the caster pipeline: one m4 by dynamic offset.
+    void Init(const wgpu::Device& device, const wgpu::BindGroupLayout& casterLayout);
+
+    // Chooses the shadowed lights, (re)allocates their tiles and schedules
+    // this frame's renders. Sets every light's ShadowTile and ShadowFaces.
+    void Update(std::vector<GpuLight>& lights, const CCamera& camera, const Frustum& frustum);
+
+    // Marks the shadowed lights whose range touches sphere (xyz, radius) as
+    // needing a re-render.
+    void InvalidateSphere(const v4f& sphere);
+
+    // Tiles scheduled by the last Update, in render order.
+    [[nodiscard]] const std::vector<u32>& GetScheduledTiles() const;
+    [[nodiscard]] const m4& GetViewProjection(u32 tile) const;
+
+    // Limits drawing to tile, clears it and binds its matrix to group 0.
+    void BeginTile(wgpu::RenderPassEncoder& pass, u32 tile) const;
+
+    // Commits the scheduled renders; call once they have been recorded.
+    void MarkRendered();
+
+    [[nodiscard]] const wgpu::TextureView& GetTextureView() const;
+    [[nodiscard]] const wgpu::Buffer& GetTileBuffer() const;
+
+    // Maximum number of tiles re-rendered per frame. The first scheduled light
+    // is always rendered, so a budget below six cannot starve point lights.
+    u32 UpdateBudget = 8;
+
+private:
+    struct LightState
+    {
+        bool bAllocated = false;
+        // The tiles hold a render of the current allocation.
+        bool bValid = false;
+        bool bGeometryDirty = false;
+        u32 Slot = 0;
+        u32 Level = 0;
+        u32 FaceCount = 0;
+        std::array<v2i, kTilesPerLight> Origins{};
+        // The light as it was last rendered (or scheduled to be).
+        v3f Position{};
+        v3f Direction{};
+        f32 Radius = 0.f;
+        f32 SpotCosine = 0.f;
+        u64 RenderedFrame = 0;
+    };
+
+    static u32 TileSize(u32 level);
+    static u32 LevelFor(f32 importance);
+
+    std::optional<v2i> AllocateTile(u32 level);
+    void FreeTile(u32 level, const v2i& origin);
+    bool Allocate(LightState& state, u32 level, u32 faceCount);
+    void Free(LightState& state);
+
+    void ScheduleLight(const GpuLight& light, LightState& state);
+
+    wgpu::Device m_Device;
+
+    wgpu::Texture m_Texture;
+    wgpu::TextureView m_TextureView;
+    wgpu::Buffer m_TileBuffer;
+    wgpu::Buffer m_CasterBuffer;
+    wgpu::BindGroup m_CasterBindGroup;
+    wgpu::RenderPipeline m_ClearPipeline;
+
+    std::array<std::vector<v2i>, kLevelCount> m_FreeTiles;
+    std::vector<u32> m_FreeSlots;
+    std::vector<LightState> m_Lights;
+
+    std::array<m4, kMaxTiles> m_ViewProjections{};
+    std::array<v2i, kMaxTiles> m_TileOrigins{};
+    std::array<u32, kMaxTiles> m_TileSizes{};
+    std::vector<u32> m_ScheduledTiles;
+    std::vector<u32> m_ScheduledLights;
+    u64 m_Frame = 0;
+};
+
+} // photon
+
+#endif //PHOTON_SHADOWATLAS_H
@@ -0,0 +1,261 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "Simulation.h"
+#include "CpuProfiler.h"
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+
+namespace photon
+{
+
+namespace
+{
+
+// First tick at or after time. The slack keeps times that are whole ticks
+// apart from rounding up to the next one.
+u64 TickAt(f64 time, f64 timestep)
+{
+    constexpr f64 kSlack = 1e-6;
+    return static_cast<u64>(std::max(std::ceil(time / timestep - kSlack), 0.0));
+}
+
+SimulationSnapshot Interpolate(const SimulationSnapshot& from, const SimulationSnapshot& to, f64 time)
+{
+    if (to.Tick == from.Tick)
+    {
+        return from;
+    }
+    const f32 alpha = static_cast<f32>(std::clamp((time - from.Time) / (to.Time - from.Time), 0.0, 1.0));
+    return {.Tick = to.Tick,
+            .Time = glm::mix(from.Time, to.Time, static_cast<f64>(alpha)),
+            .CameraPosition = glm::mix(from.CameraPosition, to.CameraPosition, alpha),
+            .CameraTarget = glm::mix(from.CameraTarget, to.CameraTarget, alpha),
+            .MeshRotation = glm::mix(from.MeshRotation, to.MeshRotation, alpha)};
+}
+
+} // namespace
+
+Simulation::~Simulation()
+{
+    StopThread();
+}
+
+void Simulation::Init(const SceneDescription& scene, const CCamera& camera, f64 timestep)
+{
+    StopThread();
+    m_Timestep = timestep;
+    m_Scene = scene;
+    m_CameraPosition = camera.Position;
+    m_CameraTarget = camera.Target;
+    m_CameraFront = camera.Front;
+    m_MeshRotation = v3f(0.f);
+    m_InputRotation = v3i(0);
+    m_RequestedTick = 0;
+    m_TargetTick = 0;
+    m_Input.clear();
+
+    m_Scene.SampleCamera(0.f, m_CameraPosition, m_CameraTarget);
+    m_Tick = 0;
+    m_History.clear();
+    m_History.push_back(std::make_shared<const SimulationSnapshot>(
+        SimulationSnapshot{.CameraPosition = m_CameraPosition, .CameraTarget = m_CameraTarget}));
+}
+
+void Simulation::StartThread()
+{
+    if (IsThreaded())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bStopping = false;
+        m_TargetTick = m_RequestedTick;
+    }
+    m_Thread = std::thread(&Simulation::ThreadMain, this);
+}
+
+void Simulation::StopThread()
+{
+    if (!IsThreaded())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bStopping = true;
+    }
+    m_Condition.notify_all();
+    m_Thread.join();
+
+    // Ticking is back on this thread; finish what was already asked for.
+    while (m_Tick < m_RequestedTick)
+    {
+        Tick();
+    }
+}
+
+u64 Simulation::PushInput(const InputEvent& event)
+{
+    const u64 tick = GetInputTick();
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Input.push_back({.Tick = tick, .Event = event});
+    return tick;
+}
+
+void Simulation::RequestAdvance(f64 time)
+{
+    const u64 tick = TickAt(time, m_Timestep);
+    if (tick <= m_RequestedTick)
+    {
+        return;
+    }
+    m_RequestedTick = tick;
+
+    if (!IsThreaded())
+    {
+        while (m_Tick < m_RequestedTick)
+        {
+            Tick();
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_TargetTick = tick;
+    }
+    m_Condition.notify_all();
+}
+
+SimulationSnapshot Simulation::Sample(f64 time)
+{
+    PHOTON_PROFILE_FUNCTION();
+    RequestAdvance(time);
+    const u64 tick = TickAt(time, m_Timestep);
+
+    std::shared_ptr<const SimulationSnapshot> from;
+    std::shared_ptr<const SimulationSnapshot> to;
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Condition.wait(lock, [this, tick] { return m_History.back()->Tick >= tick; });
+        // Ticks older than the history clamp to its oldest.
+        from = m_History.front();
+        to = m_History.back();
+        for (const std::shared_ptr<const SimulationSnapshot>& snapshot : m_History)
+        {
+            if (snapshot->Time <= time)
+            {
+                from = snapshot;
+            }
+            if (snapshot->Tick >= tick)
+            {
+                to = snapshot;
+                break;
+            }
+        }
+    }
+    return Interpolate(*from, *to, time);
+}
+
+void Simulation::ThreadMain()
+{
+    PHOTON_PROFILE_THREAD("Simulation");
+    while (true)
+    {
+        u64 target = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait(lock, [this] { return m_bStopping || m_TargetTick > m_Tick; });
+            if (m_bStopping)
+            {
+                return;
+            }
+            target = m_TargetTick;
+        }
+        while (m_Tick < target)
+        {
+            Tick();
+        }
+    }
+}
+
+void Simulation::Tick()
+{
+    PHOTON_PROFILE_FUNCTION();
+    const u64 tick = m_Tick + 1;
+
+    std::vector<InputEvent> input;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        const auto due = std::stable_partition(m_Input.begin(), m_Input.end(),
+                                               [tick](const PendingInput& pending) { return pending.Tick <= tick; });
+        for (auto pending = m_Input.begin(); pending != due; ++pending)
+        {
+            input.push_back(std::move(pending->Event));
+        }
+        m_Input.erase(m_Input.begin(), due);
+    }
+    for (const InputEvent& event : input)
+    {
+        ApplyInput(event);
+    }
+
+    const f64 time = static_cast<f64>(tick) * m_Timestep;
+    m_MeshRotation += v3f(m_InputRotation);
+    m_Scene.SampleCamera(static_cast<f32>(time), m_CameraPosition, m_CameraTarget);
+
+    auto snapshot = std::make_shared<const SimulationSnapshot>(SimulationSnapshot{.Tick = tick,
+                                                                                  .Time = time,
+                                                                                  .CameraPosition = m_CameraPosition,
+                                                                                  .CameraTarget = m_CameraTarget,
+                                                                                  .MeshRotation = m_MeshRotation});
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_History.push_back(std::move(snapshot));
+        if (m_History.size() > kHistorySize)
+        {
+            m_History.pop_front();
+        }
+        m_Tick = tick;
+    }
+    m_Condition.notify_all();
+}
+
+void Simulation::ApplyInput(const InputEvent& event)
+{
+    switch (event.Type)
+    {
+    case EInputEventType::KeyDown:
+    case EInputEventType::KeyUp:
+    {
+        const i32 sign = event.Type == EInputEventType::KeyDown ? 1 : -1;
+        if (event.Name == "w")
+        {
+            m_InputRotation.x += sign;
+        }
+        if (event.Name == "s")
+        {
+            m_InputRotation.x -= sign;
+        }
+        if (event.Name == "a")
+        {
+            m_InputRotation.y += sign;
+        }
+        if (event.Name == "d")
+        {
+            m_InputRotation.y -= sign;
+        }
+        break;
+    }
+    case EInputEventType::Scroll:
+        m_CameraPosition += m_CameraFront * event.Value * -0.005f;
+        break;
+    default:
+        break;
+    }
+}
+
+} // photon
@@ -0,0 +1,114 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_SIMULATION_H
+#define PHOTON_SIMULATION_H
+
+#include "CCamera.h"
+#include "InputRecorder.h"
+#include "PhotonCore.h"
+#include "SceneDescription.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace photon
+{
+
+// Renderable state at the end of one tick. Published snapshots are never
+// modified, so the render thread reads them without holding a lock.
+struct SimulationSnapshot
+{
+    // Newest tick the state includes; samples between ticks blend towards it.
+    u64 Tick = 0;
+    f64 Time = 0.0;
+    v3f CameraPosition = v3f(0.f);
+    v3f CameraTarget = v3f(0.f);
+    // Yaw, pitch and roll of the input-driven mesh, in degrees.
+    v3f MeshRotation = v3f(0.f);
+};
+
+// Camera, input-driven objects and animation time, advanced in fixed steps.
+// Tick k simulates time k * timestep; the render thread samples any time in
+// between and gets the two ticks around it interpolated.
+//
+// Ticks run only once the render thread requested them, and input is applied
+// at the first tick not yet requested when it was pushed. Where ticks run,
+// inline in RequestAdvance or on the simulation thread, therefore never
+// changes the result. With the thread, the render thread requests the ticks
+// before the next frame's time once the current frame's input is in, so they
+// run while that frame is submitted and presented; the tick the next frame
+// samples stays open for its input.
+class Simulation
+{
+public:
+    static constexpr f64 kDefaultTimestep = 1.0 / 60.0;
+    // Published ticks kept for interpolation.
+    static constexpr u32 kHistorySize = 8;
+
+    ~Simulation();
+
+    void Init(const SceneDescription& scene, const CCamera& camera, f64 timestep = kDefaultTimestep);
+
+    // Moves ticking to a thread of its own until StopThread.
+    void StartThread();
+    void StopThread();
+    [[nodiscard]] bool IsThreaded() const { return m_Thread.joinable(); }
+
+    // Render thread only, like the calls below. Returns the tick event is
+    // applied at.
+    u64 PushInput(const InputEvent& event);
+    // Tick input pushed now would be applied at.
+    [[nodiscard]] u64 GetInputTick() const { return m_RequestedTick + 1; }
+    // Asks for every tick up to the first at or after time; returns at once
+    // when threaded.
+    void RequestAdvance(f64 time);
+    // State at time, waiting for its ticks when the thread has not got there.
+    SimulationSnapshot Sample(f64 time);
+
+    [[nodiscard]] f64 GetTimestep() const { return m_Timestep; }
+
+private:
+    struct PendingInput
+    {
+        u64 Tick = 0;
+        InputEvent Event;
+    };
+
+    void ThreadMain();
+    // Simulates tick m_Tick + 1 and publishes it.
+    void Tick();
+    void ApplyInput(const InputEvent& event);
+
+    f64 m_Timestep = kDefaultTimestep;
+
+    // Owned by whichever thread ticks.
+    SceneDescription m_Scene;
+    v3f m_CameraPosition = v3f(0.f);
+    v3f m_CameraTarget = v3f(0.f);
+    v3f m_CameraFront = v3f(0.f, 0.f, -1.f);
+    v3f m_MeshRotation = v3f(0.f);
+    v3i m_InputRotation{};
+    u64 m_Tick = 0;
+
+    // Render thread only.
+    u64 m_RequestedTick = 0;
+
+    // Guarded by m_Mutex.
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    std::deque<std::shared_ptr<const SimulationSnapshot>> m_History;
+    std::vector<PendingInput> m_Input;
+    u64 m_TargetTick = 0;
+    bool m_bStopping = false;
+
+    std::thread m_Thread;
+};
+
+} // photon
+
+#endif //PHOTON_SIMULATION_H
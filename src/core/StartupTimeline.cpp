@@ -0,0 +1,123 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#include "StartupTimeline.h"
+#include "Logger.h"
+#include <algorithm>
+#include <fstream>
+#include <json.hpp>
+
+namespace photon
+{
+
+using json = nlohmann::json;
+
+StartupTimeline& StartupTimeline::Instance()
+{
+    static StartupTimeline timeline;
+    return timeline;
+}
+
+void StartupTimeline::Reset()
+{
+    m_Origin = std::chrono::steady_clock::now();
+    m_Stages.clear();
+    m_Open.clear();
+    m_Marks.clear();
+}
+
+void StartupTimeline::BeginStage(const char* name)
+{
+    m_Open.push_back(static_cast<u32>(m_Stages.size()));
+    m_Stages.push_back({.Name = name, .Depth = static_cast<u32>(m_Open.size() - 1), .StartMs = NowMs()});
+}
+
+void StartupTimeline::EndStage()
+{
+    if (m_Open.empty())
+    {
+        LogWarning("StartupTimeline: EndStage without a stage");
+        return;
+    }
+    StartupStage& stage = m_Stages[m_Open.back()];
+    stage.DurationMs = NowMs() - stage.StartMs;
+    m_Open.pop_back();
+}
+
+void StartupTimeline::Mark(const char* name)
+{
+    if (!HasMark(name))
+    {
+        m_Marks.push_back({.Name = name, .TimeMs = NowMs()});
+    }
+}
+
+bool StartupTimeline::HasMark(const char* name) const
+{
+    return GetMarkMs(name) >= 0.0;
+}
+
+f64 StartupTimeline::GetMarkMs(const char* name) const
+{
+    const auto mark = std::find_if(m_Marks.begin(), m_Marks.end(),
+                                   [name](const StartupMark& mark) { return mark.Name == name; });
+    return mark != m_Marks.end() ? mark->TimeMs : -1.0;
+}
+
+const std::vector<StartupStage>& StartupTimeline::GetStages() const
+{
+    return m_Stages;
+}
+
+const std::vector<StartupMark>& StartupTimeline::GetMarks() const
+{
+    return m_Marks;
+}
+
+void StartupTimeline::LogReport() const
+{
+    LogInfo("Startup timeline:");
+    for (const StartupStage& stage : m_Stages)
+    {
+        LogInfo("  %9.2f ms %9.2f ms  %*s%s", stage.StartMs, stage.DurationMs, stage.Depth * 2, "",
+                stage.Name.c_str());
+    }
+    for (const StartupMark& mark : m_Marks)
+    {
+        LogInfo("  %9.2f ms  %s", mark.TimeMs, mark.Name.c_str());
+    }
+}
+
+bool StartupTimeline::WriteJson(const std::string& path) const
+{
+    json stages = json::array();
+    for (const StartupStage& stage : m_Stages)
+    {
+        stages.push_back({{"name", stage.Name},
+                          {"depth", stage.Depth},
+                          {"start_ms", stage.StartMs},
+                          {"duration_ms", stage.DurationMs}});
+    }
+    json marks = json::array();
+    for (const StartupMark& mark : m_Marks)
+    {
+        marks.push_back({{"name", mark.Name}, {"time_ms", mark.TimeMs}});
+    }
+
+    std::ofstream file(path);
+    if (!file)
+    {
+        LogError("Could not write %s", path.c_str());
+        return false;
+    }
+    file << json{{"stages", stages}, {"marks", marks}}.dump(2) << '\n';
+    return true;
+}
+
+f64 StartupTimeline::NowMs() const
+{
+    return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - m_Origin).count();
+}
+
+} // photon
@@ -0,0 +1,89 @@
+//
+// Created by Raul Romero on 2026-10-19.
+//
+
+#ifndef PHOTON_STARTUPTIMELINE_H
+#define PHOTON_STARTUPTIMELINE_H
+
+#include "PhotonCore.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace photon
+{
+
+struct StartupStage
+{
+    std::string Name;
+    // Nesting level; stages begun while another is open are its children.
+    u32 Depth = 0;
+    f64 StartMs = 0.0;
+    f64 DurationMs = 0.0;
+};
+
+struct StartupMark
+{
+    std::string Name;
+    f64 TimeMs = 0.0;
+};
+
+// What launch time is spent on, from Reset to the first presented frame.
+// Stages are begun and ended in strict nesting order, possibly from
+// different callbacks; marks are one-off milestones such as the first
+// present. All times are milliseconds since Reset.
+class StartupTimeline
+{
+public:
+    static constexpr const char* kFirstPresent = "First Present";
+    static constexpr const char* kPipelinesReady = "Pipelines Ready";
+
+    static StartupTimeline& Instance();
+
+    void Reset();
+
+    void BeginStage(const char* name);
+    void EndStage();
+    // Later marks with the same name are ignored.
+    void Mark(const char* name);
+
+    [[nodiscard]] bool HasMark(const char* name) const;
+    // Time of the mark, or a negative value when it was never reached.
+    [[nodiscard]] f64 GetMarkMs(const char* name) const;
+    [[nodiscard]] const std::vector<StartupStage>& GetStages() const;
+    [[nodiscard]] const std::vector<StartupMark>& GetMarks() const;
+
+    void LogReport() const;
+    bool WriteJson(const std::string& path) const;
+
+private:
+    [[nodiscard]] f64 NowMs() const;
+
+    std::chrono::steady_clock::time_point m_Origin = std::chrono::steady_clock::now();
+    std::vector<StartupStage> m_Stages;
+    // Indices into m_Stages of the stages still open.
+    std::vector<u32> m_Open;
+    std::vector<StartupMark> m_Marks;
+};
+
+// Begins a stage for the lifetime of the scope.
+class StartupScope
+{
+public:
+    explicit StartupScope(const char* name)
+    {
+        StartupTimeline::Instance().BeginStage(name);
+    }
+
+    ~StartupScope()
+    {
+        StartupTimeline::Instance().EndStage();
+    }
+
+    StartupScope(const StartupScope&) = delete;
+    StartupScope& operator=(const StartupScope&) = delete;
+};
+
+} // photon
+
+#endif //PHOTON_STARTUPTIMELINE_H